@@ -79,8 +79,9 @@ namespace debug
         }
 
         // compute the CI coefficients for all determinants in the input
-        for (typename std::vector< std::vector<charge> >::iterator it = determinants.begin(); it != determinants.end(); ++it)
-            maquis::cout << "CI coefficient of det " << it - determinants.begin() + 1 << ": " << extract_coefficient(mps, *it) << std::endl;
+        std::vector<typename Matrix::value_type> coefficients = extract_coefficients(mps, determinants);
+        for (std::size_t i = 0; i < determinants.size(); ++i)
+            maquis::cout << "CI coefficient of det " << i + 1 << ": " << coefficients[i] << std::endl;
 
         maquis::cout << std::endl;
     }
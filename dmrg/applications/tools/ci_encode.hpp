@@ -19,6 +19,7 @@
 #include "dmrg/block_matrix/indexing.h"
 #include "dmrg/mp_tensors/mps.h"
 #include "dmrg/mp_tensors/mps_initializers.h"
+#include "dmrg/mp_tensors/mps_ci_expansion.h"
 
 /*
     Small function to read determinants from a input file
@@ -157,6 +158,17 @@ typename Matrix::value_type extract_coefficient(MPS<Matrix, SymmGroup> const & m
     return coeff(0,0);
 }
 
+/*
+    Batched version of extract_coefficient: the determinants are evaluated together, sharing the
+    partial products of their common prefixes (see MPSCIExpansion)
+*/
+template <class Matrix, class SymmGroup>
+std::vector<typename Matrix::value_type>
+extract_coefficients(MPS<Matrix, SymmGroup> const & mps, std::vector<std::vector<typename SymmGroup::charge> > const & dets)
+{
+    return MPSCIExpansion<Matrix, SymmGroup>(mps).coefficients(dets);
+}
+
 template <class Matrix, class SymmGroup>
 void set_coefficient(MPS<Matrix, SymmGroup> & mps, std::vector<typename SymmGroup::charge> const & det, typename Matrix::value_type coefficient)
 {
@@ -79,12 +79,9 @@ int main(int argc, char ** argv)
     }
 
     // compute the CI coefficients for all determinants in the input
-    int i = 1;
-    for (std::vector< std::vector<grp::charge> >::iterator it = determinants.begin();
-        it != determinants.end(); ++it){
-        maquis::cout << "CI coefficient of det " << i <<": " << extract_coefficient(mps, *it) << std::endl;
-        i++;
-        }
+    std::vector<matrix::value_type> coefficients = extract_coefficients(mps, determinants);
+    for (std::size_t i = 0; i < determinants.size(); ++i)
+        maquis::cout << "CI coefficient of det " << i + 1 <<": " << coefficients[i] << std::endl;
 
     maquis::cout << std::endl;
 
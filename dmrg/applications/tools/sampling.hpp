@@ -171,11 +171,15 @@ struct Sampling
 
         Determinant det_queen,det_bee,det_tmp; // determinant "queen bee tmp"
         int iaccept=0,iaccept_queen=0;
+
+// The site matrices are extracted once, and the reservoir is evaluated as a batch
+        MPSCIExpansion<matrix, SymmGroup> expansion(mps);
+        std::vector<double> ci_mclr = expansion.coefficients(dets_mclr);
  
         for (std::size_t c = 0; c < dets_mclr.size(); ++c)
            {
             det=dets_mclr[c];
-            ci0=extract_coefficient(mps, det); 	   
+            ci0=ci_mclr[c];
             hash[det]=ci0;
 //            maquis::cout << "follow determinant " << c << " with coefficient " << ci0 << std::endl;
 //            for(int p = det_length-1; p >= 0; --p)            
@@ -269,7 +273,7 @@ struct Sampling
 //                maquis::cout << det_bee[p][0] << det_bee[p][1] << det_bee[p][2]  << std::endl;
 
 //        for(typename Determinants::iterator it = dets.begin();it != dets.end(); ++it)
-            ci=extract_coefficient(mps, det_bee); 	    
+            ci=expansion.coefficient(det_bee);
             sum_ci2=sum_ci2+pow(ci,2.0); 
 //            maquis::cout << isample << "-th " << " CI coefficient: " << ci << std::endl;      
 
@@ -312,7 +316,61 @@ struct Sampling
 
           } while(completeness>COM_threshold &&  nMAX< nitermax);
 
+          print_dets<Hash_value, Hash_index>(hash, hash_index, det_length);
+        }
+
+// template sample_dets -- draws the determinants directly from the MPS with probability |CI|^2,
+// instead of the random excitations of generate_dets. The MPS must be right-normalized.
+       template <typename Determinants, typename MPS, typename Hash_value, typename Hash_index, typename SymmGroup>
+       void sample_dets(Determinants dets,
+                        MPS mps,
+                        Hash_value hash,
+                        Hash_index hash_index,
+                        int nsample,
+                        int nitermax,
+                        double CI_threshold,
+                        double COM_threshold)
+      {
+        maquis::cout << "    CI-threshold  : " <<  CI_threshold << std::endl;
+        maquis::cout << "   COM-threshold  : " << COM_threshold << std::endl;
+
+        for (std::size_t c = 0; c < dets.size(); ++c)
+            hash_index[dets[c]]=c;
+
+        MPSCIExpansion<matrix, SymmGroup> expansion(mps);
+        typename Hash_value::iterator iter;
+        double sum_ci2,completeness;
+        int nMAX=0,iaccept=0;
+        do{
+          nMAX++;
+          // each distinct determinant is returned once, with the number of times it has been drawn
+          std::vector<typename MPSCIExpansion<matrix, SymmGroup>::Sample> samples = expansion.sample(nsample, generator);
+          for (std::size_t i = 0; i < samples.size(); ++i)
+            if (std::abs(samples[i].coefficient) >= CI_threshold && hash.find(samples[i].determinant) == hash.end()) {
+              hash[samples[i].determinant]=samples[i].coefficient;
+              iaccept++;
+              }
+
+          sum_ci2=0.0;
+          for(iter=hash.begin(); iter!=hash.end(); iter++)
+             sum_ci2=sum_ci2+pow(iter->second,2.0);
+
+          maquis::cout << "Determinant-nsampled" << samples.size() << std::endl;
+          maquis::cout << "Determinant-naccept" << iaccept << std::endl;
+          completeness=1.0-sum_ci2;
+          maquis::cout << " Current completeness (1-\\sum(ci^2)) : " << completeness << std::endl;
+
+          } while(completeness>COM_threshold &&  nMAX< nitermax);
+
+          print_dets<Hash_value, Hash_index>(hash, hash_index, mps.length());
+        }
+
 // Back to "2", "u", "d", "0" type electron representation, and print out
+       template <typename Hash_value, typename Hash_index>
+       void print_dets(Hash_value & hash, Hash_index & hash_index, unsigned det_length)
+      {
+          typename Hash_value::iterator iter;
+          typename Hash_index::iterator iter_idx;
           //Determinants  dets_show;
           double    CIs_show[hash.size()]; //value
           uint32_t  CIs_index[hash.size()]; //index in the reservoir
@@ -361,7 +419,7 @@ struct Sampling
           for(int i=0; i<hash.size() ; i++)
             maquis::cout << " The sorted determinants: " << dets_show[hash.size()-i-1] << " " << CIs_show[hash.size()-i-1] << std::endl;            
  
-        }    
+        }
        
         boost::mt19937 generator;
         boost::uniform_real<> distribution;
@@ -89,9 +89,21 @@ parse_config(std::string file, std::vector<Index<SymmGroup> > const & site_dims,
 int main(int argc, char ** argv)
 {
 
+    // the determinants are drawn directly from the MPS if the flag is given (at any position)
+    bool perfect_sampling = false;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::string(argv[i]) == "--perfect-sampling")
+            perfect_sampling = true;
+        else
+            args.push_back(argv[i]);
+    }
+    argc = args.size();
+    argv = args.data();
+
     if (argc < 3)
     {
-        maquis::cout << "srcas <mps.h5> <determinants_file> <CI_threshold> <CI_completeness> ( <Nsamples> <Nitermax> <determinants_reservoir> )" << std::endl;
+        maquis::cout << "srcas <mps.h5> <determinants_file> <CI_threshold> <CI_completeness> ( <Nsamples> <Nitermax> <determinants_reservoir> ) [--perfect-sampling]" << std::endl;
         maquis::cout << "See J. Chem. Phys. 134, 224101 (2011) for details" << std::endl;
         exit(1);
     }
@@ -140,9 +152,9 @@ int main(int argc, char ** argv)
 
     if(argc == 3){
       // compute the CI coefficients for all determinants in the input
-      for (typename std::vector< std::vector<grp::charge> >::iterator it = determinants.begin();
-            it != determinants.end(); ++it)
-          maquis::cout << "CI coefficient: " << extract_coefficient(mps, *it) << std::endl;
+      std::vector<matrix::value_type> coefficients = extract_coefficients(mps, determinants);
+      for (std::size_t i = 0; i < determinants.size(); ++i)
+          maquis::cout << "CI coefficient: " << coefficients[i] << std::endl;
       }
     else{
 
@@ -178,8 +190,15 @@ int main(int argc, char ** argv)
       Hash_Map_with_index hash_index;
 
       // SR-CAS -- Sampling Reconstructed CAS determinants
-      Sampling().generate_dets <std::vector<std::vector<typename grp::charge> >, MPS<matrix, grp>, Hash_Map_with_value, Hash_Map_with_index, std::vector<Index<grp> >, std::vector<typename grp::charge>, grp >
-                             (determinants, determinants_mclr, mps, hash_value, hash_index, phys_dims, L, Nsamples, Nitermax, CI_threshold, COM_threshold);
+      if (perfect_sampling) {
+        mps.normalize_right();
+        Sampling().sample_dets <std::vector<std::vector<typename grp::charge> >, MPS<matrix, grp>, Hash_Map_with_value, Hash_Map_with_index, grp >
+                             (determinants, mps, hash_value, hash_index, Nsamples, Nitermax, CI_threshold, COM_threshold);
+      }
+      else {
+        Sampling().generate_dets <std::vector<std::vector<typename grp::charge> >, MPS<matrix, grp>, Hash_Map_with_value, Hash_Map_with_index, std::vector<Index<grp> >, std::vector<typename grp::charge>, grp >
+                               (determinants, determinants_mclr, mps, hash_value, hash_index, phys_dims, L, Nsamples, Nitermax, CI_threshold, COM_threshold);
+      }
     }
 
     maquis::cout << std::endl;
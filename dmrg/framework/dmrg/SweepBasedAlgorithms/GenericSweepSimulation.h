@@ -13,6 +13,7 @@
 #include "dmrg/mp_tensors/mps.h"
 #include "dmrg/mp_tensors/mpo.h"
 #include "dmrg/utils/BaseParameters.h"
+#include "dmrg/utils/pool_allocator.hpp"
 #include "dmrg/utils/results_collector.h"
 #include "SweepMPSContainer.h"
 #include "SweepMPOContainer.h"
@@ -43,7 +44,7 @@ public:
   /** @brief Class constructor */
   GenericSweepSimulation(MPSType& mps, const MPOType& mpo, BaseParameters& parms, const ModelType& model,
                          const Lattice& lattice, bool verbose, std::string simulationName="Optimization")
-    : mps_(mps), parms_(parms), L_(mps_.length()), mpoContainer_(mpo, mps), mpsContainer_(mps),
+    : mps_(mps), parms_(parms), L_(mps_.length()), mpoContainer_(mpo, mps, parms), mpsContainer_(mps),
       simulationName_(simulationName), nSweeps_(0), indexOfMicroIteration_(0),
       lattice_(lattice), model_(model), verbose_(verbose)
   {
@@ -142,6 +143,8 @@ public:
       this->performBackPropagation(boundaryGrowthModality);
       mpsUpdater_->mergeUnitaryFactor(boundaryGrowthModality, siteLeft_, siteRight_, this->normalizeAtEnd());
       this->finalizeMicroIteration(truncationResults);
+      // The temporaries of the site optimization are gone, so their cached memory can be released
+      maquis::trim_memory_pools();
       indexOfMicroIteration_ += 1;
       if (verbose_)
         maquis::cout << std::endl;
@@ -0,0 +1,312 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef PARALLEL_SWEEP_BASED_ENERGY_MINIMIZATION_H
+#define PARALLEL_SWEEP_BASED_ENERGY_MINIMIZATION_H
+
+#include <boost/mpi.hpp>
+#include <boost/serialization/vector.hpp>
+#include "SweepBasedEnergyMinimization.h"
+#include "dmrg/mp_tensors/mps_mpo_ops.h"
+#include "dmrg/mp_tensors/twositetensor.h"
+
+/**
+ * @brief Real-space parallel two-site DMRG (Stoudenmire and White, PRB 87, 155137 (2013)).
+ *
+ * The lattice is split in contiguous segments, one per MPI rank, and every rank sweeps its
+ * own segment with the same local problem as [SweepBasedEnergyMinimization]. Each rank keeps a
+ * complete copy of the MPS, but only the tensors of its segment, and the boundaries that
+ * reach them, are kept up to date.
+ *
+ * A sweep is made of two phases. In the first phase, the even ranks sweep their segment from
+ * left to right and the odd ranks from right to left, so that each even rank ends next to
+ * the segment of the following odd rank. The two-site problem across the edge of the segments
+ * is then solved by the rank on the left, with the right boundary and the orthogonality center
+ * sent by the rank on the right, and the new left boundary and center are sent back.
+ * The second phase does the same with the roles of the even and odd ranks swapped.
+ *
+ * The segments are glued by the inverse of the last singular values of the edge bond, i.e.:
+ *
+ *     |psi> = ... C_{i-1} S^{-1} C_i ...
+ *
+ * where C_{i-1} and C_i are the centers of the two segments, both containing the singular
+ * values S. Singular values smaller than [pdmrg_inverse_cutoff], relative to the largest
+ * one, are not inverted.
+ *
+ * Note that every rank builds the boundaries of the whole lattice once at construction, so the
+ * set-up cost is O(L) on each rank and only the sweeps are parallel. The storage directory of
+ * the boundaries must not be shared between ranks (see storage::setup).
+ */
+
+template<class Matrix, class SymmGroup, class Storage>
+class ParallelSweepBasedEnergyMinimization
+  : public SweepBasedEnergyMinimization<Matrix, SymmGroup, Storage, SweepOptimizationType::TwoSite> {
+public:
+  using Base = SweepBasedEnergyMinimization<Matrix, SymmGroup, Storage, SweepOptimizationType::TwoSite>;
+  using MPSType = typename Base::MPSType;
+  using ModelType = typename Base::ModelType;
+  using MPOType = typename Base::MPOType;
+  using MPSTensorType = typename Base::MPSTensorType;
+  using BlockMatrixType = block_matrix<Matrix, SymmGroup>;
+  using DiagonalMatrixType = typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type;
+  using DiagonalBlockMatrixType = block_matrix<DiagonalMatrixType, SymmGroup>;
+  using BoundaryPropagatorType = typename Base::BoundaryPropagatorType;
+  using SweepMPSUpdaterType = typename Base::SweepMPSUpdaterType;
+  //
+  using Base::boundaryPropagator_;
+  using Base::iterationResults_;
+  using Base::L_;
+  using Base::mps_;
+  using Base::mpsUpdater_;
+  using Base::mpoContainer_;
+  using Base::nSweeps_;
+  using Base::parms_;
+  using Base::siteLeft_;
+  using Base::siteRight_;
+  using Base::verbose_;
+
+  /** @brief Class constructor. The MPS of the rank 0 is the starting guess of all ranks. */
+  ParallelSweepBasedEnergyMinimization(MPSType& mps, const MPOType& mpo, BaseParameters& parms, const ModelType& model,
+                                       const Lattice& lattice, bool verbose,
+                                       boost::mpi::communicator comm = boost::mpi::communicator())
+    : Base(mps, mpo, parms, model, lattice, verbose), comm_(comm), rank_(comm.rank()), nRanks_(comm.size()),
+      inverseCutoff_(parms["pdmrg_inverse_cutoff"])
+  {
+    if (parms_.is_set("ortho_states") && parms_["ortho_states"] != "")
+      throw std::runtime_error("Constrained optimizations are not supported by the parallel DMRG");
+    if (L_ < 2*nRanks_)
+      throw std::runtime_error("The parallel DMRG requires at least two sites per MPI rank");
+    firstSite_ = L_*rank_/nRanks_;
+    lastSite_ = L_*(rank_+1)/nRanks_;
+    boost::mpi::broadcast(comm_, mps_, 0);
+    // The bond matrix on the left edge of a segment is the initial gluing factor of the previous segment
+    if (rank_ > 0) {
+      mps_.canonize(firstSite_-1);
+      const MPSType& constMPS = mps_;
+      MPSTensorType edgeTensor = constMPS[firstSite_-1];
+      comm_.send(rank_-1, bondTag, edgeTensor.leftNormalizeAndReturn(DefaultSolver()));
+    }
+    if (rank_ < nRanks_-1) {
+      BlockMatrixType bondMatrix;
+      comm_.recv(rank_+1, bondTag, bondMatrix);
+      bondInverse_ = invertBondMatrix(bondMatrix);
+    }
+    mps_.canonize(isForward(0) ? firstSite_ : lastSite_-1);
+    boundaryPropagator_ = std::make_shared<BoundaryPropagatorType>(mps_, mpoContainer_.getMPO(), mps_.canonization());
+    mpsUpdater_ = std::make_unique<SweepMPSUpdaterType>(mpoContainer_.getMPO(), mps_, boundaryPropagator_, parms_, verbose_);
+  }
+
+  /**
+   * @brief Runs the sweeps and collects the optimized MPS.
+   * At the end, every rank holds the complete MPS and its energy is the only "Energy" result.
+   */
+  void runSweepSimulation() {
+    this->printGenericInfo();
+    for (int iSweep = 0; iSweep < nSweeps_; iSweep++)
+      runSingleSweep(iSweep);
+    combineSegments();
+  }
+
+  /** @brief Runs the two phases of a parallel sweep */
+  void runSingleSweep(int iSweep) {
+    this->prepareSweep();
+    this->printSweepSpecificInfo(iSweep);
+    for (int phase = 0; phase < 2; phase++) {
+      bool forward = isForward(phase);
+      sweepSegment(iSweep, forward);
+      if (forward && rank_ < nRanks_-1)
+        optimizeEdge(iSweep);
+      else if (!forward && rank_ > 0)
+        exchangeEdge();
+    }
+  }
+
+  /** @brief Sites [first, last) of the segment of this rank */
+  std::pair<int, int> getSegment() const { return std::make_pair(firstSite_, lastSite_); }
+
+private:
+
+  /** @brief Whether the rank sweeps from left to right in a given phase */
+  bool isForward(int phase) const { return rank_%2 == phase; }
+
+  /** @brief Loads a boundary in memory, also if it has been written to disk */
+  template<class BoundaryType>
+  static void fetchBoundary(BoundaryType& boundary) {
+    Storage::prefetch(boundary);
+    Storage::fetch(boundary);
+  }
+
+  /** @brief Sweeps the segment, leaving the center on its last (forward) or first (backward) site */
+  void sweepSegment(int iSweep, bool forward) {
+    if (forward)
+      for (int site = firstSite_; site < lastSite_-1; site++)
+        optimizeBond(iSweep, site, true);
+    else
+      for (int site = lastSite_-2; site >= firstSite_; site--)
+        optimizeBond(iSweep, site, false);
+  }
+
+  /**
+   * @brief Optimizes the sites [site, site+1] and moves the center by one site.
+   * The boundaries at the edges of the segment are never dropped, since they are
+   * updated only by the edge optimization.
+   */
+  void optimizeBond(int iSweep, int site, bool forward) {
+    siteLeft_ = site;
+    siteRight_ = site+2;
+    fetchBoundary(boundaryPropagator_->getLeftBoundary(siteLeft_));
+    fetchBoundary(boundaryPropagator_->getRightBoundary(siteRight_));
+    if (forward && siteRight_ < lastSite_)
+      Storage::prefetch(boundaryPropagator_->getRightBoundary(siteRight_+1));
+    else if (!forward && siteLeft_ > firstSite_)
+      Storage::prefetch(boundaryPropagator_->getLeftBoundary(siteLeft_-1));
+    this->prepareMicroiteration();
+    auto outputTensor = this->solveLocalProblem();
+    auto modality = forward ? GrowBoundaryModality::LeftToRight : GrowBoundaryModality::RightToLeft;
+    auto truncationResults = mpsUpdater_->generateUnitaryFactor(siteLeft_, siteRight_, modality, outputTensor, this->getAlpha(iSweep),
+                                                                this->get_cutoff(iSweep), this->get_Mmax(iSweep), this->normalizeAtEnd(),
+                                                                this->activatePerturbation());
+    // The split already leaves the center on the next site, so the unitary factor is not merged
+    if (forward) {
+      if (siteRight_ < lastSite_)
+        Storage::drop(boundaryPropagator_->getRightBoundary(siteRight_));
+      boundaryPropagator_->updateLeftBoundary(site+1);
+    }
+    else {
+      if (siteLeft_ > firstSite_)
+        Storage::drop(boundaryPropagator_->getLeftBoundary(siteLeft_));
+      boundaryPropagator_->updateRightBoundary(site+1);
+    }
+    this->finalizeMicroIteration(truncationResults);
+    maquis::trim_memory_pools();
+  }
+
+  /**
+   * @brief Solves the two-site problem across the right edge of the segment.
+   *
+   * The center and the right boundary of the following segment are glued to the center of
+   * this segment through the inverse bond matrix. The resulting U S V is split between the two
+   * segments as U S | V here and U | S V on the following rank.
+   */
+  void optimizeEdge(int iSweep) {
+    int site = lastSite_;
+    auto& leftBoundaries = boundaryPropagator_->getLeftBoundaries();
+    auto& rightBoundaries = boundaryPropagator_->getRightBoundaries();
+    MPSTensorType neighbourCenter;
+    comm_.recv(rank_+1, centerTag, neighbourCenter);
+    fetchBoundary(rightBoundaries[site+1]);
+    Storage::drop(rightBoundaries[site+1]);
+    comm_.recv(rank_+1, boundaryTag, rightBoundaries[site+1]);
+    mps_[site-1].multiply_from_right(bondInverse_);
+    mps_[site] = neighbourCenter;
+    // Solution of the local problem
+    siteLeft_ = site-1;
+    siteRight_ = site+1;
+    fetchBoundary(leftBoundaries[siteLeft_]);
+    this->prepareMicroiteration();
+    auto outputTensor = this->solveLocalProblem();
+    TwoSiteTensor<Matrix, SymmGroup> tst(mps_[site-1], mps_[site]);
+    tst << outputTensor;
+    DiagonalBlockMatrixType s;
+    truncation_results truncationResults;
+    boost::tie(mps_[site-1], s, mps_[site], truncationResults) = tst.split_mps_bond(this->get_Mmax(iSweep), this->get_cutoff(iSweep));
+    // Left boundary of the following segment, which starts from S V
+    boundaryPropagator_->updateLeftBoundary(site);
+    fetchBoundary(leftBoundaries[site]);
+    MPSTensorType neighbourTensor = mps_[site];
+    neighbourTensor.multiply_from_left(s);
+    comm_.send(rank_+1, centerTag, neighbourTensor);
+    comm_.send(rank_+1, boundaryTag, leftBoundaries[site]);
+    // This segment keeps U S as center, and V enters the right boundary
+    mps_[site-1].multiply_from_right(s);
+    boundaryPropagator_->updateRightBoundary(site);
+    bondInverse_ = invertSingularValues(s);
+    this->finalizeMicroIteration(truncationResults);
+    maquis::trim_memory_pools();
+  }
+
+  /** @brief Counterpart of [optimizeEdge] on the rank owning the segment on the right of the edge */
+  void exchangeEdge() {
+    int site = firstSite_;
+    auto& leftBoundaries = boundaryPropagator_->getLeftBoundaries();
+    auto& rightBoundaries = boundaryPropagator_->getRightBoundaries();
+    const MPSType& constMPS = mps_;
+    fetchBoundary(rightBoundaries[site+1]);
+    comm_.send(rank_-1, centerTag, constMPS[site]);
+    comm_.send(rank_-1, boundaryTag, rightBoundaries[site+1]);
+    comm_.recv(rank_-1, centerTag, mps_[site]);
+    fetchBoundary(leftBoundaries[site]);
+    Storage::drop(leftBoundaries[site]);
+    comm_.recv(rank_-1, boundaryTag, leftBoundaries[site]);
+  }
+
+  /** @brief Glues the segments of all ranks into the optimized MPS and calculates its energy */
+  void combineSegments() {
+    if (rank_ < nRanks_-1)
+      mps_[lastSite_-1].multiply_from_right(bondInverse_);
+    const MPSType& constMPS = mps_;
+    std::vector<MPSTensorType> segment(constMPS.const_begin()+firstSite_, constMPS.const_begin()+lastSite_);
+    std::vector<std::vector<MPSTensorType> > segments;
+    boost::mpi::all_gather(comm_, segment, segments);
+    // Each tensor is assigned through the non-const accessor, so that the MPS is not considered canonized anymore
+    int site = 0;
+    for (const auto& iSegment : segments)
+      for (const auto& iTensor : iSegment)
+        mps_[site++] = iTensor;
+    mps_.normalize_right();
+    double energy = maquis::real(expval(mps_, mpoContainer_.getMPO()));
+    iterationResults_.clear();
+    iterationResults_["Energy"] << energy;
+    if (verbose_)
+      maquis::cout << " Energy of the combined MPS = " << std::setprecision(16) << energy << std::endl;
+  }
+
+  /** @brief Inverse of the singular values above the relative cutoff, the others are set to zero */
+  DiagonalBlockMatrixType invertDiagonal(DiagonalBlockMatrixType s) const {
+    double maxValue = 0.;
+    for (std::size_t k = 0; k < s.n_blocks(); k++) {
+      typename DiagonalMatrixType::diagonal_iterator it, end;
+      for (boost::tie(it, end) = s[k].diagonal(); it != end; ++it)
+        maxValue = std::max(maxValue, std::abs(*it));
+    }
+    for (std::size_t k = 0; k < s.n_blocks(); k++) {
+      typename DiagonalMatrixType::diagonal_iterator it, end;
+      for (boost::tie(it, end) = s[k].diagonal(); it != end; ++it)
+        *it = (std::abs(*it) > inverseCutoff_*maxValue) ? 1./(*it) : 0.;
+    }
+    return s;
+  }
+
+  /** @brief Inverse of the singular values, as a dense block matrix */
+  BlockMatrixType invertSingularValues(const DiagonalBlockMatrixType& s) const {
+    BlockMatrixType ret;
+    gemm(invertDiagonal(s), identity_matrix<BlockMatrixType>(s.right_basis()), ret);
+    return ret;
+  }
+
+  /** @brief Pseudo-inverse of a generic bond matrix, X = U S V -> V^+ S^{-1} U^+ */
+  BlockMatrixType invertBondMatrix(const BlockMatrixType& bondMatrix) const {
+    BlockMatrixType u, v, tmp, ret;
+    DiagonalBlockMatrixType s;
+    svd(bondMatrix, u, v, s);
+    u.adjoint_inplace();
+    v.adjoint_inplace();
+    gemm(invertDiagonal(s), u, tmp);
+    gemm(v, tmp, ret);
+    return ret;
+  }
+
+  // Tags of the point-to-point messages
+  enum { bondTag, centerTag, boundaryTag };
+  // Class members
+  boost::mpi::communicator comm_;
+  int rank_, nRanks_, firstSite_, lastSite_;
+  double inverseCutoff_;
+  BlockMatrixType bondInverse_;
+};
+
+#endif // PARALLEL_SWEEP_BASED_ENERGY_MINIMIZATION_H
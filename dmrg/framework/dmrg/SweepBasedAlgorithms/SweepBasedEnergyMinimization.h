@@ -11,6 +11,7 @@
 #include "GenericSweepSimulation.h"
 #include "dmrg/block_matrix/block_matrix_algorithms.h"
 #include "dmrg/optimize/ietl_jacobi_davidson.h"
+#include "dmrg/optimize/ietl_davidson.h"
 #include "dmrg/models/lattice/lattice.h"
 #include "dmrg/mp_tensors/siteproblem.h"
 #include "dmrg/utils/storage.h"
@@ -90,6 +91,9 @@ public:
       resultOfLocalSiteProblem_ = solve_ietl_jcd(*(siteProblem_.get()), mpsToOptimize, parms_, orthoLocal_);
     else if (parms_["eigensolver"] == std::string("IETL_DAVIDSON"))
       resultOfLocalSiteProblem_ = solve_ietl_jcd(*(siteProblem_.get()), mpsToOptimize, parms_, orthoLocal_);
+    else if (parms_["eigensolver"] == std::string("IETL_BLOCK_DAVIDSON"))
+      resultOfLocalSiteProblem_ = solve_ietl_block_davidson(*(siteProblem_.get()), mpsToOptimize, parms_, orthoLocal_,
+                                                            mpoContainer_.getMPO().getCoreEnergy());
     else
       throw std::runtime_error("I don't know this eigensolver.");
     // Loads the final results
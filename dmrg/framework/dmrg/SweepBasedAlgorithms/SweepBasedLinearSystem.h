@@ -103,7 +103,8 @@ public:
       preconditioner_ = std::make_unique<BlockMatrixType>(contraction::diagonal_hamiltonian(boundaryPropagator_->getLeftBoundary(siteLeft_),
                                                                                             boundaryPropagator_->getRightBoundary(siteRight_),
                                                                                             mpoContainer_.getMPOTensor(siteLeft_),
-                                                                                            mpsContainer_.getMPSTensor(siteLeft_)));
+                                                                                            mpsContainer_.getMPSTensor(siteLeft_),
+                                                                                            parms_["ietl_diag_reuse"]));
   }
 
   /** @brief Solution of the site-centered problem */
@@ -36,7 +36,7 @@ public:
   using MPOType = MPO<Matrix, SymmGroup>;
 
   /** @brief Class constructor */
-  SweepMPOContainer(const MPOType& mpo, const MPSType& mps) : mpo_(mpo) {};
+  SweepMPOContainer(const MPOType& mpo, const MPSType& mps, BaseParameters& parms) : mpo_(mpo) {};
 
   /** @brief Getter for the MPOTensor */
   const auto& getMPOTensor(int site) const {
@@ -60,8 +60,8 @@ public:
   using MPSType = MPS<Matrix, SymmGroup>;
 
   /** @brief Class constructor */
-  SweepMPOContainer(const MPOType& mpo, const MPSType& mps) : mpo_(mpo) {
-    make_ts_cache_mpo(mpo, twoSiteMPOCache_, mps);
+  SweepMPOContainer(const MPOType& mpo, const MPSType& mps, BaseParameters& parms) : mpo_(mpo) {
+    make_ts_cache_mpo(mpo, twoSiteMPOCache_, mps, parms);
   }
 
   /** @brief Getter for the MPOTensor */
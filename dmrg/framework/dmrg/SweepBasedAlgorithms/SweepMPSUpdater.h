@@ -48,6 +48,8 @@ public:
       loadedUnitaryFactor_(false)
   {
     L_ = mps_.size();
+    controlledBondExpansion_ = (parms_["singlesite_noise"] == "cbe");
+    expansionRatio_ = parms_["cbe_expansion_ratio"];
   }
 
   /** @brief Method to perform the truncated SVD the MPS for a given site */
@@ -66,9 +68,14 @@ public:
                                                 boundaryPropagator_->getRightBoundary(siteRight), siteLeft, alpha,
                                                 cutoff, mMax, true, verbose_);
         */
-        boost::tie(unitaryFactor, truncationOutput) = Contractor::predict_new_state_l2r_sweep(mps_[siteLeft], mpo_[siteLeft], boundaryPropagator_->getLeftBoundary(siteLeft),
-                                                                                              boundaryPropagator_->getRightBoundary(siteRight), alpha, cutoff, mMax,
-                                                                                              perturbDM, verbose_);
+        if (perturbDM && controlledBondExpansion_)
+          boost::tie(unitaryFactor, truncationOutput) = Contractor::predict_expanded_state_l2r_sweep(mps_[siteLeft], mpo_[siteLeft], boundaryPropagator_->getLeftBoundary(siteLeft),
+                                                                                                     boundaryPropagator_->getRightBoundary(siteRight), alpha, cutoff, mMax,
+                                                                                                     expansionRatio_, verbose_);
+        else
+          boost::tie(unitaryFactor, truncationOutput) = Contractor::predict_new_state_l2r_sweep(mps_[siteLeft], mpo_[siteLeft], boundaryPropagator_->getLeftBoundary(siteLeft),
+                                                                                                boundaryPropagator_->getRightBoundary(siteRight), alpha, cutoff, mMax,
+                                                                                                perturbDM, verbose_);
         zeroSiteTensor_ = Contractor::getZeroSiteTensorL2R(mps_[siteLeft+1], mps_[siteLeft], unitaryFactor);
         mps_[siteLeft] = unitaryFactor;
       }
@@ -84,9 +91,14 @@ public:
                                                  boundaryPropagator_->getRightBoundary(siteRight), siteLeft, alpha,
                                                  cutoff, mMax, true, verbose_);
         */
-        boost::tie(unitaryFactor, truncationOutput) = Contractor::predict_new_state_r2l_sweep(mps_[siteLeft], mpo_[siteLeft], boundaryPropagator_->getLeftBoundary(siteLeft),
-                                                                                              boundaryPropagator_->getRightBoundary(siteRight), alpha, cutoff, mMax,
-                                                                                              perturbDM, verbose_);
+        if (perturbDM && controlledBondExpansion_)
+          boost::tie(unitaryFactor, truncationOutput) = Contractor::predict_expanded_state_r2l_sweep(mps_[siteLeft], mpo_[siteLeft], boundaryPropagator_->getLeftBoundary(siteLeft),
+                                                                                                     boundaryPropagator_->getRightBoundary(siteRight), alpha, cutoff, mMax,
+                                                                                                     expansionRatio_, verbose_);
+        else
+          boost::tie(unitaryFactor, truncationOutput) = Contractor::predict_new_state_r2l_sweep(mps_[siteLeft], mpo_[siteLeft], boundaryPropagator_->getLeftBoundary(siteLeft),
+                                                                                                boundaryPropagator_->getRightBoundary(siteRight), alpha, cutoff, mMax,
+                                                                                                perturbDM, verbose_);
         zeroSiteTensor_ = Contractor::getZeroSiteTensorR2L(mps_[siteLeft-1], mps_[siteLeft], unitaryFactor);
         mps_[siteLeft] = unitaryFactor;
       }
@@ -151,7 +163,8 @@ private:
   BlockMatrixType zeroSiteTensor_;
   BaseParameters& parms_;
   int L_;
-  bool verbose_, loadedUnitaryFactor_;
+  bool verbose_, loadedUnitaryFactor_, controlledBondExpansion_;
+  double expansionRatio_;
 };
 
 /** @brief Specialization for the two-site case */
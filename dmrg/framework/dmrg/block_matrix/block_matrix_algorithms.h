@@ -27,6 +27,7 @@
 #include <boost/type_traits.hpp>
 
 #include "dmrg/utils/parallel.hpp"
+#include "dmrg/utils/parallel/work_stealing.hpp"
 
 /** @brief Struct storing the results of an MPS truncation */
 struct truncation_results {
@@ -161,6 +162,52 @@ void gemm_trim_right(block_matrix<Matrix1, SymmGroup> const & A,
     }
 }
 
+namespace block_decomposition_detail {
+
+/**
+ * @brief Runs [f](k) for all the blocks of a decomposition, given the estimated cost of each block.
+ *
+ * The blocks whose cost exceeds the share of a single thread are decomposed first, one after the
+ * other and outside of any parallel region, so that a threaded LAPACK can use all the cores on them.
+ * The remaining blocks are distributed by decreasing cost to the threads, which steal from each
+ * other once their own queue is empty, so that the many tiny blocks do not cost one scheduling
+ * step each and do not end up behind a large one.
+ */
+template<class Function>
+void run(std::vector<double> const & costs, Function f)
+{
+    int nthreads = parallel::max_threads();
+    double total = std::accumulate(costs.begin(), costs.end(), 0.0);
+    std::vector<std::size_t> small;
+    std::vector<double> small_costs;
+    for (std::size_t k = 0; k < costs.size(); ++k) {
+        if (nthreads > 1 && costs[k] * nthreads > total) {
+            f(k);
+        } else {
+            small.push_back(k);
+            small_costs.push_back(costs[k]);
+        }
+    }
+    if (small.empty())
+        return;
+    parallel::work_stealing_executor executor(small_costs, nthreads);
+    executor.run([&](std::size_t task, int) { f(small[task]); });
+}
+
+/** @brief Singular value decomposition of a 1x1 block, a = 1 * |a| * (a/|a|) as the real gesvd gives it */
+template<class Matrix, class DiagMatrix>
+void svd_scalar(Matrix const & M, Matrix & U, Matrix & V, DiagMatrix & S)
+{
+    typedef typename Matrix::value_type value_type;
+    value_type a = M(0,0);
+    typename maquis::traits::real_type<value_type>::type norm = std::abs(a);
+    U(0,0) = value_type(1.);
+    V(0,0) = (norm > 0.) ? a / norm : value_type(1.);
+    S(0,0) = norm;
+}
+
+}
+
 template<class Matrix, class DiagMatrix, class SymmGroup>
 void svd(block_matrix<Matrix, SymmGroup> const & M,
          block_matrix<Matrix, SymmGroup> & U,
@@ -176,11 +223,18 @@ void svd(block_matrix<Matrix, SymmGroup> const & M,
     U = block_matrix<Matrix, SymmGroup>(r, m);
     V = block_matrix<Matrix, SymmGroup>(m, c);
     S = block_matrix<DiagMatrix, SymmGroup>(m, m);
-    std::size_t loop_max = M.n_blocks();
 
-    omp_for(size_t k, parallel::range<size_t>(0,loop_max), {
+    // The cost of the SVD of an m x n block goes as min(m,n)^2 * max(m,n)
+    std::vector<double> costs(M.n_blocks());
+    for (std::size_t k = 0; k < M.n_blocks(); ++k)
+        costs[k] = double(m[k].second) * m[k].second * std::max(r[k].second, c[k].second);
+
+    block_decomposition_detail::run(costs, [&](std::size_t k) {
         parallel::guard proc(scheduler(k));
-        svd(M[k], U[k], V[k], S[k]);
+        if (num_rows(M[k]) == 1 && num_cols(M[k]) == 1)
+            block_decomposition_detail::svd_scalar(M[k], U[k], V[k], S[k]);
+        else
+            svd(M[k], U[k], V[k], S[k]);
     });
 }
 
@@ -192,8 +246,18 @@ void heev(block_matrix<Matrix, SymmGroup> const & M,
     parallel::scheduler_balanced scheduler(M);
     evecs = block_matrix<Matrix, SymmGroup>(M.basis());
     evals = block_matrix<DiagMatrix, SymmGroup>(M.basis());
-    omp_for(size_t k, parallel::range<size_t>(0,M.n_blocks()), {
+
+    std::vector<double> costs(M.n_blocks());
+    for (std::size_t k = 0; k < M.n_blocks(); ++k)
+        costs[k] = std::pow(double(num_rows(M[k])), 3);
+
+    block_decomposition_detail::run(costs, [&](std::size_t k) {
         parallel::guard proc(scheduler(k));
+        if (num_rows(M[k]) == 1) {
+            evals[k](0,0) = maquis::real(M[k](0,0));
+            evecs[k](0,0) = typename Matrix::value_type(1.);
+            return;
+        }
         heev(M[k], evecs[k], evals[k]);
         BlockMatrixAlgorithmsHelperClass<Matrix, SymmGroup>::adjustPhase(evecs[k]);
     });
@@ -211,7 +275,7 @@ template<class DiagMatrix, class SymmGroup>
 void estimate_truncation(block_matrix<DiagMatrix, SymmGroup> const & evals,
                          size_t Mmax, double cutoff, size_t* keeps,
                          double & truncated_fraction, double & truncated_weight, double & smallest_ev)
-{ // to be parallelized later (30.04.2012)
+{
     typedef typename DiagMatrix::value_type value_type;
     typedef typename maquis::traits::real_type<value_type>::type real_type;
 
@@ -234,23 +298,28 @@ void estimate_truncation(block_matrix<DiagMatrix, SymmGroup> const & evals,
     }
 
     assert( allevals.size() > 0 );
-    std::sort(allevals.begin(), allevals.end());
-    std::reverse(allevals.begin(), allevals.end());
+    real_type maxeval = *std::max_element(allevals.begin(), allevals.end());
+    real_type evalscut = cutoff * maxeval;
 
-    real_type evalscut = cutoff * allevals[0];
-
-    if (allevals.size() > Mmax)
+    // Only the (Mmax+1)-th largest eigenvalue is needed, not the full ordering
+    if (allevals.size() > Mmax) {
+        std::nth_element(allevals.begin(), allevals.begin() + Mmax, allevals.end(), std::greater<real_type>());
         evalscut = std::max(evalscut, allevals[Mmax]);
-    smallest_ev = evalscut / allevals[0];
+    }
+    smallest_ev = evalscut / maxeval;
 
     truncated_fraction = 0.0; truncated_weight = 0.0;
-    for (typename real_vector_t::const_iterator it = std::find_if(allevals.begin(), allevals.end(), boost::lambda::_1 < evalscut);
-         it != allevals.end(); ++it) {
-        truncated_fraction += *it;
-        truncated_weight += (*it)*(*it);
+    double norm_fraction = 0.0, norm_weight = 0.0;
+    for (typename real_vector_t::const_iterator it = allevals.begin(); it != allevals.end(); ++it) {
+        norm_fraction += *it;
+        norm_weight += (*it)*(*it);
+        if (*it < evalscut) {
+            truncated_fraction += *it;
+            truncated_weight += (*it)*(*it);
+        }
     }
-    truncated_fraction /= std::accumulate(allevals.begin(), allevals.end(), 0.0);
-    truncated_weight /= std::accumulate(allevals.begin(), allevals.end(), 0.0,  boost::lambda::_1 + boost::lambda::_2 *boost::lambda::_2);
+    truncated_fraction /= norm_fraction;
+    truncated_weight /= norm_weight;
 
     for(std::size_t k = 0; k < evals.n_blocks(); ++k){
         real_vector_t evals_k(num_rows(evals[k]));
@@ -130,14 +130,14 @@ namespace maquis { namespace dmrg { namespace detail {
                      size_t left_offset, size_t right_offset, 
                      size_t sdim, size_t ldim, size_t rdim)
     {
+        // The ldim elements of a slice are contiguous in both matrices
+        if (ldim == 0)
+            return;
         for (size_t ss = 0; ss < sdim; ++ss)
-            for (size_t rr = 0; rr < rdim; ++rr)
-                for(size_t ll = 0; ll < ldim; ++ll)
-                    left(left_offset + ss*ldim+ll, rr) = 
-                    right(ll, right_offset + ss*rdim+rr);
-        // memcpy(&left(left_offset + ss*ldim, rr),
-        //        &right(0, right_offset + ss*rdim+rr),
-        //        sizeof(T) * ldim);
+            for (size_t rr = 0; rr < rdim; ++rr) {
+                typename alps::numeric::matrix<T,A2>::const_col_element_iterator in = right.col(right_offset + ss*rdim+rr).first;
+                std::copy(in, in + ldim, left.col(rr).first + left_offset + ss*ldim);
+            }
     }
     
     template <typename T, class A1, class A2>
@@ -145,10 +145,13 @@ namespace maquis { namespace dmrg { namespace detail {
                      size_t left_offset, size_t right_offset, 
                      size_t sdim, size_t ldim, size_t rdim)
     {
+        if (ldim == 0)
+            return;
         for (size_t ss = 0; ss < sdim; ++ss)
-            for (size_t rr = 0; rr < rdim; ++rr)
-                for (size_t ll = 0; ll < ldim; ++ll)
-                    right(ll, right_offset + ss*rdim+rr) = left(left_offset + ss*ldim+ll, rr);
+            for (size_t rr = 0; rr < rdim; ++rr) {
+                typename alps::numeric::matrix<T,A1>::const_col_element_iterator in = left.col(rr).first + left_offset + ss*ldim;
+                std::copy(in, in + ldim, right.col(right_offset + ss*rdim+rr).first);
+            }
     }
     
     template <typename T, class A>
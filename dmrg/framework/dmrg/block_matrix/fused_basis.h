@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef FUSED_BASIS_H
+#define FUSED_BASIS_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+/**
+ * @brief Fusion of two indices, together with the offsets of the fused sectors.
+ *
+ * Bundles the fused index (a * b, or adjoin(a) * b for the conjugate fusion) and the matching
+ * ProductBasis, and offers hashed charge-to-position lookups in the fused index.
+ * The object is immutable and depends only on the content of the two input indices, so that
+ * [get] can serve the same instance to all the contractions of a site, and a new one is built
+ * only when the bond basis has changed (i.e. after a truncation).
+ */
+template<class SymmGroup>
+class FusedBasis
+{
+public:
+    typedef typename SymmGroup::charge charge;
+
+    /**
+     * @brief Returns the fusion of [a] and [b], looking first in a per-thread cache of recently used bases.
+     * @param conjugate_first if true, the charges of [a] enter the fusion with the opposite sign.
+     */
+    static std::shared_ptr<const FusedBasis> get(Index<SymmGroup> const & a, Index<SymmGroup> const & b,
+                                                 bool conjugate_first = false)
+    {
+        static const std::size_t capacity = 32;
+        static thread_local std::vector<std::shared_ptr<const FusedBasis> > recent;
+        for (std::size_t i = 0; i < recent.size(); ++i) {
+            if (recent[i]->matches(a, b, conjugate_first)) {
+                std::rotate(recent.begin(), recent.begin() + i, recent.begin() + i + 1);
+                return recent.front();
+            }
+        }
+        std::shared_ptr<const FusedBasis> ret(new FusedBasis(a, b, conjugate_first));
+        if (recent.size() == capacity)
+            recent.pop_back();
+        recent.insert(recent.begin(), ret);
+        return ret;
+    }
+
+    /** @brief Fused index */
+    Index<SymmGroup> const & index() const { return fused_; }
+
+    /** @brief Offsets of the pairs of input sectors within the fused sectors */
+    ProductBasis<SymmGroup> const & offsets() const { return *offsets_; }
+
+    /** @brief Position of the charge [c] in the fused index, index().size() if not present */
+    std::size_t position(charge c) const
+    {
+        typename boost::unordered_map<charge, std::size_t>::const_iterator match = positions_.find(c);
+        return (match == positions_.end()) ? fused_.size() : match->second;
+    }
+
+    bool has(charge c) const { return positions_.count(c) > 0; }
+
+    std::size_t size_of_block(charge c) const
+    {
+        assert( has(c) );
+        return fused_[position(c)].second;
+    }
+
+    bool matches(Index<SymmGroup> const & a, Index<SymmGroup> const & b, bool conjugate_first) const
+    {
+        return conjugate_first == conjugate_first_ && a == a_ && b == b_;
+    }
+
+private:
+    FusedBasis(Index<SymmGroup> const & a, Index<SymmGroup> const & b, bool conjugate_first)
+    : a_(a), b_(b), conjugate_first_(conjugate_first)
+    {
+        if (conjugate_first) {
+            fused_ = adjoin(a) * b;
+            offsets_.reset(new ProductBasis<SymmGroup>(a, b, boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
+                                                                                 -boost::lambda::_1, boost::lambda::_2)));
+        } else {
+            fused_ = a * b;
+            offsets_.reset(new ProductBasis<SymmGroup>(a, b));
+        }
+        for (std::size_t k = 0; k < fused_.size(); ++k)
+            positions_[fused_[k].first] = k;
+    }
+
+    Index<SymmGroup> a_, b_, fused_;
+    bool conjugate_first_;
+    std::unique_ptr<ProductBasis<SymmGroup> > offsets_;
+    boost::unordered_map<charge, std::size_t> positions_;
+};
+
+#endif
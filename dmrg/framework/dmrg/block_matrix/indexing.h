@@ -11,5 +11,6 @@
 //#include "dmrg/block_matrix/indexing_sorted.hpp"
 //#include "dmrg/block_matrix/indexing_unsorted.hpp"
 #include "dmrg/block_matrix/indexing_stable.hpp"
+#include "dmrg/block_matrix/fused_basis.h"
 
 #endif
@@ -353,7 +353,8 @@ public:
     inline size_t size(charge pc) const
     {
         assert(size_.count(pc) > 0);
-        return size_[pc];
+        typename boost::unordered_map<charge, size_t>::const_iterator match = size_.find(pc);
+        return (match == size_.end()) ? 0 : match->second;
     }
 
     // for the moment let's avoid the default template argument (C++11)
@@ -366,11 +367,12 @@ public:
     {
         charge pc = f(a, b);
         assert(size_.count(pc) > 0);
-        return size_[pc];
+        typename boost::unordered_map<charge, size_t>::const_iterator match = size_.find(pc);
+        return (match == size_.end()) ? 0 : match->second;
     }
 
 private:
-    mutable boost::unordered_map<charge, size_t> size_;
+    boost::unordered_map<charge, size_t> size_;
     boost::unordered_map<std::pair<charge, charge>, size_t> keys_vals_;
 };
 
@@ -11,19 +11,19 @@
 #include <boost/serialization/serialization.hpp>
 
 template<class Matrix, class SymmGroup>
-SiteOperator<Matrix, SymmGroup>::SiteOperator()
+SiteOperator<Matrix, SymmGroup>::SiteOperator() : spin_basis()
 {
 }
 
 template<class Matrix, class SymmGroup>
 SiteOperator<Matrix, SymmGroup>::SiteOperator(Index<SymmGroup> const & rows,
-                                              Index<SymmGroup> const & cols) : bm_(rows, cols)
+                                              Index<SymmGroup> const & cols) : spin_basis(), bm_(rows, cols)
 {
 }
 
 template<class Matrix, class SymmGroup>
 SiteOperator<Matrix, SymmGroup>::SiteOperator(DualIndex<SymmGroup> const & basis)
-: bm_(basis)
+: spin_basis(), bm_(basis)
 {
 }
 
@@ -304,7 +304,7 @@ template<class Matrix, class SymmGroup>
 template <class Archive>
 void SiteOperator<Matrix, SymmGroup>::serialize(Archive & ar, const unsigned int version)
 {
-    ar & bm_;
+    ar & spin_ & spin_basis & bm_;
 }
 
 namespace SiteOperator_detail {
@@ -0,0 +1,172 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef SU2_COUPLING_TABLE_H
+#define SU2_COUPLING_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace SU2 {
+
+    /**
+     * @brief Table of coefficients partitioned in slabs, one per value of the leading spin.
+     *
+     * A slab is allocated and filled upon its first access. Threads which access a missing slab
+     * concurrently fill their own copy, and only one of them is published with a compare-and-swap.
+     * Hence, the table can be extended lazily without locks, and the lookup of an existing slab
+     * is a single atomic load.
+     */
+    template<class Filler>
+    class lazy_slab_table
+    {
+    public:
+        lazy_slab_table(std::size_t slab_size, int max_slabs, Filler filler)
+            : slab_size_(slab_size), max_slabs_(max_slabs), filler_(filler), slabs_(new std::atomic<double*>[max_slabs])
+        {
+            for (int a = 0; a < max_slabs_; ++a)
+                slabs_[a].store(nullptr);
+        }
+
+        ~lazy_slab_table()
+        {
+            for (int a = 0; a < max_slabs_; ++a)
+                delete[] slabs_[a].load();
+        }
+
+        lazy_slab_table(lazy_slab_table const &) = delete;
+        lazy_slab_table & operator=(lazy_slab_table const &) = delete;
+
+        int max_slabs() const { return max_slabs_; }
+
+        double const * slab(int a) const
+        {
+            double * ret = slabs_[a].load(std::memory_order_acquire);
+            if (ret != nullptr)
+                return ret;
+            std::unique_ptr<double[]> fresh(new double[slab_size_]);
+            filler_(a, fresh.get());
+            if (slabs_[a].compare_exchange_strong(ret, fresh.get(), std::memory_order_acq_rel))
+                return fresh.release();
+            // Another thread has been faster, [ret] now holds its slab
+            return ret;
+        }
+
+        /** @brief Number of slabs filled so far */
+        int filled_slabs() const
+        {
+            int ret = 0;
+            for (int a = 0; a < max_slabs_; ++a)
+                ret += (slabs_[a].load(std::memory_order_relaxed) != nullptr);
+            return ret;
+        }
+
+    private:
+        std::size_t slab_size_;
+        int max_slabs_;
+        Filler filler_;
+        std::unique_ptr<std::atomic<double*>[]> slabs_;
+    };
+
+    /**
+     * @brief Dense table of the Wigner 9j symbols appearing in the SU2 contractions.
+     *
+     * The 9j symbols { a b c ; d e f ; g h i } of the contractions couple the spins a, c, g, i of the
+     * MPS and boundary blocks with the operator spins b, d, e, f, h, which are all <= 2 (in units of 1/2).
+     * By the triangle conditions, c and g differ from a, and i from g, by at most 2. The symbol is
+     * therefore stored in the slab of a, at the position given by the packed quantum numbers
+     *
+     *   ((((((((b*3 + d)*3 + e)*3 + f)*3 + h)*5 + c-a+2)*5 + g-a+2)*5 + i-g+2
+     *
+     * When filling a slab, the symmetry under transposition (b <-> d, c <-> g, f <-> h), which leaves a
+     * fixed, halves the number of evaluations. Symbols violating a triangle condition are stored as zero.
+     */
+    class Wigner9jTable
+    {
+        struct filler
+        {
+            void operator()(int a, double * slab) const;
+        };
+
+    public:
+        static const std::size_t slab_size = 243*125;
+
+        explicit Wigner9jTable(int max_a = 256) : table_(slab_size, max_a, filler()) { }
+
+        /** @brief Loads the symbol in [ret], returns false if it is not covered by the table */
+        bool lookup(int a, int b, int c, int d, int e, int f, int g, int h, int i, double & ret) const
+        {
+            unsigned dc = c - a + 2, dg = g - a + 2, di = i - g + 2;
+            if (static_cast<unsigned>(a) >= static_cast<unsigned>(table_.max_slabs())
+                || static_cast<unsigned>(b) > 2 || static_cast<unsigned>(d) > 2 || static_cast<unsigned>(e) > 2
+                || static_cast<unsigned>(f) > 2 || static_cast<unsigned>(h) > 2 || dc > 4 || dg > 4 || di > 4)
+                return false;
+            ret = table_.slab(a)[index(b, d, e, f, h, dc, dg, di)];
+            return true;
+        }
+
+        /** @brief Fills all the slabs up to a = max */
+        void reserve(int max) const
+        {
+            for (int a = 0; a <= max && a < table_.max_slabs(); ++a)
+                table_.slab(a);
+        }
+
+        int filled_slabs() const { return table_.filled_slabs(); }
+
+        static std::size_t index(int b, int d, int e, int f, int h, int dc, int dg, int di)
+        {
+            return ((((((b*3 + d)*3 + e)*3 + f)*3 + h)*5 + dc)*5 + dg)*5 + di;
+        }
+
+    private:
+        lazy_slab_table<filler> table_;
+    };
+
+    /**
+     * @brief Dense table of the Wigner 6j symbols { a b c ; d e f } with c, d, e <= 2.
+     *
+     * By the triangle conditions b and f differ from a by at most 2, and the symbol is stored in the
+     * slab of a at the position (((c*3 + d)*3 + e)*5 + b-a+2)*5 + f-a+2.
+     */
+    class Wigner6jTable
+    {
+        struct filler
+        {
+            void operator()(int a, double * slab) const;
+        };
+
+    public:
+        static const std::size_t slab_size = 27*25;
+
+        explicit Wigner6jTable(int max_a = 256) : table_(slab_size, max_a, filler()) { }
+
+        /** @brief Loads the symbol in [ret], returns false if it is not covered by the table */
+        bool lookup(int a, int b, int c, int d, int e, int f, double & ret) const
+        {
+            unsigned db = b - a + 2, df = f - a + 2;
+            if (static_cast<unsigned>(a) >= static_cast<unsigned>(table_.max_slabs())
+                || static_cast<unsigned>(c) > 2 || static_cast<unsigned>(d) > 2 || static_cast<unsigned>(e) > 2
+                || db > 4 || df > 4)
+                return false;
+            ret = table_.slab(a)[index(c, d, e, db, df)];
+            return true;
+        }
+
+        static std::size_t index(int c, int d, int e, int db, int df)
+        {
+            return (((c*3 + d)*3 + e)*5 + db)*5 + df;
+        }
+
+    private:
+        lazy_slab_table<filler> table_;
+    };
+
+}
+
+#endif
@@ -8,10 +8,7 @@
 #ifndef GSL_COUPLING_H
 #define GSL_COUPLING_H
 
-#include <unordered_map>
-#include <mutex>
 #include <iostream>
-#include "hash_tuple.h"
 
 #include <cmath>
 
@@ -29,32 +26,23 @@ namespace SU2 {
 
 }
 
+#include "coupling_table.h"
+
 class WignerWrapper
 {
     public:
         // Global variable that enables or disables the cache
         static bool UseCache;
 
-        // Print the cache contents, useful for debugging.
-        static void print_map_contents()
+        // Print the cache size, useful for debugging.
+        static void print_cache_statistics()
         {
-            for (auto&& m: map)
-                std::cout << std::get<0>(m.first) << " "
-                             << std::get<1>(m.first) << " "
-                             << std::get<2>(m.first) << " "
-                             << std::get<3>(m.first) << " "
-                             << std::get<4>(m.first) << " "
-                             << std::get<5>(m.first) << " "
-                             << std::get<6>(m.first) << " "
-                             << std::get<7>(m.first) << " "
-                             << std::get<8>(m.first) << " "
-                             << m.second << std::endl;
-            std::cout << "Number of elements: " << map.size() << std::endl;
-
+            std::cout << "Wigner 9j table: " << table_9j.filled_slabs() << " slabs of "
+                      << SU2::Wigner9jTable::slab_size << " elements" << std::endl;
         }
 
-        // \brief Fills the Wigner 9j cache with elements up to (max,2,max,2,2,2,max,2,max)
-        // Zero elements are not added to the cache
+        // \brief Fills the Wigner 9j table with the slabs up to a = max
+        // Larger slabs are filled lazily, upon their first use.
         // \param max maximum index for symbols, calculated as  (max_spin + spin)/2
         //  with max_spin as maximum number of unpaired electrons (see also sim::sim())
         static void fill_cache(int max);
@@ -67,7 +55,9 @@ class WignerWrapper
 
         inline static double gsl_sf_coupling_6j(int two_ja, int two_jb, int two_jc, int two_jd, int two_je, int two_jf)
         {
-
+            double ret;
+            if (UseCache && table_6j.lookup(two_ja, two_jb, two_jc, two_jd, two_je, two_jf, ret))
+                return ret;
             return ::gsl_sf_coupling_6j(two_ja, two_jb, two_jc, two_jd, two_je, two_jf);
         }
         // \brief Calculate the Wigner 9j symbol, or obtain it from cache
@@ -94,8 +84,8 @@ class WignerWrapper
                 std::swap(two_jd, two_jh);
             }
 
-            // Other Wigner 9j symmetries are ignored because the cache is small enough anyway, and too many symmetry checks here might degrade performance
-            // besides, the previous implementations did not seem to work
+            // The transposition symmetry is also exploited when the table is filled. The other Wigner 9j symmetries
+            // are ignored because too many symmetry checks here might degrade performance
 
             return (UseCache) ?
                wigner9j_cache(two_ja, two_jb, two_jc, two_jd, two_je, two_jf, two_jg, two_jh, two_ji)
@@ -104,45 +94,22 @@ class WignerWrapper
 
 
         private:
-            typedef std::tuple<int, int, int, int, int, int, int, int, int> gsl_indices;
-            typedef std::unordered_map<gsl_indices, double, hash_tuple::hash<gsl_indices> > map_type;
-
-            // The map that stores the values
-            static map_type map;
+            // Dense tables of the symbols appearing in the SU2 contractions
+            static SU2::Wigner9jTable table_9j;
+            static SU2::Wigner6jTable table_6j;
 
+            // Obtains the value from the table, symbols which are not covered by the table are calculated directly
             inline static double wigner9j_cache(int a, int b, int c,
                                     int d, int e, int f,
                                     int g, int h, int i)
             {
-                gsl_indices idx=std::make_tuple(a,b,c,d,e,f,g,h,i);
                 double ret;
-                // Search for the value in cache
-                auto map_idx = map.find(idx);
-                // If value not found in cache, issue a warning and calculate it
-                if (map_idx == map.end())
-                {
-
-                    ret = WignerWrapper::wigner9j_nocache(a, b, c,
-                                             d, e, f,
-                                             g, h, i);
-
-                    // print a warning
-                    std::cout << "Warning: Wigner 9j symbol for " << a << "," << b << "," << c <<
-                                                              "," << d << "," << e << "," << f <<
-                                                              "," << g << "," << h << "," << i << " not found in cache." << std::endl;
-
-                    // alternatively, add the missing value to the cache, but this is not threadsafe so has been disabled
-                    //map[idx] = ret;
-
-
-                }
-                else // use the cached value
-                {
-                    ret = map_idx->second;
-                }
-                return ret;
+                if (table_9j.lookup(a, b, c, d, e, f, g, h, i, ret))
+                    return ret;
+                return WignerWrapper::wigner9j_nocache(a, b, c, d, e, f, g, h, i);
             }
 
+        public:
             inline static bool triangle_9j_fails(int two_ja, int two_jb, int two_jc, int two_jd, int two_je, int two_jf, int two_jg, int two_jh, int two_ji)
             {
                   return (( !SU2::triangle( two_ja, two_jb, two_jc ) ) ||
@@ -153,6 +120,7 @@ class WignerWrapper
                         ( !SU2::triangle( two_jc, two_jf, two_ji ) ));
 
             }
+        private:
             inline static double wigner9j_nocache(int two_ja, int two_jb, int two_jc, int two_jd, int two_je, int two_jf, int two_jg, int two_jh, int two_ji)
             {
                 return ::gsl_sf_coupling_9j(two_ja, two_jb, two_jc, two_jd, two_je, two_jf, two_jg, two_jh, two_ji);
@@ -9,28 +9,60 @@
 
 bool WignerWrapper::UseCache = false;
 
-typename WignerWrapper::map_type WignerWrapper::map;
+SU2::Wigner9jTable WignerWrapper::table_9j;
+SU2::Wigner6jTable WignerWrapper::table_6j;
 
 void WignerWrapper::fill_cache(int max)
 {
     if (!UseCache) return;
 
-    double dummy;
-    for (int i = 0; i <= max; i++)
-    for (int j = 0; j <= 2; j++)
-    for (int k = 0; k <= max; k++)
-    for (int l = 0; l <= 2; l++)
-    for (int m = 0; m <= 2; m++)
-    for (int n = 0; n <= 2; n++)
-    for (int o = 0; o <= max; o++)
-    for (int p = 0; p <= 2; p++)
-    for (int q = 0; q <= max; q++)
+    table_9j.reserve(max);
+}
+
+void SU2::Wigner9jTable::filler::operator()(int a, double * slab) const
+{
+    for (int b = 0; b <= 2; b++)
+    for (int d = 0; d <= 2; d++)
+    for (int e = 0; e <= 2; e++)
+    for (int f = 0; f <= 2; f++)
+    for (int h = 0; h <= 2; h++)
+    for (int dc = 0; dc <= 4; dc++)
+    for (int dg = 0; dg <= 4; dg++)
+    for (int di = 0; di <= 4; di++)
     {
-        // maybe not required
-        // only include cases l==m==n for l==0
-        if ((l == m && m == n) && (l != 0)) continue;
+        int c = a + dc - 2, g = a + dg - 2, i = g + di - 2;
+        std::size_t idx = index(b, d, e, f, h, dc, dg, di);
+        // The transposed symbol { a d g ; b e h ; c f i } has the same value, and it is
+        // copied if it has been calculated already
+        int dit = i - c + 2;
+        if (dit >= 0 && dit <= 4) {
+            std::size_t tidx = index(d, b, e, h, f, dg, dc, dit);
+            if (tidx < idx) {
+                slab[idx] = slab[tidx];
+                continue;
+            }
+        }
+        // Negative spins violate the triangle conditions as well
+        if (WignerWrapper::triangle_9j_fails(a, b, c, d, e, f, g, h, i))
+            slab[idx] = 0.;
+        else
+            slab[idx] = ::gsl_sf_coupling_9j(a, b, c, d, e, f, g, h, i);
+    }
+}
 
-        if (!triangle_9j_fails(i,j,k,l,m,n,o,p,q)) // make sure zero values are not cached
-            map[std::make_tuple(i,j,k,l,m,n,o,p,q)] = WignerWrapper::wigner9j_nocache(i,j,k,l,m,n,o,p,q);
+void SU2::Wigner6jTable::filler::operator()(int a, double * slab) const
+{
+    for (int c = 0; c <= 2; c++)
+    for (int d = 0; d <= 2; d++)
+    for (int e = 0; e <= 2; e++)
+    for (int db = 0; db <= 4; db++)
+    for (int df = 0; df <= 4; df++)
+    {
+        int b = a + db - 2, f = a + df - 2;
+        std::size_t idx = index(c, d, e, db, df);
+        if (!triangle(a, b, c) || !triangle(a, e, f) || !triangle(d, b, f) || !triangle(d, e, c))
+            slab[idx] = 0.;
+        else
+            slab[idx] = ::gsl_sf_coupling_6j(a, b, c, d, e, f);
     }
 }
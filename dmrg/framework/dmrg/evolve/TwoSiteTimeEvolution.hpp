@@ -59,7 +59,7 @@ public:
     : base(mps, mpo, parms_, stop_callback_, to_site(mps.length(), initial_site_))
   {
     parallel::guard::serial guard;
-    make_ts_cache_mpo(mpo, ts_cache_mpo, mps);
+    make_ts_cache_mpo(mpo, ts_cache_mpo, mps, parms_);
   }
 
   /**
@@ -8,25 +8,97 @@
 #ifndef OPTABLE_H
 #define OPTABLE_H
 
+#include <algorithm>
 #include <vector>
 #include <utility>
 #include <stdexcept>
+#include <mutex>
+#include <unordered_map>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
 #include "dmrg/models/tag_detail.h"
+#include "dmrg/models/OperatorHandlers/SegmentedVector.h"
 
+/**
+ * @brief Table of the site operators, indexed by their tag.
+ *
+ * The table can be shared by several threads: operators can be registered concurrently, and the
+ * registered operators can be accessed while other threads register new ones.
+ * The sparse representation of the operators is updated when they are registered, so that
+ * registered operators are not modified by the MPO tensors which refer to them.
+ * The operators are indexed by a hash of their content, split in independently locked shards, so that
+ * [checked_register] only compares the sample with the operators of the same hash.
+ * Operators which are modified in place after being registered are not found by [checked_register]
+ * anymore, unless they are modified with [replace].
+ */
 template <class Matrix, class SymmGroup>
-class OPTable : public std::vector<typename operator_selector<Matrix, SymmGroup>::type>
+class OPTable
 {
 public:
     typedef tag_detail::tag_type tag_type;
     typedef typename operator_selector<Matrix, SymmGroup>::type op_t;
+    typedef op_t value_type;
 
 private:
     typedef typename Matrix::value_type mvalue_type;
 
 public:
+    OPTable() { }
+    OPTable(OPTable const & rhs);
+    OPTable & operator=(OPTable const & rhs);
+
+    std::size_t size() const { return operators.size(); }
+    bool empty() const { return operators.empty(); }
+    op_t & operator[](tag_type i) { return operators[i]; }
+    op_t const & operator[](tag_type i) const { return operators[i]; }
+
     tag_type register_op(op_t const & op_);
     std::pair<tag_type, mvalue_type> checked_register(const op_t& sample);
-    bool hasRegistered(const op_t& sample);
+    bool hasRegistered(const op_t& sample) const;
+    void replace(tag_type i, op_t const & op_);
+
+    // The operators are stored in place and not through a temporary copy: the archive tracks the
+    // addresses of their blocks, which must not be reused by other objects of the same archive.
+    template <class Archive>
+    void save(Archive & ar, const unsigned int version) const
+    {
+        std::size_t n = size();
+        ar & n;
+        for (std::size_t i = 0; i < n; ++i)
+            ar & operators[i];
+    }
+
+    template <class Archive>
+    void load(Archive & ar, const unsigned int version)
+    {
+        std::size_t n;
+        ar & n;
+        std::vector<op_t> ops(n);
+        for (std::size_t i = 0; i < n; ++i)
+            ar & ops[i];
+        *this = OPTable();
+        for (op_t const & op : ops)
+            register_op(op);
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+private:
+    struct shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<std::size_t, std::vector<tag_type> > tags;
+    };
+    static const std::size_t num_shards = 16;
+
+    shard & shard_of(std::size_t hash) { return shards[hash % num_shards]; }
+    shard const & shard_of(std::size_t hash) const { return shards[hash % num_shards]; }
+    std::pair<bool, std::pair<tag_type, mvalue_type> > find_(shard const & s, std::size_t hash, op_t const & sample) const;
+    void index_(shard & s, std::size_t hash, tag_type tag);
+    tag_type append_(op_t const & op_);
+
+    SegmentedVector<op_t> operators;
+    shard shards[num_shards];
 };
 
 #include "OpTable.hpp"
@@ -8,12 +8,38 @@
 #ifndef OPTABLE_HPP
 #define OPTABLE_HPP
 
+template <class Matrix, class SymmGroup>
+OPTable<Matrix, SymmGroup>::OPTable(OPTable const & rhs)
+    : operators(rhs.operators)
+{
+    for (std::size_t s = 0; s < num_shards; ++s) {
+        std::lock_guard<std::mutex> lock(rhs.shards[s].mutex);
+        shards[s].tags = rhs.shards[s].tags;
+    }
+}
+
+template <class Matrix, class SymmGroup>
+OPTable<Matrix, SymmGroup> & OPTable<Matrix, SymmGroup>::operator=(OPTable const & rhs)
+{
+    if (this != &rhs) {
+        operators = rhs.operators;
+        for (std::size_t s = 0; s < num_shards; ++s) {
+            std::lock_guard<std::mutex> lock(rhs.shards[s].mutex);
+            shards[s].tags = rhs.shards[s].tags;
+        }
+    }
+    return *this;
+}
+
 template <class Matrix, class SymmGroup>
 typename OPTable<Matrix, SymmGroup>::tag_type
 OPTable<Matrix, SymmGroup>::register_op(op_t const & op_)
 {
-    tag_type ret = this->size();
-    this->push_back(op_);
+    std::size_t hash = tag_detail::scale_invariant_hash(op_);
+    shard & s = shard_of(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    tag_type ret = append_(op_);
+    index_(s, hash, ret);
     return ret;
 }
 
@@ -21,31 +47,77 @@ template <class Matrix, class SymmGroup>
 std::pair<typename OPTable<Matrix, SymmGroup>::tag_type, typename OPTable<Matrix, SymmGroup>::mvalue_type>
 OPTable<Matrix, SymmGroup>::checked_register(op_t const& sample)
 {
-    std::pair<bool, mvalue_type> cmp_result;
-    typename std::vector<op_t>::iterator it_pt = this->begin();
-    for (; it_pt != this->end(); ++it_pt) {
-        cmp_result = tag_detail::equal(*it_pt, sample);
-        if (cmp_result.first)
-            break;
-    }
-    if (it_pt == this->end()) {
-        return std::make_pair(this->register_op(sample), 1.0);
-    } else
-        return std::make_pair(it_pt - this->begin(), cmp_result.second);
+    std::size_t hash = tag_detail::scale_invariant_hash(sample);
+    shard & s = shard_of(hash);
+    // The shard stays locked until the sample is registered, so that it is registered only once
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::pair<bool, std::pair<tag_type, mvalue_type> > match = find_(s, hash, sample);
+    if (match.first)
+        return match.second;
 
+    tag_type ret = append_(sample);
+    index_(s, hash, ret);
+    return std::make_pair(ret, 1.0);
+}
+
+template <class Matrix, class SymmGroup>
+bool OPTable<Matrix, SymmGroup>::hasRegistered(const op_t& sample) const
+{
+    std::size_t hash = tag_detail::scale_invariant_hash(sample);
+    shard const & s = shard_of(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return find_(s, hash, sample).first;
 }
 
+/** Not thread-safe with respect to the accesses to the operator [i] */
 template <class Matrix, class SymmGroup>
-bool OPTable<Matrix, SymmGroup>::hasRegistered(const op_t& sample)
+void OPTable<Matrix, SymmGroup>::replace(tag_type i, op_t const & op_)
 {
-    std::pair<bool, mvalue_type> cmp_result;
-    typename std::vector<op_t>::iterator it_pt = this->begin();
-    for (; it_pt != this->end(); ++it_pt) {
-        cmp_result = tag_detail::equal(*it_pt, sample);
-        if (cmp_result.first)
-            break;
+    std::size_t old_hash = tag_detail::scale_invariant_hash(operators[i]);
+    {
+        shard & s = shard_of(old_hash);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        std::vector<tag_type> & bucket = s.tags[old_hash];
+        bucket.erase(std::remove(bucket.begin(), bucket.end(), i), bucket.end());
     }
-    return !(it_pt == this->end());
+    operators[i] = op_;
+    operators[i].update_sparse();
+    std::size_t hash = tag_detail::scale_invariant_hash(operators[i]);
+    shard & s = shard_of(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    index_(s, hash, i);
+}
+
+// The operators of a bucket are compared in the order of their tags, so that the
+// first registered operator matching the sample is returned.
+template <class Matrix, class SymmGroup>
+std::pair<bool, std::pair<typename OPTable<Matrix, SymmGroup>::tag_type, typename OPTable<Matrix, SymmGroup>::mvalue_type> >
+OPTable<Matrix, SymmGroup>::find_(shard const & s, std::size_t hash, op_t const & sample) const
+{
+    typename std::unordered_map<std::size_t, std::vector<tag_type> >::const_iterator bucket = s.tags.find(hash);
+    if (bucket != s.tags.end())
+        for (tag_type tag : bucket->second) {
+            std::pair<bool, mvalue_type> cmp_result = tag_detail::equal(operators[tag], sample);
+            if (cmp_result.first)
+                return std::make_pair(true, std::make_pair(tag, cmp_result.second));
+        }
+    return std::make_pair(false, std::make_pair(tag_type(0), mvalue_type(0.)));
+}
+
+template <class Matrix, class SymmGroup>
+void OPTable<Matrix, SymmGroup>::index_(shard & s, std::size_t hash, tag_type tag)
+{
+    std::vector<tag_type> & bucket = s.tags[hash];
+    bucket.insert(std::lower_bound(bucket.begin(), bucket.end(), tag), tag);
+}
+
+template <class Matrix, class SymmGroup>
+typename OPTable<Matrix, SymmGroup>::tag_type
+OPTable<Matrix, SymmGroup>::append_(op_t const & op_)
+{
+    op_t op = op_;
+    op.update_sparse();
+    return operators.push_back(op);
 }
 
 #endif
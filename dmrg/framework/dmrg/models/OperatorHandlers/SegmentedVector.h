@@ -0,0 +1,117 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef SEGMENTED_VECTOR_H
+#define SEGMENTED_VECTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+
+/**
+ * @brief Vector which can grow while other threads access its elements.
+ *
+ * The elements are stored in segments of geometrically increasing size which are never moved.
+ * References to the elements therefore stay valid, and the elements can be read without locking
+ * while another thread appends new ones. Appending is serialized by a mutex.
+ * An element can be accessed by any thread which obtained its index after it was appended.
+ *
+ * Copying and assigning are not thread-safe.
+ */
+template <class T>
+class SegmentedVector
+{
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    SegmentedVector() : size_(0)
+    {
+        for (size_type s = 0; s < num_segments; ++s)
+            segments_[s].store(nullptr, std::memory_order_relaxed);
+    }
+
+    SegmentedVector(SegmentedVector const & rhs) : SegmentedVector()
+    {
+        for (size_type i = 0; i < rhs.size(); ++i)
+            push_back(rhs[i]);
+    }
+
+    SegmentedVector & operator=(SegmentedVector const & rhs)
+    {
+        if (this != &rhs) {
+            clear();
+            for (size_type i = 0; i < rhs.size(); ++i)
+                push_back(rhs[i]);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() { clear(); }
+
+    size_type size() const { return size_.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    T & operator[](size_type i)
+    {
+        size_type s = segment(i);
+        return segments_[s].load(std::memory_order_acquire)[i - segment_begin(s)];
+    }
+
+    T const & operator[](size_type i) const
+    {
+        size_type s = segment(i);
+        return segments_[s].load(std::memory_order_acquire)[i - segment_begin(s)];
+    }
+
+    /** @brief Appends an element and returns its index */
+    size_type push_back(T const & value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_type i = size_.load(std::memory_order_relaxed);
+        size_type s = segment(i);
+        if (s >= num_segments)
+            throw std::length_error("SegmentedVector: maximum size exceeded");
+        T * data = segments_[s].load(std::memory_order_relaxed);
+        if (data == nullptr) {
+            data = new T[segment_begin(s+1) - segment_begin(s)];
+            segments_[s].store(data, std::memory_order_release);
+        }
+        data[i - segment_begin(s)] = value;
+        size_.store(i+1, std::memory_order_release);
+        return i;
+    }
+
+    void clear()
+    {
+        for (size_type s = 0; s < num_segments; ++s)
+            delete[] segments_[s].exchange(nullptr, std::memory_order_relaxed);
+        size_.store(0, std::memory_order_release);
+    }
+
+private:
+    // Segment s holds the elements [first_segment * (2^s - 1), first_segment * (2^(s+1) - 1))
+    static const size_type first_segment = 16;
+    static const size_type num_segments = 32;
+
+    static size_type segment(size_type i)
+    {
+        size_type q = i / first_segment + 1, s = 0;
+        while (q >>= 1)
+            ++s;
+        return s;
+    }
+
+    static size_type segment_begin(size_type s) { return first_segment * ((size_type(1) << s) - 1); }
+
+    std::atomic<T *> segments_[num_segments];
+    std::atomic<size_type> size_;
+    std::mutex mutex_;
+};
+
+#endif
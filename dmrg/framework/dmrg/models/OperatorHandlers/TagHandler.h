@@ -10,16 +10,32 @@
 
 #include <vector>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <stdexcept>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/functional/hash.hpp>
 #include "dmrg/block_matrix/block_matrix.h"
 #include "dmrg/block_matrix/block_matrix_algorithms.h"
 #include "dmrg/block_matrix/site_operator.h"
 #include "dmrg/block_matrix/site_operator_algorithms.h"
 #include "dmrg/models/tag_detail.h"
+#include "dmrg/models/OperatorHandlers/OpTable.h"
+#include "dmrg/models/OperatorHandlers/SegmentedVector.h"
 
+/**
+ * @brief Operator table with the fermionic kind, the hermitian conjugates and the products of the operators.
+ *
+ * A TagHandler can be shared by several threads, e.g. by the MPO generation in the measurements,
+ * without copying it: the operators and the products can be queried and registered concurrently.
+ * The products are cached in shards which are locked independently, so that the threads only
+ * wait for each other when they query products of the same shard.
+ * Registering a new operator is serialized, and the operator is compared only with the registered
+ * operators of the same content hash (see OPTable).
+ * Only [hermitian_pair] and the modifications of the operators through [get_op] are not thread-safe.
+ */
 template <class Matrix, class SymmGroup>
 class TagHandler
 {
@@ -32,6 +48,7 @@ protected:
     typedef std::pair<tag_type, tag_type> tag_pair_t;
     typedef std::map<tag_pair_t, std::pair<tag_type, value_type>, compare_pair<tag_pair_t> > pair_map_t;
     typedef typename pair_map_t::const_iterator pair_map_it_t;
+    typedef std::unordered_map<tag_pair_t, std::pair<tag_type, value_type>, boost::hash<tag_pair_t> > product_map_t;
 
 public:
     // constructors
@@ -57,12 +74,12 @@ public:
     typename OPTable<Matrix, SymmGroup>::value_type const & get_op(tag_type i) const;
     std::vector<typename OPTable<Matrix, SymmGroup>::value_type> get_ops(std::vector<tag_type> const & i) const;
 
-    // compute products (WARNING: not thread safe!)
+    // compute products
     std::pair<tag_type, value_type> get_product_tag(const tag_type t1, const tag_type t2);
     std::pair<std::vector<tag_type>, std::vector<value_type> > get_product_tags(const std::vector<tag_type> & t1, const std::vector<tag_type> & t2);
 
     // Diagnostics
-    tag_type prod_duplicates() const { return duplicates_(product_tags); }
+    tag_type prod_duplicates() const;
     tag_type get_num_products() const;
     tag_type total_size() const { return operator_table->size(); }
     bool product_is_null(const tag_type t1, const tag_type t2);
@@ -70,12 +87,18 @@ public:
 private:
     std::shared_ptr<OPTable<Matrix, SymmGroup> > operator_table;
 
-    template <class Map> tag_type duplicates_(Map const & sample);
-
-    std::vector<tag_detail::operator_kind> sign_table;
-    pair_map_t product_tags;
-
-    std::vector<tag_type> hermitian;
+    // Serializes the registration of new operators, so that the tables below stay aligned with operator_table
+    std::mutex registration_mutex;
+    SegmentedVector<tag_detail::operator_kind> sign_table;
+    SegmentedVector<tag_type> hermitian;
+
+    struct product_shard
+    {
+        mutable std::mutex mutex;
+        product_map_t products;
+    };
+    static const std::size_t num_product_shards = 16;
+    product_shard product_tags[num_product_shards];
 };
 
 #include "TagHandler.hpp"
@@ -12,9 +12,13 @@ template <class Matrix, class SymmGroup>
 TagHandler<Matrix, SymmGroup>::TagHandler(TagHandler const & rhs)
     : operator_table(new OPTable<Matrix, SymmGroup>(*rhs.operator_table))
     , sign_table(rhs.sign_table)
-    , product_tags(rhs.product_tags)
     , hermitian(rhs.hermitian)
-{}
+{
+    for (std::size_t s = 0; s < num_product_shards; ++s) {
+        std::lock_guard<std::mutex> lock(rhs.product_tags[s].mutex);
+        product_tags[s].products = rhs.product_tags[s].products;
+    }
+}
 
 // simple const query
 template <class Matrix, class SymmGroup>
@@ -49,6 +53,7 @@ template <class Matrix, class SymmGroup>
 typename OPTable<Matrix, SymmGroup>::tag_type TagHandler<Matrix, SymmGroup>::
 register_op(const op_t & op_, tag_detail::operator_kind kind)
 {
+    std::lock_guard<std::mutex> lock(registration_mutex);
     sign_table.push_back(kind);
     tag_type ret = operator_table->register_op(op_);
     hermitian.push_back(ret);
@@ -69,6 +74,7 @@ std::pair<typename OPTable<Matrix, SymmGroup>::tag_type,
           typename TagHandler<Matrix,SymmGroup>::value_type> TagHandler<Matrix, SymmGroup>::
 checked_register(typename OPTable<Matrix, SymmGroup>::op_t const& sample, tag_detail::operator_kind kind)
 {
+    std::lock_guard<std::mutex> lock(registration_mutex);
     std::pair<tag_type, value_type> ret = operator_table->checked_register(sample);
     if (sign_table.size() < operator_table->size())
     {
@@ -134,41 +140,37 @@ get_product_tag(const typename OPTable<Matrix, SymmGroup>::tag_type t1,
                 const typename OPTable<Matrix, SymmGroup>::tag_type t2)
 {
     assert( t1 < operator_table->size() && t2 < operator_table->size() );
-    assert( operator_table->size() == sign_table.size());
 
     // return tag of product, if already there
-    try {
-#if defined(__xlC__) || defined(__FCC_VERSION)
-        if (product_tags.count(std::make_pair(t1, t2)) == 0)
-            throw std::out_of_range("");
-
-        return product_tags[std::make_pair(t1, t2)];
-#else
-        return product_tags.at(std::make_pair(t1, t2));
-#endif
+    tag_pair_t key(t1, t2);
+    product_shard & shard = product_tags[boost::hash<tag_pair_t>()(key) % num_product_shards];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        typename product_map_t::const_iterator match = shard.products.find(key);
+        if (match != shard.products.end())
+            return match->second;
     }
 
-    // compute and register the product, then return the new tag
-    catch(const std::out_of_range& e) {
+    // compute and register the product, then return the new tag.
+    // The shard is not locked meanwhile: if several threads compute the same product,
+    // checked_register returns the same tag to all of them.
+    op_t product;
+    op_t const & op1 = (*operator_table)[t1];
+    op_t const & op2 = (*operator_table)[t2];
 
-        op_t product;
-        op_t& op1 = (*operator_table)[t1];
-        op_t& op2 = (*operator_table)[t2];
+    gemm(op1, op2, product);
+    tag_detail::operator_kind prod_kind = tag_detail::bosonic;
+    if (sign_table[t1] != sign_table[t2])
+        prod_kind = tag_detail::fermionic;
 
-        gemm(op1, op2, product);
-        tag_detail::operator_kind prod_kind = tag_detail::bosonic;
-        if (sign_table[t1] != sign_table[t2])
-            prod_kind = tag_detail::fermionic;
+    // set the product spin descriptor
+    product.spin() = couple(op2.spin(), op1.spin());
 
-        // set the product spin descriptor
-        product.spin() = couple(get_op(t2).spin(), get_op(t1).spin());
+    std::pair<tag_type, value_type> ret = this->checked_register(product, prod_kind);
+    assert( ret.first < operator_table->size() );
 
-        std::pair<tag_type, value_type> ret = this->checked_register(product, prod_kind);
-        product_tags[std::make_pair(t1, t2)] = ret;
-        assert( operator_table->size() == sign_table.size());
-        assert( ret.first < operator_table->size() );
-        return ret;
-    }
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.products.insert(std::make_pair(key, ret)).first->second;
 }
 
 template <class Matrix, class SymmGroup>
@@ -190,35 +192,41 @@ get_product_tags(std::vector<typename OPTable<Matrix, SymmGroup>::tag_type> cons
 
 // * Diagnostics *************************************
 template <class Matrix, class SymmGroup>
-template <class Map>
-typename OPTable<Matrix, SymmGroup>::tag_type TagHandler<Matrix, SymmGroup>::
-duplicates_(Map const & sample)
+typename OPTable<Matrix, SymmGroup>::tag_type TagHandler<Matrix, SymmGroup>::prod_duplicates() const
 {
-    typedef typename Map::const_iterator it_t;
-
-    std::vector<tag_type> unique_ops;
-    for (it_t it_s = sample.begin(); it_s != sample.end(); ++it_s)
-    {
-        bool unique = true;
-        for (typename std::vector<tag_type>::iterator it_unique = unique_ops.begin(); it_unique != unique_ops.end(); ++it_unique)
-            if (equal((*operator_table)[(*it_s).second.first], (*operator_table)[*it_unique]).first)
-            {
-                unique = false;
-                break;
+    // The products are grouped by the hash of their operator, only the operators of a group are compared
+    std::unordered_map<std::size_t, std::vector<tag_type> > unique_ops;
+    tag_type num_products = 0, num_unique = 0;
+    for (std::size_t s = 0; s < num_product_shards; ++s) {
+        std::lock_guard<std::mutex> lock(product_tags[s].mutex);
+        for (auto const & product : product_tags[s].products) {
+            op_t const & op = (*operator_table)[product.second.first];
+            std::vector<tag_type> & group = unique_ops[tag_detail::scale_invariant_hash(op)];
+            bool unique = true;
+            for (tag_type tag : group)
+                if (tag_detail::equal((*operator_table)[tag], op).first) {
+                    unique = false;
+                    break;
+                }
+            if (unique) {
+                group.push_back(product.second.first);
+                ++num_unique;
             }
-
-        if (unique)
-            unique_ops.push_back((*it_s).second.first);
+            ++num_products;
+        }
     }
 
-    return sample.size() - unique_ops.size();
+    return num_products - num_unique;
 }
 
 template <class Matrix, class SymmGroup>
 typename OPTable<Matrix, SymmGroup>::tag_type TagHandler<Matrix, SymmGroup>::get_num_products() const {
     std::set<tag_type> utags;
-    for (pair_map_it_t it = product_tags.begin(); it != product_tags.end(); ++it)
-        utags.insert(it->second.first);
+    for (std::size_t s = 0; s < num_product_shards; ++s) {
+        std::lock_guard<std::mutex> lock(product_tags[s].mutex);
+        for (auto const & product : product_tags[s].products)
+            utags.insert(product.second.first);
+    }
 
     return utags.size();
 }
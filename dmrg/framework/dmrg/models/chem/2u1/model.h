@@ -477,8 +477,11 @@ public:
                         assert(p < parms["L"]);
 
                 }
-                meas.push_back( new measurements::TaggedNRankRDM<Matrix, SymmGroup>(name, lat, tag_handler, ident, fill, synchronous_meas_operators,
-                                                                                    half_only, positions, bra_ckp));
+                auto rdm = new measurements::TaggedNRankRDM<Matrix, SymmGroup>(name, lat, tag_handler, ident, fill, synchronous_meas_operators,
+                                                                               half_only, positions, bra_ckp);
+                if (parms.is_set("MEASURE_PARTITION[count]"))
+                    rdm->set_partition(parms["MEASURE_PARTITION[index]"], parms["MEASURE_PARTITION[count]"]);
+                meas.push_back(rdm);
             }
 
             else if (std::regex_match(lhs, what, expression_fourptdm)) {
@@ -727,8 +730,11 @@ public:
                     for (auto&& p: positions)
                         assert(p < parms["L"]);
                 }
-                meas.push_back( new measurements::TaggedNRankRDM<Matrix, SymmGroup>(name, lat, tag_handler, ident, fill, synchronous_meas_operators,
-                                                                                    half_only, positions, bra_ckp));
+                auto rdm = new measurements::TaggedNRankRDM<Matrix, SymmGroup>(name, lat, tag_handler, ident, fill, synchronous_meas_operators,
+                                                                               half_only, positions, bra_ckp);
+                if (parms.is_set("MEASURE_PARTITION[count]"))
+                    rdm->set_partition(parms["MEASURE_PARTITION[index]"], parms["MEASURE_PARTITION[count]"]);
+                meas.push_back(rdm);
             }
 
             else if (std::regex_match(lhs, what, expression_oneptdm_uu) ||
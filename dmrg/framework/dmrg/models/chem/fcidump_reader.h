@@ -0,0 +1,309 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef QC_CHEM_FCIDUMP_READER_H
+#define QC_CHEM_FCIDUMP_READER_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dmrg/utils/content_hash.h"
+#include "dmrg/utils/parallel/loops.hpp"
+
+namespace chem {
+namespace detail {
+namespace fcidump {
+
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     *
+     * Empty files are not mapped, and data() is then a null pointer.
+     */
+    class mapped_file
+    {
+    public:
+        explicit mapped_file(std::string const & fp) : fd_(-1), size_(0), data_(nullptr)
+        {
+            fd_ = ::open(fp.c_str(), O_RDONLY);
+            if (fd_ < 0)
+                throw std::runtime_error("Cannot open " + fp);
+            struct stat st;
+            if (::fstat(fd_, &st) != 0) {
+                ::close(fd_);
+                throw std::runtime_error("Cannot stat " + fp);
+            }
+            size_ = st.st_size;
+            if (size_ > 0) {
+                void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+                if (ptr == MAP_FAILED) {
+                    ::close(fd_);
+                    throw std::runtime_error("Cannot map " + fp);
+                }
+                data_ = static_cast<char const *>(ptr);
+                ::madvise(const_cast<char*>(data_), size_, MADV_WILLNEED);
+            }
+        }
+
+        ~mapped_file()
+        {
+            if (data_)
+                ::munmap(const_cast<char*>(data_), size_);
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        mapped_file(mapped_file const &) = delete;
+        mapped_file & operator=(mapped_file const &) = delete;
+
+        char const * data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+    private:
+        int fd_;
+        std::size_t size_;
+        char const * data_;
+    };
+
+    // Size of the independent pieces of text which are parsed concurrently
+    static const std::size_t chunk_size = 1 << 20;
+
+    /** @brief Position after the first [nlines] lines of [data, end) */
+    inline char const * skip_lines(char const * data, char const * end, int nlines)
+    {
+        for (int i = 0; i < nlines && data < end; ++i) {
+            char const * eol = static_cast<char const *>(std::memchr(data, '\n', end - data));
+            data = eol ? eol + 1 : end;
+        }
+        return data;
+    }
+
+    inline bool is_space(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    /**
+     * @brief Tokenizer over a (not null-terminated) piece of text.
+     *
+     * The tokens are copied to a small buffer before the conversion, because the mapped text
+     * does not need to be terminated and strtod/strtol could otherwise read past its end.
+     */
+    class tokenizer
+    {
+    public:
+        tokenizer(char const * begin, char const * end) : pos_(begin), end_(end) { }
+
+        /** @brief Reads the next token into [buf], returns false at the end of the text */
+        bool next(char (&buf)[64])
+        {
+            while (pos_ < end_ && is_space(*pos_))
+                ++pos_;
+            if (pos_ == end_)
+                return false;
+            std::size_t n = 0;
+            while (pos_ < end_ && !is_space(*pos_)) {
+                if (n == sizeof(buf) - 1)
+                    throw std::runtime_error("error parsing integrals");
+                buf[n++] = *pos_++;
+            }
+            buf[n] = '\0';
+            return true;
+        }
+
+        bool read(double & v)
+        {
+            char buf[64], * last;
+            if (!next(buf))
+                return false;
+            v = std::strtod(buf, &last);
+            if (*last != '\0')
+                throw std::runtime_error("error parsing integrals");
+            return true;
+        }
+
+        bool read(std::complex<double> & v)
+        {
+            double real, imag;
+            if (!read(real))
+                return false;
+            if (!read(imag))
+                throw std::runtime_error("error parsing integrals");
+            v = { real, imag };
+            return true;
+        }
+
+        void read_index(int & i)
+        {
+            char buf[64], * last;
+            if (!next(buf))
+                throw std::runtime_error("error parsing integrals");
+            i = static_cast<int>(std::strtol(buf, &last, 10));
+            if (*last != '\0')
+                throw std::runtime_error("error parsing integrals");
+        }
+
+    private:
+        char const * pos_;
+        char const * end_;
+    };
+
+    /**
+     * @brief Parses the lines "value i j k l" of an FCIDUMP body.
+     *
+     * The text is split in chunks at line boundaries which are parsed in parallel, and the
+     * results are concatenated in the order of the text. Integrals with an absolute value
+     * below or equal to [cutoff] are skipped, and the (1-based) indices of the others are
+     * converted by [convert] into the stored index tuple.
+     */
+    template <class T, class Convert>
+    void parse(char const * begin, char const * end, double cutoff, Convert convert,
+               std::vector<std::array<int, 4> > & indices, std::vector<T> & values)
+    {
+        // Chunk boundaries, moved forward to the next line break
+        std::vector<char const *> bounds(1, begin);
+        std::size_t size = end - begin;
+        for (std::size_t offset = chunk_size; offset < size; offset += chunk_size) {
+            char const * p = std::max(begin + offset, bounds.back());
+            char const * eol = static_cast<char const *>(std::memchr(p, '\n', end - p));
+            if (eol == nullptr)
+                break;
+            bounds.push_back(eol + 1);
+        }
+        bounds.push_back(end);
+        std::size_t nchunks = bounds.size() - 1;
+
+        std::vector<std::vector<std::array<int, 4> > > chunk_indices(nchunks);
+        std::vector<std::vector<T> > chunk_values(nchunks);
+        std::vector<char> failed(nchunks, 0);
+        threaded_for(std::size_t c = 0; c < nchunks; ++c)
+        {
+            try {
+                tokenizer tok(bounds[c], bounds[c+1]);
+                T val;
+                std::array<int, 4> idx;
+                while (tok.read(val)) {
+                    for (int& i : idx)
+                        tok.read_index(i);
+                    if (std::abs(val) > cutoff) {
+                        chunk_values[c].push_back(val);
+                        chunk_indices[c].push_back(convert(idx));
+                    }
+                }
+            }
+            catch (std::exception & e) {
+                failed[c] = 1;
+            }
+        }
+        if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+            throw std::runtime_error("error parsing integrals");
+
+        std::size_t n = 0;
+        for (auto const & v : chunk_values)
+            n += v.size();
+        indices.reserve(indices.size() + n);
+        values.reserve(values.size() + n);
+        for (std::size_t c = 0; c < nchunks; ++c) {
+            indices.insert(indices.end(), chunk_indices[c].begin(), chunk_indices[c].end());
+            values.insert(values.end(), chunk_values[c].begin(), chunk_values[c].end());
+        }
+    }
+
+    /**
+     * @brief Binary cache of parsed and aligned integrals.
+     *
+     * The file holds a fixed header, the index tuples and the values, which are copied
+     * with a single memcpy each out of the mapping. The key identifies the integral source
+     * together with everything which affects the parsed result (orbital order, alignment,
+     * cutoff, value type), so that a cache which does not match is ignored.
+     */
+    struct cache_header
+    {
+        char magic[8];
+        std::uint64_t key;
+        std::uint64_t size;
+        std::uint64_t value_size;
+    };
+
+    static const char cache_magic[8] = { 'Q', 'C', 'M', 'I', 'N', 'T', '0', '1' };
+
+    template <class T>
+    bool load_cache(std::string const & fp, std::uint64_t key,
+                    std::vector<std::array<int, 4> > & indices, std::vector<T> & values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "cached integrals must be trivially copyable");
+        try {
+            mapped_file file(fp);
+            cache_header header;
+            if (file.size() < sizeof(header))
+                return false;
+            std::memcpy(&header, file.data(), sizeof(header));
+            if (std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 || header.key != key
+                || header.value_size != sizeof(T)
+                || file.size() != sizeof(header) + header.size * (sizeof(std::array<int, 4>) + sizeof(T)))
+                return false;
+            indices.resize(header.size);
+            values.resize(header.size);
+            char const * data = file.data() + sizeof(header);
+            std::memcpy(indices.data(), data, header.size * sizeof(std::array<int, 4>));
+            std::memcpy(values.data(), data + header.size * sizeof(std::array<int, 4>), header.size * sizeof(T));
+            return true;
+        }
+        catch (std::exception &) {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Writes the cache, returns false if this is not possible.
+     *
+     * The cache is first written to a temporary file and then renamed, so that concurrent
+     * runs never read a partially written cache.
+     */
+    template <class T>
+    bool write_cache(std::string const & fp, std::uint64_t key,
+                     std::vector<std::array<int, 4> > const & indices, std::vector<T> const & values)
+    {
+        cache_header header;
+        std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+        header.key = key;
+        header.size = values.size();
+        header.value_size = sizeof(T);
+        std::string tmp = fp + ".tmp" + std::to_string(::getpid());
+        std::FILE * f = std::fopen(tmp.c_str(), "wb");
+        if (f == nullptr)
+            return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+                  && std::fwrite(indices.data(), sizeof(std::array<int, 4>), indices.size(), f) == indices.size()
+                  && std::fwrite(values.data(), sizeof(T), values.size(), f) == values.size();
+        ok = (std::fclose(f) == 0) && ok;
+        if (ok)
+            ok = std::rename(tmp.c_str(), fp.c_str()) == 0;
+        if (!ok)
+            std::remove(tmp.c_str());
+        return ok;
+    }
+
+} // namespace fcidump
+} // namespace detail
+} // namespace chem
+
+#endif
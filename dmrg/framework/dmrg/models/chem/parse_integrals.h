@@ -8,35 +8,16 @@
 #ifndef QC_CHEM_PARSE_INTEGRALS_H
 #define QC_CHEM_PARSE_INTEGRALS_H
 
+#include <typeinfo>
 #include "integral_interface.h"
+#include "dmrg/models/chem/fcidump_reader.h"
 
 namespace chem {
 namespace detail {
 
-    namespace parser_detail {
-        // read a value from file, either real or complex, needed for integral parsing
-        // since complex integrals are read as space-separated real and imaginary part,
-        // and operator>> of std::complex doesn't support this
-        // function signature is similar to operator>> to be able to use it in a loop
-
-        // need inline as this will be compiled in multiple objects and cause linker errors otherwise
-        template<class V>
-        inline std::istream& read_value(std::istream& s, V& v)
-        {
-            s >> v;
-            return s;
-        }
-        template<>
-        inline std::istream& read_value<std::complex<double> >(std::istream& s, std::complex<double>& v)
-        {
-            double real, imag;
-            s >> real >> imag;
-            v = { real, imag };
-            return s;
-        }
-    }
-
-    // now the integral parser can both real and complex integrals without specialization
+    // The FCIDUMP text is memory-mapped and parsed in parallel, real and complex integrals alike.
+    // An FCIDUMP file is parsed only once: the aligned integrals are stored in a binary cache
+    // (parameter integral_cache) which is loaded directly by later runs.
     template <class T, class SymmGroup>
     inline
     std::pair<alps::numeric::matrix<Lattice::pos_t>, std::vector<T> >
@@ -82,15 +63,26 @@ namespace detail {
         // ********************************************************************
 
         std::vector<index_type<Hamiltonian::Electronic>> indices;
+        double cutoff = parms["integral_cutoff"];
 
-        // Stream used to load FCIDUMP file/FCIDUMP string
-        std::unique_ptr<std::istream> orb_string;
+        // Conversion of the 1-based FCIDUMP indices to the (aligned) lattice positions
+        auto convert = [&](index_type<Hamiltonian::Electronic> const & idx) -> index_type<Hamiltonian::Electronic>
+        {
+            if (do_align)
+            {
+                IndexTuple aligned = align<SymmGroup>(reorderer()(idx[0]-1, inv_order), reorderer()(idx[1]-1, inv_order),
+                                                      reorderer()(idx[2]-1, inv_order), reorderer()(idx[3]-1, inv_order));
+                return { aligned[0], aligned[1], aligned[2], aligned[3] };
+            }
+            else
+                return { idx[0]-1, idx[1]-1, idx[2]-1, idx[3]-1 };
+        };
 
         if (parms.is_set("integrals")) // FCIDUMP integrals in a string
         {
             // if we provide parameters inline, we expect it to be in FCIDUMP format without the header
             std::string integrals = parms["integrals"];
-            orb_string = std::unique_ptr<std::istringstream>(new std::istringstream(integrals));
+            fcidump::parse<T>(integrals.data(), integrals.data() + integrals.size(), cutoff, convert, indices, matrix_elements);
         }
         else if (parms.is_set("integral_file")) // FCIDUMP file
         {
@@ -98,12 +90,31 @@ namespace detail {
             if (!boost::filesystem::exists(integral_file))
                 throw std::runtime_error("integral_file " + integral_file + " does not exist\n");
 
-            orb_string = std::unique_ptr<std::ifstream>(new std::ifstream(integral_file.c_str()));
+            fcidump::mapped_file file(integral_file);
+            char const * end = file.data() + file.size();
 
-            // ignore the FCIDUMP file header -- 1st four lines
-            for (int i = 0; i < 4; ++i)
-                orb_string.get()->ignore(std::numeric_limits<std::streamsize>::max(),'\n');
+            // The binary cache is valid for the same file content, parsed with the same settings
+            std::string cache_file = parms["integral_cache"];
+            if (cache_file == "auto")
+                cache_file = integral_file + ".cache";
+            std::uint64_t key = 0;
+            if (cache_file != "none")
+            {
+                key = maquis::detail::content_hash(file.data(), file.size());
+                for (pos_t p : order)
+                    key = maquis::detail::hash_combine(key, p);
+                key = maquis::detail::hash_combine(key, maquis::detail::fnv1a(typeid(SymmGroup).name()));
+                key = maquis::detail::hash_combine(key, maquis::detail::fnv1a(reinterpret_cast<char const *>(&cutoff), sizeof(cutoff)));
+                key = maquis::detail::hash_combine(key, do_align);
+            }
 
+            if (cache_file == "none" || !fcidump::load_cache(cache_file, key, indices, matrix_elements))
+            {
+                // ignore the FCIDUMP file header -- 1st four lines
+                fcidump::parse<T>(fcidump::skip_lines(file.data(), end, 4), end, cutoff, convert, indices, matrix_elements);
+                if (cache_file != "none" && !fcidump::write_cache(cache_file, key, indices, matrix_elements))
+                    std::cout << "Could not write the integral cache " << cache_file << std::endl;
+            }
         }
         else if (parms.is_set("integrals_binary")) // Serialized integral object
         {
@@ -117,62 +128,16 @@ namespace detail {
 
             for (auto&& t: ints)
             {
-                if (std::abs(t.second) > parms["integral_cutoff"])
+                if (std::abs(t.second) > cutoff)
                 {
                     matrix_elements.push_back(t.second);
-                    if (do_align)
-                    {
-                        IndexTuple aligned = align<SymmGroup>(reorderer()(t.first[0]-1, inv_order), reorderer()(t.first[1]-1, inv_order),
-                                                reorderer()(t.first[2]-1, inv_order), reorderer()(t.first[3]-1, inv_order));
-                        indices.push_back({ aligned[0], aligned[1], aligned[2], aligned[3] });
-                    }
-                    else
-                        indices.push_back({ t.first[0]-1, t.first[1]-1, t.first[2]-1, t.first[3]-1 });
+                    indices.push_back(convert(t.first));
                 }
             }
         }
         else
             throw std::runtime_error("Integrals are not defined in the input.");
 
-        if (orb_string)
-        // Read the FCIDUMP file/string and parse it. Only do it if the orb_string pointer is not empty
-        // which is the case exactly when we want to parse the FCIDUMP file (see above, i.e. when
-        // parms["integrals"] or parms["integral_file"] is set.
-        // Otherwise, the pointer is empty,
-        // but parms["integrals_binary"] is set and parsing is already completed, so the below can be skipped.
-        {
-            T val;
-            // use our specialization to read either real or complex value from the file
-            while(parser_detail::read_value<T>(*(orb_string.get()), val))
-            {
-                integral_tuple<T> t;
-                t.second = val;
-                try {
-                    // now read the indices
-                    *(orb_string.get()) >> t.first[0] >> t.first[1] >> t.first[2] >> t.first[3];
-                }
-                catch(std::exception & e)
-                {
-                    std::cerr << e.what() << std::endl;
-                    throw std::runtime_error("error parsing integrals");
-                }
-                // ignore integrals that are below the cutoff threshold
-                if (std::abs(t.second) > parms["integral_cutoff"])
-                {
-                    matrix_elements.push_back(t.second);
-                    if (do_align)
-                    {
-                        IndexTuple aligned = align<SymmGroup>(reorderer()(t.first[0]-1, inv_order), reorderer()(t.first[1]-1, inv_order),
-                                                reorderer()(t.first[2]-1, inv_order), reorderer()(t.first[3]-1, inv_order));
-                        indices.push_back({ aligned[0], aligned[1], aligned[2], aligned[3] });
-                    }
-                    else
-                        indices.push_back({ t.first[0]-1, t.first[1]-1, t.first[2]-1, t.first[3]-1 });
-
-                }
-            }
-        }
-
         // by now we should have parsed all the integrals, but we still have to convert the indices to alps::numeric::matrix<Lattice::pos_t>
         // Leon: I didn't figure out how to safely add a row to alps::matrix using POD and not iterators
         // so I'm using a temporary object to read all the integrals
@@ -12,6 +12,7 @@
 #include "dmrg/models/generate_mpo/tagged_mpo_maker_optim.hpp"
 #include "dmrg/models/generate_mpo/corr_maker.hpp"
 #include "dmrg/models/generate_mpo/1D_mpo_maker.hpp"
+#include "dmrg/mp_tensors/mpo_cache.h"
 
 
 template<class Matrix, class SymmGroup>
@@ -23,4 +24,27 @@ MPO<Matrix, SymmGroup> make_mpo(Lattice const& lat, Model<Matrix, SymmGroup> & m
     return mpo;
 }
 
+/**
+ * @brief Same as above, with the MPO loaded from (or stored in) the [mpo_cache] directory.
+ *
+ * The terms of the model are created in any case, since they are also used outside of the MPO.
+ */
+template<class Matrix, class SymmGroup>
+MPO<Matrix, SymmGroup> make_mpo(Lattice const& lat, Model<Matrix, SymmGroup> & model, BaseParameters & parms)
+{
+    std::string cache_dir = parms["mpo_cache"].str();
+    if (cache_dir.empty())
+        return make_mpo(lat, model);
+    std::string fp = mpo_cache::file_name(cache_dir, "mpo", mpo_cache::hamiltonian_key<SymmGroup>(parms));
+    MPO<Matrix, SymmGroup> mpo;
+    if (mpo_cache::load(fp, mpo)) {
+        model.create_terms();
+        maquis::cout << "MPO loaded from " << fp << std::endl;
+        return mpo;
+    }
+    mpo = make_mpo(lat, model);
+    mpo_cache::save(fp, mpo);
+    return mpo;
+}
+
 #endif
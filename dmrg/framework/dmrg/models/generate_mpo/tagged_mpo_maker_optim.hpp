@@ -643,11 +643,12 @@ private:
         std::pair<prempo_key_type,prempo_key_type> kk = make_pair(trivial_left,trivial_right);
         for (typename std::map<pos_t, op_t>::const_iterator it = site_terms.begin();
              it != site_terms.end(); ++it) {
-            tag_type site_tag = tag_handler->register_op(it->second, tag_detail::bosonic);
+            // Site terms equal (up to a scale) to a registered operator reuse its tag
+            std::pair<tag_type, scale_type> site_tag = tag_handler->checked_register(it->second, tag_detail::bosonic);
             //std::pair<typename prempo_map_type::iterator,bool> ret;
             //ret = prempo[it->first].insert( make_pair( kk, prempo_value_type(site_tag,1.) ) );
             typename prempo_map_type::iterator ret;
-            ret = prempo[it->first].insert( make_pair( kk, prempo_value_type(site_tag, 1.) ) );
+            ret = prempo[it->first].insert( make_pair( kk, prempo_value_type(site_tag.first, site_tag.second) ) );
             if (prempo[it->first].count(ret->first) != 1)
                 throw std::runtime_error("another site term already existing!");
         }
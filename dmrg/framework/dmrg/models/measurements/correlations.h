@@ -166,6 +166,10 @@ namespace measurements {
         {
             typedef std::shared_ptr<generate_mpo::CorrMakerBase<Matrix, SymmGroup> > maker_ptr;
 
+            /// The MPOs of all first sites share the identity string up to their first operator,
+            /// and are therefore evaluated together by the batched multi_expval
+            std::vector<maker_ptr> makers;
+            std::vector<MPO<Matrix, SymmGroup> > mpos;
             for (std::vector<pos_t>::const_iterator it = positions_first.begin(); it != positions_first.end(); ++it) {
                 if (*it >= lattice.size()-(ops.size()-1))
                     throw std::runtime_error("cannot measure correlation with first operator at p="+boost::lexical_cast<std::string>(*it)+".");
@@ -177,19 +181,26 @@ namespace measurements {
                 maker_ptr dcorr;
                 if (is_nn) dcorr.reset(new generate_mpo::CorrMakerNN<Matrix, SymmGroup>(lattice, identities, fillings, ops, *it) );
                 else       dcorr.reset(new generate_mpo::CorrMaker<Matrix, SymmGroup>(lattice, identities, fillings, ops, *it) );
+                mpos.push_back(dcorr->create_mpo());
+                makers.push_back(dcorr);
+            }
 
-                /// measure
-                MPO<Matrix, SymmGroup> mpo = dcorr->create_mpo();
-                std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
-                if (!this->is_super_meas)
-                    dct = multi_expval(mps, mpo);
-                else {
-                    typename MPS<Matrix, SymmGroup>::scalar_type nn = dm_trace(mps, this->phys_psi);
-                    MPS<Matrix, SymmGroup> super_mpo = mpo_to_smps(mpo, this->phys_psi);
-                    dct = multi_overlap(super_mpo, mps);
-                    for (int i=0; i<dct.size(); ++i)
-                        dct[i] /= nn;
+            /// measure
+            std::vector<std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> > values;
+            if (!this->is_super_meas)
+                values = multi_expval(mps, mpos);
+            else {
+                typename MPS<Matrix, SymmGroup>::scalar_type nn = dm_trace(mps, this->phys_psi);
+                for (std::size_t k = 0; k < mpos.size(); ++k) {
+                    MPS<Matrix, SymmGroup> super_mpo = mpo_to_smps(mpos[k], this->phys_psi);
+                    values.push_back(multi_overlap(super_mpo, mps));
+                    for (int i=0; i<values.back().size(); ++i)
+                        values.back()[i] /= nn;
                 }
+            }
+
+            for (std::size_t k = 0; k < mpos.size(); ++k) {
+                std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> const & dct = values[k];
 
                 /// save results and labels
                 this->vector_results.reserve(this->vector_results.size() + dct.size());
@@ -198,7 +209,7 @@ namespace measurements {
 
                 std::copy(dct.begin(), dct.end(), std::back_inserter(this->vector_results));
 
-                std::vector<std::vector<pos_t> > num_labels = (order.size() > 0) ? detail::resort_labels(dcorr->numeric_labels(), order, is_nn) : dcorr->numeric_labels();
+                std::vector<std::vector<pos_t> > num_labels = (order.size() > 0) ? detail::resort_labels(makers[k]->numeric_labels(), order, is_nn) : makers[k]->numeric_labels();
 
                 std::copy(num_labels.begin(), num_labels.end(), std::back_inserter(this->labels_num));
 
@@ -110,6 +110,10 @@ namespace measurements {
                 nn = dm_trace(mps, this->phys_psi);
 
             /// collect results from all mpo terms, i.e. all requested combinations of operators.
+            /// Without super-MPS, the MPOs of all sites / bonds are evaluated together by the batched
+            /// multi_expval, which shares the identity strings around the operators.
+            std::vector<std::string> batch_labels;
+            std::vector<MPO<Matrix, SymmGroup> > batch;
             for (typename std::vector<bond_element>::const_iterator it = mpo_terms.begin(); it != mpo_terms.end(); ++it) {
                 typedef std::map<std::string, MPO<Matrix, SymmGroup> > mpo_map;
                 mpo_map mpos = meas_prepare::local<Matrix, SymmGroup>(lattice, identities, fillings, *it);
@@ -121,7 +125,8 @@ namespace measurements {
                         boost::tie(match, boost::tuples::ignore) = res.insert( std::make_pair(mit->first, 0.) );
 
                     if (!this->is_super_meas) {
-                        match->second += (this->cast_to_real) ? maquis::real(expval(mps, mit->second)) : expval(mps, mit->second);
+                        batch_labels.push_back(mit->first);
+                        batch.push_back(mit->second);
                     } else {
                         MPS<Matrix, SymmGroup> super_mpo = mpo_to_smps(mit->second, this->phys_psi);
                         // static_cast needed for icpc 12.x
@@ -131,6 +136,11 @@ namespace measurements {
                     }
                 }
             }
+            if (!batch.empty()) {
+                std::vector<std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> > values = multi_expval(mps, batch);
+                for (std::size_t i = 0; i < batch.size(); ++i)
+                    res[batch_labels[i]] += (this->cast_to_real) ? maquis::real(values[i][0]) : values[i][0];
+            }
 
             /// copy results to base
             this->vector_results.reserve(this->vector_results.size() + res.size());
@@ -366,5 +366,47 @@ namespace measurements_details {
         return iterate_rdm_indices<nrdm_iterator<I>, N>()(nrdm_iterator<I>(), L, bra_neq_ket, positions_first);
     }
 
+
+    // Evaluation order of the n-RDM elements [indices] in which the elements whose operators act on the
+    // same leftmost sites follow each other, so that the window prefixes cached in ExpvalBoundaryCache
+    // are reused. The elements are sorted lexicographically by their (position, operator index) pairs,
+    // ordered by position.
+    template<class I>
+    std::vector<std::size_t> prefix_order(std::vector<std::vector<I> > const & indices)
+    {
+        std::vector<std::vector<std::pair<I, std::size_t> > > keys(indices.size());
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            for (std::size_t op = 0; op < indices[i].size(); ++op)
+                keys[i].push_back(std::make_pair(indices[i][op], op));
+            std::sort(keys[i].begin(), keys[i].end());
+        }
+        std::vector<std::size_t> order(indices.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&keys](std::size_t a, std::size_t b) { return keys[a] < keys[b]; });
+        return order;
+    }
+
+    // Part [part] of [nparts] of the evaluation order [order], for the distribution of the n-RDM elements among
+    // independent processes. The parts are contiguous in [order], so that each process generates the environments
+    // of a range of leftmost sites, and have the same cost, estimated by the number of sites spanned by the operators.
+    template<class I>
+    std::vector<std::size_t> partition_order(std::vector<std::size_t> const & order, std::vector<std::vector<I> > const & indices,
+                                             std::size_t part, std::size_t nparts)
+    {
+        if (part >= nparts)
+            throw std::runtime_error("RDM partition index " + std::to_string(part) + " out of range, the number of partitions is "
+                                     + std::to_string(nparts));
+        std::vector<double> cost(order.size()+1, 0.);
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            auto span = std::minmax_element(indices[order[i]].begin(), indices[order[i]].end());
+            cost[i+1] = cost[i] + (*span.second - *span.first + 1);
+        }
+        auto bound = [&cost, nparts](std::size_t k) {
+            return std::lower_bound(cost.begin(), cost.end(), cost.back() * k / nparts) - cost.begin();
+        };
+        std::size_t begin = (part == 0) ? 0 : bound(part), end = (part+1 == nparts) ? order.size() : bound(part+1);
+        return std::vector<std::size_t>(order.begin() + begin, order.begin() + end);
+    }
+
 }
 #endif
\ No newline at end of file
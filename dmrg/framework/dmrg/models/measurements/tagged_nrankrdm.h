@@ -17,6 +17,7 @@
 #include "dmrg/utils/checks.h"
 #include "dmrg/models/chem/su2u1/term_maker.h"
 #include "dmrg/models/chem/transform_symmetry.hpp"
+#include "dmrg/mp_tensors/expval_boundary_cache.h"
 #include "measurements_details.h"
 
 // Symmetry-specific implementations
@@ -101,6 +101,18 @@ public:
                                   + boost::lexical_cast<std::string>(operator_terms[0].first.size()));
   }
 
+  /**
+   * @brief Restricts the 3- and 4-RDM measurements to a part of the elements.
+   *
+   * The elements (of the slice, if any) are divided in [count] parts of equal cost, and only
+   * the part [index] is evaluated, so that the parts can be evaluated by independent processes.
+   */
+  void set_partition(std::size_t index, std::size_t count)
+  {
+      partition_index = index;
+      partition_count = count;
+  }
+
 protected:
 
   /** @brief Cloning method */
@@ -112,15 +124,13 @@ protected:
   {
     // Test if a separate bra state has been specified
     bool bra_neq_ket = (dummy_bra_mps.length() > 0);
-    //MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> ket_mps_local = ket_mps;
+    // The cache stores its own copy of the MPSs, each thread works on a separate copy
+    ExpvalBoundaryCache<Matrix, SymmGroup> cache((bra_neq_ket) ? dummy_bra_mps : ket_mps, ket_mps);
     #ifdef MAQUIS_OPENMP
-    #pragma omp parallel for schedule(dynamic) firstprivate(ket_mps_local, bra_mps)
+    #pragma omp parallel for schedule(dynamic) firstprivate(cache)
     #endif
     for (std::size_t i = 0; i < positions_first.size(); ++i) {
       pos_t p1 = positions_first[i];
-      std::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
       std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
       std::vector<std::vector<pos_t> > num_labels;
       for (pos_t p2 = bra_neq_ket ? 0 : p1; p2 < lattice.size(); ++p2)
@@ -133,11 +143,11 @@ protected:
             operators[0] = operator_terms[synop].first[0][lattice.get_prop<typename SymmGroup::subcharge>("type", p1)];
             operators[1] = operator_terms[synop].first[1][lattice.get_prop<typename SymmGroup::subcharge>("type", p2)];
             // check if term is allowed by symmetry
-            term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler_local);
-            if(measurements_details::checkpg<SymmGroup>()(term, tag_handler_local, lattice))
+            term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler);
+            if(measurements_details::checkpg<SymmGroup>()(term, tag_handler, lattice))
             {
-                MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler_local, lattice);
-                value += operator_terms[synop].second * expval(bra_mps, ket_mps_local, mpo);
+                MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler, lattice);
+                value += operator_terms[synop].second * cache.expval(mpo, std::min(p1, p2), std::max(p1, p2));
             }
         }
         dct.push_back(value);
@@ -166,32 +176,44 @@ protected:
   {
       // Test if a separate bra state has been specified bool bra_neq_ket = (dummy_bra_mps.length() > 0);
       bool bra_neq_ket = (dummy_bra_mps.length() > 0);
-      //MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-      MPS<Matrix, SymmGroup> bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-      MPS<Matrix, SymmGroup> ket_mps_local = ket_mps;
+      ExpvalBoundaryCache<Matrix, SymmGroup> cache((bra_neq_ket) ? dummy_bra_mps : ket_mps, ket_mps);
       // Obtain the total number of RDM elements and the list of all indices (eventually for a given slice)
       auto indices = measurements_details::iterate_nrdm<N>(lattice.size(), bra_neq_ket, positions_first);
       maquis::cout << "Number of total " << N << "-RDM elements measured: " << indices.size() << std::endl;
+      // Elements sharing their leftmost operators are evaluated one after the other, possibly only a part of them
+      std::vector<std::size_t> order = measurements_details::prefix_order(indices);
+      if (partition_count > 1) {
+          order = measurements_details::partition_order(order, indices, partition_index, partition_count);
+          maquis::cout << "Elements evaluated in part " << partition_index << " of " << partition_count << ": " << order.size() << std::endl;
+      }
+      // The results are stored in the order of the indices
+      std::vector<std::size_t> slots(order);
+      std::sort(slots.begin(), slots.end());
       // Prepare result arrays
-      resize_results(indices.size());
-      // Loop over all indices
+      resize_results(order.size());
       #ifdef MAQUIS_OPENMP
-      #pragma omp parallel for schedule(dynamic) firstprivate(bra_mps, ket_mps_local)
+      #pragma omp parallel firstprivate(cache)
       #endif
-      for (int i = 0; i < indices.size(); i++)
       {
-          auto&& positions = indices[i];
-          // Prepare labels
-          auto&& num_labels = order_labels(lattice, positions);
-          std::string lbt = label_string(num_labels);
-          this->labels[i] = lbt;
-          this->labels_num[i] = num_labels;
-          // MPS<Matrix, SymmGroup> ket_mps_local = ket_mps; // enable if you get pairing issues
-          // Make a local copy of tag_handler since it can be modified by the MPO creator
-          std::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
-          // Setup MPO and calculate the expectation value for a given indices set
-          this->vector_results[i] = nrdm_expval(N, bra_mps, ket_mps_local, positions, tag_handler_local);
-      } // iterator loop
+          // The tag handler is shared by all threads, so that the MPOs of all elements refer to the
+          // same operator table and can be compared by the cache.
+          // Loop over all indices, in chunks of consecutive elements
+          #ifdef MAQUIS_OPENMP
+          #pragma omp for schedule(dynamic, 16)
+          #endif
+          for (int j = 0; j < order.size(); j++)
+          {
+              auto&& positions = indices[order[j]];
+              std::size_t i = std::lower_bound(slots.begin(), slots.end(), order[j]) - slots.begin();
+              // Prepare labels
+              auto&& num_labels = order_labels(lattice, positions);
+              std::string lbt = label_string(num_labels);
+              this->labels[i] = lbt;
+              this->labels_num[i] = num_labels;
+              // Setup MPO and calculate the expectation value for a given indices set
+              this->vector_results[i] = nrdm_expval(N, cache, positions);
+          } // iterator loop
+      }
   }
 
 private:
@@ -203,6 +225,7 @@ private:
   std::vector<scaled_bond_term> operator_terms;
   bool half_only;
   std::string bra_ckp;
+  std::size_t partition_index = 0, partition_count = 1;
 
   // Resize labels and results, used before the measurements
   inline void resize_results(int size)
@@ -213,13 +236,15 @@ private:
   }
 
   // Obtain an expectation value for <bra|op|ket> for given n-RDM order and positions
-  inline value_type nrdm_expval(std::size_t n, const MPS<Matrix, SymmGroup> & bra_mps, const MPS<Matrix, SymmGroup> & ket_mps,
-              const std::vector<int> & positions, const std::shared_ptr<TagHandler<Matrix, SymmGroup> > & tag_handler_local)
+  inline value_type nrdm_expval(std::size_t n, ExpvalBoundaryCache<Matrix, SymmGroup> & cache,
+              const std::vector<int> & positions)
   {
       assert(operator_terms.size() > 0);
       auto opsize = operator_terms[0].first.size();
       assert(n*2 == opsize);
       value_type result = 0.;
+      // Only the sites between the first and the last operator are contracted
+      auto span = std::minmax_element(positions.begin(), positions.end());
       // spin combo loop
       for (std::size_t synop = 0; synop < operator_terms.size(); ++synop)
       {
@@ -227,11 +252,11 @@ private:
           for (std::size_t op = 0; op < opsize; op++)
               operators[op] = operator_terms[synop].first[op][lattice.get_prop<typename SymmGroup::subcharge>("type", positions[op])];
           // check if term is allowed by symmetry
-          term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler_local);
-          if(!measurements_details::checkpg<SymmGroup>()(term, tag_handler_local, lattice))
+          term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler);
+          if(!measurements_details::checkpg<SymmGroup>()(term, tag_handler, lattice))
               return 0.;
-          MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler_local, lattice);
-          result += operator_terms[synop].second * expval(bra_mps, ket_mps, mpo);
+          MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler, lattice);
+          result += operator_terms[synop].second * cache.expval(mpo, *span.first, *span.second, synop);
       }
       return result;
   }
@@ -17,6 +17,7 @@
 #include "dmrg/utils/checks.h"
 #include "dmrg/models/chem/su2u1/term_maker.h"
 #include "dmrg/models/chem/transform_symmetry.hpp"
+#include "dmrg/mp_tensors/expval_boundary_cache.h"
 #include "measurements_details.h"
 
 namespace measurements {
@@ -89,16 +90,14 @@ protected:
   {
     // Test if a separate bra state has been specified
     bool bra_neq_ket = (dummy_bra_mps.length() > 0);
-    //MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> ket_mps_local = ket_mps;
+    // The cache stores its own copy of the MPSs, each thread works on a separate copy
+    ExpvalBoundaryCache<Matrix, SymmGroup> cache((bra_neq_ket) ? dummy_bra_mps : ket_mps, ket_mps);
 
     #ifdef MAQUIS_OPENMP
-    #pragma omp parallel for schedule(dynamic) firstprivate(ket_mps_local, bra_mps)
+    #pragma omp parallel for schedule(dynamic) firstprivate(cache)
     #endif
     for (std::size_t i = 0; i < positions_first.size(); ++i) {
       pos_t p1 = positions_first[i];
-      std::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
 
       std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
       std::vector<std::vector<pos_t> > num_labels;
@@ -111,12 +110,12 @@ protected:
         operators[1] = operator_terms[0].first[1][lattice.get_prop<typename SymmGroup::subcharge>("type", p2)];
 
         // check if term is allowed by symmetry
-        term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler_local);
+        term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler);
 
-        //if(measurements_details::checkpg<SymmGroup>()(term, tag_handler_local, lattice))
+        //if(measurements_details::checkpg<SymmGroup>()(term, tag_handler, lattice))
         {
-          MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler_local, lattice);
-          typename MPS<Matrix, SymmGroup>::scalar_type value = operator_terms[0].second * expval(bra_mps, ket_mps_local, mpo);
+          MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler, lattice);
+          typename MPS<Matrix, SymmGroup>::scalar_type value = operator_terms[0].second * cache.expval(mpo, p1, p2);
           dct.push_back(value);
           num_labels.push_back(order_labels(lattice, positions));
         }
@@ -149,17 +148,13 @@ protected:
   {
     // Test if a separate bra state has been specified
     bool bra_neq_ket = (dummy_bra_mps.length() > 0);
-    //MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> ket_mps_local = ket_mps;
+    ExpvalBoundaryCache<Matrix, SymmGroup> cache((bra_neq_ket) ? dummy_bra_mps : ket_mps, ket_mps);
     #ifdef MAQUIS_OPENMP
-    #pragma omp parallel for collapse(1) schedule(dynamic) firstprivate(ket_mps_local, bra_mps)
+    #pragma omp parallel for collapse(1) schedule(dynamic) firstprivate(cache)
     #endif
     for (pos_t p1 = 0; p1 < lattice.size(); ++p1)
     for (pos_t p2 = 0; p2 < lattice.size(); ++p2)
     {
-      std::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
-
 		  for (pos_t p3 = ((bra_neq_ket) ? 0 : std::min(p1, p2)); p3 < lattice.size(); ++p3)
       {
 		    if(p1 == p2 && p1 == p3)
@@ -181,6 +176,8 @@ protected:
 
           std::vector<pos_t> positions = {p1, p3, p4, p2};
           std::vector<pos_t> positionsORD = {p1, p2, p3, p4};
+          // Only the sites between the first and the last operator are contracted
+          auto span = std::minmax_element(positionsORD.begin(), positionsORD.end());
 
           // Loop over operator terms that are measured synchronously and added together
           typename MPS<Matrix, SymmGroup>::scalar_type value = 0;
@@ -191,15 +188,14 @@ protected:
             operators[1] = operator_terms[synop].first[1][lattice.get_prop<typename SymmGroup::subcharge>("type", p2)];
             operators[2] = operator_terms[synop].first[2][lattice.get_prop<typename SymmGroup::subcharge>("type", p3)];
             operators[3] = operator_terms[synop].first[3][lattice.get_prop<typename SymmGroup::subcharge>("type", p4)];
-            term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler_local);
+            term_descriptor term = generate_mpo::arrange_operators(positions, operators, tag_handler);
             // check if term is allowed by symmetry
-            //if(not measurements_details::checkpg<SymmGroup>()(term, tag_handler_local, lattice))
+            //if(not measurements_details::checkpg<SymmGroup>()(term, tag_handler, lattice))
             //    continue;
             measured = true;
-            MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler_local, lattice);
-            //value += operator_terms[synop].second * expval(bra_mps, ket_mps, mpo);
-            value += (this->cast_to_real) ? maquis::real(operator_terms[synop].second * expval(bra_mps, ket_mps_local, mpo)) 
-                                          : operator_terms[synop].second * expval(bra_mps, ket_mps_local, mpo);
+            MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler, lattice);
+            typename MPS<Matrix, SymmGroup>::scalar_type element = operator_terms[synop].second * cache.expval(mpo, *span.first, *span.second);
+            value += (this->cast_to_real) ? maquis::real(element) : element;
           }
 
           if(measured)
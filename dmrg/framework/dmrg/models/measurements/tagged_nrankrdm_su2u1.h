@@ -17,6 +17,7 @@
 #include "dmrg/utils/checks.h"
 #include "dmrg/models/chem/su2u1/term_maker.h"
 #include "dmrg/models/chem/transform_symmetry.hpp"
+#include "dmrg/mp_tensors/expval_boundary_cache.h"
 #include "measurements_details.h"
 
 namespace measurements {
@@ -85,15 +86,13 @@ protected:
   {
     // Test if a separate bra state has been specified
     bool bra_neq_ket = (dummy_bra_mps.length() > 0);
-    //MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> ket_mps_local = ket_mps;
+    // The cache stores its own copy of the MPSs, each thread works on a separate copy
+    ExpvalBoundaryCache<Matrix, SymmGroup> cache((bra_neq_ket) ? dummy_bra_mps : ket_mps, ket_mps);
     #ifdef MAQUIS_OPENMP
-    #pragma omp parallel for schedule(dynamic) firstprivate(bra_mps, ket_mps_local)
+    #pragma omp parallel for schedule(dynamic) firstprivate(cache)
     #endif
     for (std::size_t i = 0; i < positions_first.size(); ++i) {
       pos_t p1 = positions_first[i];
-      std::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
       std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
       std::vector<std::vector<pos_t> > num_labels;
       for (pos_t p2 = (bra_neq_ket ? 0 : p1); p2 < lattice.size(); ++p2)
@@ -115,13 +114,13 @@ protected:
         }
 
         // check if term is allowed by symmetry
-        if(not measurements_details::checkpg<SymmGroup>()(terms[0], tag_handler_local, lattice))
+        if(not measurements_details::checkpg<SymmGroup>()(terms[0], tag_handler, lattice))
                continue;
 
         generate_mpo::TaggedMPOMaker<Matrix, SymmGroup> mpo_m(lattice, op_collection.ident.no_couple, op_collection.ident_full.no_couple,
-                                                              op_collection.fill.no_couple, tag_handler_local, terms);
+                                                              op_collection.fill.no_couple, tag_handler, terms);
         MPO<Matrix, SymmGroup> mpo = mpo_m.create_mpo();
-        typename MPS<Matrix, SymmGroup>::scalar_type value = expval(bra_mps, ket_mps_local, mpo);
+        typename MPS<Matrix, SymmGroup>::scalar_type value = cache.expval(mpo, std::min(p1, p2), std::max(p1, p2));
 
         dct.push_back(value);
 
@@ -152,9 +151,7 @@ protected:
   {
     // Test if a separate bra state has been specified
     bool bra_neq_ket = (dummy_bra_mps.length() > 0);
-    //MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
-    MPS<Matrix, SymmGroup> ket_mps_local = ket_mps;
+    ExpvalBoundaryCache<Matrix, SymmGroup> cache((bra_neq_ket) ? dummy_bra_mps : ket_mps, ket_mps);
 
     // get all the labels ahead of the measurement and initialise the result arrays with the correct size
     auto indices = measurements_details::iterate_nrdm<2>(lattice.size(), bra_neq_ket);
@@ -163,12 +160,11 @@ protected:
     this->vector_results.resize(indices.size());
 
     #ifdef MAQUIS_OPENMP
-    #pragma omp parallel for schedule(dynamic) firstprivate(ket_mps_local, bra_mps)
+    #pragma omp parallel for schedule(dynamic) firstprivate(cache)
     #endif
     for (int i = 0; i < indices.size(); i++)
     {
       auto&& positions = indices[i];
-      std::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
       std::vector<term_descriptor> terms = SpinSumSU2<Matrix, SymmGroup>::V_term(1., positions[0], positions[1], positions[2], positions[3], op_collection, lattice);
       // save labels
       auto&& num_labels = order_labels(lattice, positions);
@@ -177,15 +173,17 @@ protected:
       this->labels_num[i] = num_labels;
 
       // check if term is allowed by symmetry
-      if(not measurements_details::checkpg<SymmGroup>()(terms[0], tag_handler_local, lattice)) {
+      if(not measurements_details::checkpg<SymmGroup>()(terms[0], tag_handler, lattice)) {
           this->vector_results[i] = 0.;
           continue;
       }
 
       generate_mpo::TaggedMPOMaker<Matrix, SymmGroup> mpo_m(lattice, op_collection.ident.no_couple, op_collection.ident_full.no_couple,
-                                                              op_collection.fill.no_couple, tag_handler_local, terms);
+                                                              op_collection.fill.no_couple, tag_handler, terms);
       MPO<Matrix, SymmGroup> mpo = mpo_m.create_mpo();
-      typename MPS<Matrix, SymmGroup>::scalar_type value = expval(bra_mps, ket_mps_local, mpo);
+      // Only the sites between the first and the last operator are contracted
+      auto span = std::minmax_element(positions.begin(), positions.end());
+      typename MPS<Matrix, SymmGroup>::scalar_type value = cache.expval(mpo, *span.first, *span.second);
 
       // save results
       this->vector_results[i] = value;
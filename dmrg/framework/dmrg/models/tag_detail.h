@@ -11,6 +11,7 @@
 #include <alps/numeric/isnan.hpp>
 #include <alps/numeric/isinf.hpp>
 #include <alps/numeric/is_nonzero.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace tag_detail {
 
@@ -124,6 +125,48 @@ namespace tag_detail {
 
         return std::make_pair(true, scale);
     }
+
+    /**
+     * @brief Hash of an operator which does not depend on its scale.
+     *
+     * Operators which are equal up to a scale factor, as defined by [equal], have the same hash.
+     * The hash combines the block sizes with the positions of the elements which are not negligible
+     * compared to the first non-zero element of the first block, which is the reference of [equal].
+     */
+    template <class BlockMatrix>
+    std::size_t scale_invariant_hash(BlockMatrix const & op)
+    {
+        typedef typename BlockMatrix::matrix_type Matrix;
+        typedef typename Matrix::value_type value_type;
+
+        {
+            parallel::guard::serial guard;
+            storage::migrate(op);
+        }
+
+        std::size_t seed = op.n_blocks();
+        double reference = 0.;
+        if (op.n_blocks() > 0)
+            for (std::size_t i = 0; i < num_rows(op[0]) && reference == 0.; i++)
+                for (std::size_t j = 0; j < num_cols(op[0]); j++)
+                    if (std::abs(op[0](i,j)) > 1.e-50) {
+                        reference = std::abs(op[0](i,j));
+                        break;
+                    }
+
+        for (typename Matrix::size_type b = 0; b < op.n_blocks(); ++b)
+        {
+            boost::hash_combine(seed, num_rows(op[b]));
+            boost::hash_combine(seed, num_cols(op[b]));
+            if (reference == 0.)
+                continue;
+            for (std::size_t i = 0; i < num_rows(op[b]); i++)
+                for (std::size_t j = 0; j < num_cols(op[b]); j++)
+                    if (std::abs(op[b](i,j)) > 1.e-8 * reference)
+                        boost::hash_combine(seed, i * num_cols(op[b]) + j);
+        }
+        return seed;
+    }
 }
 
 #endif
@@ -133,6 +133,18 @@ public:
                (mps, mpo, left, right, alpha, cutoff, Mmax, perturbDM, verbose);
     }
 
+    static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+    predict_expanded_state_l2r_sweep(MPSTensor<Matrix, SymmGroup> const & mps,
+                                     MPOTensor<Matrix, SymmGroup> const & mpo,
+                                     Boundary<OtherMatrix, SymmGroup> const & left,
+                                     Boundary<OtherMatrix, SymmGroup> const & right,
+                                     double alpha, double cutoff, std::size_t Mmax,
+                                     double expansionRatio, bool verbose)
+    {
+        return common::predict_expanded_state_l2r_sweep<Matrix, OtherMatrix, SymmGroup, abelian::Gemms, lbtm_functor>
+               (mps, mpo, left, right, alpha, cutoff, Mmax, expansionRatio, verbose);
+    }
+
     static MPSTensor<Matrix, SymmGroup>
     predict_lanczos_l2r_sweep(MPSTensor<Matrix, SymmGroup> B,
                               MPSTensor<Matrix, SymmGroup> const & psi,
@@ -161,6 +173,18 @@ public:
                (mps, mpo, left, right, alpha, cutoff, Mmax, perturbDM, verbose);
     }
 
+    static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+    predict_expanded_state_r2l_sweep(MPSTensor<Matrix, SymmGroup> const & mps,
+                                     MPOTensor<Matrix, SymmGroup> const & mpo,
+                                     Boundary<OtherMatrix, SymmGroup> const & left,
+                                     Boundary<OtherMatrix, SymmGroup> const & right,
+                                     double alpha, double cutoff, std::size_t Mmax,
+                                     double expansionRatio, bool verbose)
+    {
+        return common::predict_expanded_state_r2l_sweep<Matrix, OtherMatrix, SymmGroup, abelian::Gemms, rbtm_functor>
+               (mps, mpo, left, right, alpha, cutoff, Mmax, expansionRatio, verbose);
+    }
+
     static MPSTensor<Matrix, SymmGroup>
     predict_lanczos_r2l_sweep(MPSTensor<Matrix, SymmGroup> B,
                               MPSTensor<Matrix, SymmGroup> const & psi,
@@ -193,6 +217,31 @@ public:
 
     // non-generic method
 
+    /** @brief The abelian sigma vector is not precompiled, the plan only forwards to site_hamil2 */
+    struct site_hamil_plan
+    {
+        MPSTensor<Matrix, SymmGroup> apply(MPSTensor<Matrix, SymmGroup> const & ket_tensor,
+                                           Boundary<OtherMatrix, SymmGroup> const & left,
+                                           Boundary<OtherMatrix, SymmGroup> const & right,
+                                           MPOTensor<Matrix, SymmGroup> const & mpo,
+                                           bool isHermitian=true)
+        {
+            return Engine::site_hamil2(ket_tensor, left, right, mpo, isHermitian);
+        }
+
+        std::vector<MPSTensor<Matrix, SymmGroup> > apply_batch(std::vector<MPSTensor<Matrix, SymmGroup> > const & kets,
+                                                               Boundary<OtherMatrix, SymmGroup> const & left,
+                                                               Boundary<OtherMatrix, SymmGroup> const & right,
+                                                               MPOTensor<Matrix, SymmGroup> const & mpo,
+                                                               bool isHermitian=true)
+        {
+            std::vector<MPSTensor<Matrix, SymmGroup> > ret;
+            for (std::size_t n = 0; n < kets.size(); ++n)
+                ret.push_back(Engine::site_hamil2(kets[n], left, right, mpo, isHermitian));
+            return ret;
+        }
+    };
+
     static MPSTensor<Matrix, SymmGroup>
     site_hamil2(MPSTensor<Matrix, SymmGroup> ket_tensor,
                 Boundary<OtherMatrix, SymmGroup> const & left,
@@ -221,9 +270,10 @@ public:
 
     static block_matrix<Matrix, SymmGroup>
     diagonal_hamiltonian(Boundary<OtherMatrix, SymmGroup> const &left, Boundary<OtherMatrix, SymmGroup> const &right,
-                         MPOTensor <Matrix, SymmGroup> const &mpo, MPSTensor<Matrix, SymmGroup> const &x)
+                         MPOTensor <Matrix, SymmGroup> const &mpo, MPSTensor<Matrix, SymmGroup> const &x,
+                         bool reuse=false)
     {
-        return contraction::diagonal_hamiltonian(left, right, mpo, x);
+        return contraction::diagonal_hamiltonian(left, right, mpo, x, reuse);
     }
 
 
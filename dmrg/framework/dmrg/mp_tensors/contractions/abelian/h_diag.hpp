@@ -12,158 +12,58 @@
 #include "dmrg/block_matrix/block_matrix.h"
 #include "dmrg/mp_tensors/mpstensor.h"
 #include "dmrg/mp_tensors/mpotensor.h"
+#include "dmrg/mp_tensors/contractions/common/h_diag.hpp"
 
 namespace contraction {
-//
-// Function template for the calculation of the T matrix by assuming a diagonal MPO (see JCP 2015 for additional
-// details). The quantity which is computed is:
-//
-//  -----  -----   -----          o_l o_l'      |    b_{l-1}          |\/| o_l'
-//  \      \       \       \    /               |                     |  |
-//  /      /       /        \/\/  b_{l-1} b_l   |___ a_{l-1} a_{l-1}' |  | a_{l-1}' a_l'
-//  -----  -----   -----
-//   o_l' a_{l-1}' b_{l-1}  |                                        |
-//                          +----------------------------------------+
-//                                   |
-//                                   +--------------->    This is T (summed over b). In principle has 5
-//                                                        indexes, but only 3 in this case due to symmetry.
-//                                                        Note that we sum over the left boundary.
-//
-// where W is the matrix involved in the definition of the MPO, L is the left boundary and M is the matrix
-// involved in the definition of the MPS.
-// We have < a_{l-1} a_l o_l | H | o_l' a_{l-1}' a_l' > . Taking the diagonal part means that we are
-// taking o_l = o_l' , a_l = a_l' and a_{l-1} = a_{l-1}'. The only sum surviving is the one over b_{l-1}
-// NOTE: the index b_l (column) is given as input and is fixed throughout the routine
-//
-//
-    template<class Matrix, class OtherMatrix, class SymmGroup>
-    block_matrix<Matrix, SymmGroup>
-    lbtm_diag_kernel(size_t b2,
-                     Boundary<OtherMatrix, SymmGroup> const &left,
-                     MPOTensor <Matrix, SymmGroup> const &mpo,
-                     Index<SymmGroup> const &out_left_i,
-                     Index<SymmGroup> const &left_i,
-                     Index<SymmGroup> const &right_i,
-                     Index<SymmGroup> const &phys_i,
-                     ProductBasis<SymmGroup> const &left_pb) {
-        //
-        // Initialization
-        // --------------
-        typedef typename MPOTensor<OtherMatrix, SymmGroup>::index_type index_type;
-        typedef typename MPOTensor<OtherMatrix, SymmGroup>::col_proxy col_proxy;
-        typedef typename DualIndex<SymmGroup>::const_iterator const_iterator;
-        typedef typename SymmGroup::charge charge;
+
+    /**
+     * @brief Weights of the diagonal elements of the operators in the abelian case.
+     *
+     * Each diagonal element < a_{l-1} o_l a_l | H | a_{l-1} o_l a_l > collects, for each MPO entry (b_{l-1}, b_l),
+     * the diagonal of the left boundary L[b_{l-1}], the diagonal element of the operator W[o_l, o_l] times
+     * the scale of the entry, and the diagonal of the right boundary R[b_l] (see JCP 2015).
+     */
+    template<class Matrix, class SymmGroup>
+    class AbelianDiagonalCoupling
+    {
+    public:
         typedef typename Matrix::value_type value_type;
-        block_matrix<Matrix, SymmGroup> ret;
-        // The second index of the MPO is fixed. We loop over the first index
-        col_proxy col_b2 = mpo.column(b2);
-        for (typename col_proxy::const_iterator col_it = col_b2.begin(); col_it != col_b2.end(); ++col_it) {
-            index_type b1 = col_it.index() ;
-            MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> access = mpo.at(b1, b2);
-            typename operator_selector<Matrix, SymmGroup>::type const &W = access.op(0);
-            // Loop over a_l' (right dimension of ret). Pay attention to the symmetry
-            for (size_t block = 0; block < right_i.size(); ++block) {
-                charge in_charge = right_i[block].first;
-                size_t o = ret.find_block(in_charge, in_charge);
-                // Insert block with the same symmetry of the right index
-                if (o == ret.n_blocks())
-                    o = ret.insert_block(Matrix(out_left_i[block].second, right_i[block].second), in_charge, in_charge);
-                // Loop over the physical indexes
-                for (size_t s = 0; s < phys_i.size(); ++s) {
-                    // Symmetry requirement : o_l*a_{l-1} == a_l'. In this way we determine a_{l-1}, which is also
-                    // the index of the left boundary to be extracted.
-                    charge phys_charge = phys_i[s].first;
-                    size_t l = left_i.position(SymmGroup::fuse(in_charge, -phys_charge));
-                    if (l == left_i.size()) continue;
-                    charge lc = left_i[l].first;
-                    size_t l_block = left[b1].find_block(lc, lc);
-                    if (l_block == left[b1].n_blocks()) continue;
-                    // copy the diagonal elements of the boundary into a vector
-                    std::vector<value_type> left_diagonal(left_i[l].second);
-                    // Diagonal is a method of the alps matrix class that gives two iterators, for the
-                    // beginning and the end of the diagonal.
-                    std::copy(left[b1][l_block].diagonal().first, left[b1][l_block].diagonal().second,
-                              left_diagonal.begin());
-                    // The overall size of (o_l*a_{l-1}) is given by the product
-                    size_t left_offset = left_pb(phys_charge, lc);
-                    // Loop over the basis of the MPO. Both the basis have to have the
-                    // qn phys_charge
-                    for (size_t w_block = 0; w_block < W.basis().size(); ++w_block) {
-                        charge phys_in = W.basis().left_charge(w_block);
-                        charge phys_out = W.basis().right_charge(w_block);
-                        if (phys_charge != phys_in || phys_in != phys_out) continue;
-                        typedef typename SparseOperator<Matrix, SymmGroup>::const_iterator block_iterator;
-                        std::pair<block_iterator, block_iterator> blocks = W.get_sparse().block(w_block);
-                        for (block_iterator it = blocks.first; it != blocks.second; ++it) {
-                            std::size_t ss1 = it->row;
-                            if (ss1 != it->col) continue;
-                            for (size_t col_i = 0; col_i < right_i[block].second; ++col_i) {
-                                std::transform(left_diagonal.begin(), left_diagonal.end(),
-                                               &ret[o](left_offset + ss1 * left_i[l].second, col_i),
-                                               &ret[o](left_offset + ss1 * left_i[l].second, col_i),
-                                               boost::lambda::_2 += boost::lambda::_1 * it->coefficient) ;
-                            }
-                        }
-                    }
-                }
-            }
+        typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+        typedef typename SymmGroup::charge charge;
+
+        void set(MPOTensor<Matrix, SymmGroup> const & mpo, index_type b1, index_type b2,
+                 typename operator_selector<Matrix, SymmGroup>::type const & W, value_type scale,
+                 charge lc, charge rc)
+        {
+            scale_ = scale;
         }
-        return ret;
-    }
 
-//
-// Function template to contract T with the right boundaries.
-//
-//  -----     -----  o_l o_l      +--+  b_l       -+
-//  \           |                 +--+             |-> this is has three index (one of which is sigma)
-//  /           |    b_l a_{l-1}  |  \ a_l a_l    -+   as any other MPSTensor.
-//  -----
-//   a_l'
-//
-//
-// where W is the matrix involved in the definition of the MPO, L is the left boundary and M is the matrix
-// involved in the definition of the MPS.
-// We have < a_{l-1} a_l o_l | H | o_l' a_{l-1}' a_l' > . Taking the diagonal part means that we are
-// taking o_l = o_l' , a_l = a_l' and a_{l-1} = a_{l-1}'. The only sum surviving is the one over b_{l-1}
-// NOTE: the index b_l (column) is given as input and is fixed throughout the routine
-//
-//
+        template<class Entry>
+        value_type operator()(Entry const & entry) const { return entry.coefficient * scale_; }
+
+    private:
+        value_type scale_;
+    };
+
+    /**
+     * @brief Diagonal of the site Hamiltonian, used to precondition the iterative solvers.
+     * @param reuse if true, the diagonal calculated last by the calling thread is reused when
+     *              the boundaries, the MPO tensor and the indices of [x] are unchanged.
+     */
     template<class Matrix, class OtherMatrix, class SymmGroup>
     block_matrix<Matrix, SymmGroup>
     diagonal_hamiltonian(Boundary<OtherMatrix, SymmGroup> const &left,
                          Boundary<OtherMatrix, SymmGroup> const &right,
                          MPOTensor <Matrix, SymmGroup> const &mpo,
-                         MPSTensor<Matrix, SymmGroup> const &x)
+                         MPSTensor<Matrix, SymmGroup> const &x,
+                         bool reuse = false)
     {
-        // +--------------+
-        //  Initialization
-        // +--------------+
-        // Note that the phys index and the row are grouped together
-        typedef typename SymmGroup::charge charge;
-        Index<SymmGroup> const &physical_i = x.site_dim();
-        Index<SymmGroup> right_i = x.col_dim();
-        Index<SymmGroup> out_left_i = physical_i * x.row_dim();
-        common_subset(out_left_i, right_i) ;
-        ProductBasis<SymmGroup> out_left_pb(physical_i, x.row_dim());
-        block_matrix<Matrix, SymmGroup> ret ;
-        // Loop over the b2 index, which is the "higher" index of the T tensor
-        for (size_t b2 = 0; b2 < right.aux_dim(); ++b2) {
-            block_matrix<Matrix, SymmGroup> lb2 = lbtm_diag_kernel(b2, left, mpo, out_left_i,
-                                                                   x.row_dim(), x.col_dim(), physical_i,
-                                                                   out_left_pb);
-            for (size_t block = 0; block < lb2.n_blocks(); ++block) {
-                charge in_r_charge = lb2.basis().right_charge(block);
-                size_t rblock = right[b2].find_block(in_r_charge, in_r_charge);
-                if (rblock != right[b2].n_blocks()) {
-                    // Final contraction
-                    for (size_t c = 0; c < num_cols(lb2[block]); ++c)
-                        std::transform(lb2[block].col(c).first, lb2[block].col(c).second, lb2[block].col(c).first,
-                                       boost::lambda::_1 * right[b2][rblock](c, c));
-                    ret.match_and_add_block(lb2[block], in_r_charge, in_r_charge);
-                }
-            }
-        }
-        return ret;
+        AbelianDiagonalCoupling<Matrix, SymmGroup> coupling;
+        if (reuse)
+            return common::cached_diagonal_hamiltonian(left, right, mpo, x, coupling);
+        return common::diagonal_hamiltonian(common::BoundaryDiagonals<OtherMatrix, SymmGroup>(left, mpo, true),
+                                            common::BoundaryDiagonals<OtherMatrix, SymmGroup>(right, mpo, false),
+                                            mpo, x, coupling);
     }
 }
 
@@ -40,10 +40,10 @@ site_hamil2(MPSTensor<Matrix, SymmGroup> ket_tensor, MPSTensor<Matrix, SymmGroup
                      out_left_i = physical_i * left_i;
     Index<SymmGroup> right_i_bra = bra_tensor.col_dim();
     common_subset(out_left_i, right_i);
-    ProductBasis<SymmGroup> out_left_pb(physical_i, left_i);
-    ProductBasis<SymmGroup> in_right_pb(physical_i, right_i,
-                            boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                    -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+    ProductBasis<SymmGroup> const & out_left_pb = out_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+    ProductBasis<SymmGroup> const & in_right_pb = in_right_fb->offsets();
     // Prepares output tensor
     MPSTensor<Matrix, SymmGroup> ret;
     ret.phys_i = bra_tensor.site_dim();
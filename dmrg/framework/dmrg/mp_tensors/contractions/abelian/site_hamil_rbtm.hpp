@@ -30,10 +30,10 @@ namespace contraction {
                          out_right_i = adjoin(physical_i) * right_i;
 
         common_subset(out_right_i, left_i);
-        ProductBasis<SymmGroup> in_left_pb(physical_i, left_i);
-        ProductBasis<SymmGroup> out_right_pb(physical_i, right_i,
-                                             boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                                                 -boost::lambda::_1, boost::lambda::_2));
+        std::shared_ptr<const FusedBasis<SymmGroup> > in_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+        ProductBasis<SymmGroup> const & in_left_pb = in_left_fb->offsets();
+        std::shared_ptr<const FusedBasis<SymmGroup> > out_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+        ProductBasis<SymmGroup> const & out_right_pb = out_right_fb->offsets();
         block_matrix<Matrix, SymmGroup> collector;
         MPSTensor<Matrix, SymmGroup> ret;
         ret.phys_i = ket_tensor.site_dim(); ret.left_i = ket_tensor.row_dim(); ret.right_i = ket_tensor.col_dim();
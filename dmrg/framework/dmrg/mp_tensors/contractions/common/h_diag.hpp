@@ -0,0 +1,243 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef CONTRACTIONS_COMMON_H_DIAG_HPP
+#define CONTRACTIONS_COMMON_H_DIAG_HPP
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "dmrg/block_matrix/block_matrix.h"
+#include "dmrg/block_matrix/fused_basis.h"
+#include "dmrg/mp_tensors/boundary.h"
+#include "dmrg/mp_tensors/mpstensor.h"
+#include "dmrg/mp_tensors/mpotensor.h"
+#include "dmrg/mp_tensors/contractions/common/boundary_times_mps.hpp"
+
+namespace contraction {
+namespace common {
+
+    /**
+     * @brief Diagonals of the blocks of a boundary that are diagonal in the symmetry sectors.
+     *
+     * These are the only elements of the boundaries that enter the diagonal of the site Hamiltonian.
+     * The components of the boundary that are skipped because of the hermiticity of the MPO are
+     * recovered from their conjugate components (with the SU2 phases), as in the sigma vector.
+     */
+    template<class Matrix, class SymmGroup>
+    class BoundaryDiagonals
+    {
+    public:
+        typedef typename SymmGroup::charge charge;
+        typedef typename Matrix::value_type value_type;
+
+        /**
+         * @brief Class constructor
+         * @param boundary left or right boundary
+         * @param mpo MPO tensor of the site, providing the hermiticity information
+         * @param left true for the left boundary
+         */
+        template<class MPOMatrix>
+        BoundaryDiagonals(Boundary<Matrix, SymmGroup> const & boundary, MPOTensor<MPOMatrix, SymmGroup> const & mpo, bool left)
+            : diagonals_(boundary.aux_dim())
+        {
+            for (std::size_t b = 0; b < boundary.aux_dim(); ++b) {
+                bool skip = left ? mpo.herm_info.left_skip(b) : mpo.herm_info.right_skip(b);
+                if (!skip) {
+                    for (std::size_t k = 0; k < boundary[b].n_blocks(); ++k)
+                        if (boundary[b].basis().left_charge(k) == boundary[b].basis().right_charge(k))
+                            diagonals_[b][boundary[b].basis().left_charge(k)].assign(boundary[b][k].diagonal().first,
+                                                                                     boundary[b][k].diagonal().second);
+                    continue;
+                }
+                // The diagonal sectors of the conjugate component are the same, up to a phase.
+                std::size_t conj = left ? mpo.herm_info.left_conj(b) : mpo.herm_info.right_conj(b);
+                block_matrix<Matrix, SymmGroup> source = left ? conjugate(boundary[conj]) : adjoint(boundary[conj]);
+                std::vector<value_type> phases = conjugate_phases(source, mpo, b, left, !left);
+                for (std::size_t k = 0; k < source.n_blocks(); ++k) {
+                    if (source.basis().left_charge(k) != source.basis().right_charge(k))
+                        continue;
+                    std::vector<value_type> & diagonal = diagonals_[b][source.basis().left_charge(k)];
+                    diagonal.assign(source[k].diagonal().first, source[k].diagonal().second);
+                    for (std::size_t i = 0; i < diagonal.size(); ++i)
+                        diagonal[i] *= phases[k];
+                }
+            }
+        }
+
+        std::size_t aux_dim() const { return diagonals_.size(); }
+
+        /** @brief Diagonal of the block (c, c) of the b-th component, nullptr if the block is not present */
+        std::vector<value_type> const * find(std::size_t b, charge c) const
+        {
+            typename std::map<charge, std::vector<value_type> >::const_iterator match = diagonals_[b].find(c);
+            return (match == diagonals_[b].end()) ? nullptr : &match->second;
+        }
+
+        bool operator==(BoundaryDiagonals const & rhs) const { return diagonals_ == rhs.diagonals_; }
+
+    private:
+        std::vector<std::map<charge, std::vector<value_type> > > diagonals_;
+    };
+
+    /**
+     * @brief Diagonal of the site Hamiltonian, for the coupling of the MPO entries given by [Coupling].
+     *
+     * For each symmetry sector, the diagonal is the product T * R of the matrix T (rows of the sector
+     * times right MPO index), which collects the diagonals of the left boundary weighted by the diagonal
+     * elements of the operators, with the matrix R (right MPO index times columns of the sector) of the
+     * diagonals of the right boundary.
+     * The contraction over the right MPO index is therefore a single gemm per sector, and the left
+     * diagonals are accumulated with contiguous axpy's.
+     *
+     * [Coupling] must provide set(mpo, b1, b2, W, scale, lc, rc), which prepares the coupling of the
+     * operator W of the MPO entry (b1, b2) between the left sector lc and the right sector rc, and
+     * operator()(entry), which returns the weight of a diagonal element of W.
+     */
+    template<class Matrix, class OtherMatrix, class SymmGroup, class Coupling>
+    block_matrix<Matrix, SymmGroup>
+    diagonal_hamiltonian(BoundaryDiagonals<OtherMatrix, SymmGroup> const & left,
+                         BoundaryDiagonals<OtherMatrix, SymmGroup> const & right,
+                         MPOTensor<Matrix, SymmGroup> const & mpo,
+                         MPSTensor<Matrix, SymmGroup> const & x,
+                         Coupling coupling)
+    {
+        typedef typename SymmGroup::charge charge;
+        typedef typename Matrix::value_type value_type;
+        typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+        typedef typename MPOTensor<Matrix, SymmGroup>::col_proxy col_proxy;
+        typedef typename SparseOperator<Matrix, SymmGroup>::const_iterator block_iterator;
+
+        Index<SymmGroup> const & physical_i = x.site_dim();
+        Index<SymmGroup> const & left_i = x.row_dim();
+        Index<SymmGroup> right_i = x.col_dim();
+        Index<SymmGroup> out_left_i = physical_i * left_i;
+        common_subset(out_left_i, right_i);
+        std::shared_ptr<const FusedBasis<SymmGroup> > out_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+        ProductBasis<SymmGroup> const & out_left_pb = out_left_fb->offsets();
+
+        std::vector<Matrix> blocks(right_i.size());
+        std::vector<char> present(right_i.size(), false);
+        omp_for(index_type block, parallel::range<index_type>(0, right_i.size()), {
+            charge in_charge = right_i[block].first;
+            // Right MPO indices for which the right boundary has the diagonal sector
+            std::vector<index_type> columns;
+            std::vector<std::vector<value_type> const *> right_diagonals;
+            for (index_type b2 = 0; b2 < mpo.col_dim(); ++b2)
+                if (std::vector<value_type> const * d = right.find(b2, in_charge)) {
+                    columns.push_back(b2);
+                    right_diagonals.push_back(d);
+                }
+            if (columns.empty())
+                continue;
+            Matrix T(out_left_i[block].second, columns.size());
+            Coupling local_coupling = coupling;
+            for (std::size_t k = 0; k < columns.size(); ++k) {
+                index_type b2 = columns[k];
+                col_proxy col_b2 = mpo.column(b2);
+                for (typename col_proxy::const_iterator col_it = col_b2.begin(); col_it != col_b2.end(); ++col_it) {
+                    index_type b1 = col_it.index();
+                    MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> access = mpo.at(b1, b2);
+                    for (std::size_t op_index = 0; op_index < access.size(); ++op_index) {
+                        typename operator_selector<Matrix, SymmGroup>::type const & W = access.op(op_index);
+                        for (std::size_t s = 0; s < physical_i.size(); ++s) {
+                            // o_l * a_{l-1} == a_l fixes the sector of the left boundary
+                            charge phys_charge = physical_i[s].first;
+                            std::size_t l = left_i.position(SymmGroup::fuse(in_charge, -phys_charge));
+                            if (l == left_i.size())
+                                continue;
+                            charge lc = left_i[l].first;
+                            std::vector<value_type> const * left_diagonal = left.find(b1, lc);
+                            if (left_diagonal == nullptr)
+                                continue;
+                            std::size_t left_offset = out_left_pb(phys_charge, lc);
+                            std::size_t ldim = left_i[l].second;
+                            for (std::size_t w_block = 0; w_block < W.basis().size(); ++w_block) {
+                                if (W.basis().left_charge(w_block) != phys_charge || W.basis().right_charge(w_block) != phys_charge)
+                                    continue;
+                                local_coupling.set(mpo, b1, b2, W, access.scale(op_index), lc, in_charge);
+                                std::pair<block_iterator, block_iterator> entries = W.get_sparse().block(w_block);
+                                for (block_iterator it = entries.first; it != entries.second; ++it) {
+                                    if (it->row != it->col)
+                                        continue;
+                                    value_type alpha = local_coupling(*it);
+                                    value_type * column = &T(left_offset + it->row * ldim, k);
+                                    for (std::size_t i = 0; i < ldim; ++i)
+                                        column[i] += alpha * (*left_diagonal)[i];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            Matrix R(columns.size(), right_i[block].second);
+            for (std::size_t c = 0; c < num_cols(R); ++c)
+                for (std::size_t k = 0; k < columns.size(); ++k)
+                    R(k, c) = (*right_diagonals[k])[c];
+            Matrix diagonal(num_rows(T), num_cols(R));
+            gemm(T, R, diagonal);
+            swap(blocks[block], diagonal);
+            present[block] = true;
+        });
+
+        block_matrix<Matrix, SymmGroup> ret;
+        for (std::size_t block = 0; block < right_i.size(); ++block)
+            if (present[block])
+                ret.insert_block(blocks[block], right_i[block].first, right_i[block].first);
+        return ret;
+    }
+
+    /**
+     * @brief Diagonal of the site Hamiltonian, reusing the last one calculated by the calling thread.
+     *
+     * The diagonal only depends on the diagonals of the boundary blocks, on the MPO tensor and on the
+     * indices of the MPS tensor, and not on its elements. It is therefore reused as long as these do
+     * not change, e.g. when the same site problem is solved again in the next micro-iteration, or
+     * when the preconditioner of a restarted solver is built again.
+     * The MPO tensor is identified by its address and operator table.
+     */
+    template<class Matrix, class OtherMatrix, class SymmGroup, class Coupling>
+    block_matrix<Matrix, SymmGroup>
+    cached_diagonal_hamiltonian(Boundary<OtherMatrix, SymmGroup> const & left,
+                                Boundary<OtherMatrix, SymmGroup> const & right,
+                                MPOTensor<Matrix, SymmGroup> const & mpo,
+                                MPSTensor<Matrix, SymmGroup> const & x,
+                                Coupling coupling)
+    {
+        struct entry
+        {
+            entry(BoundaryDiagonals<OtherMatrix, SymmGroup> && l, BoundaryDiagonals<OtherMatrix, SymmGroup> && r)
+                : left(std::move(l)), right(std::move(r)) { }
+            BoundaryDiagonals<OtherMatrix, SymmGroup> left, right;
+            MPOTensor<Matrix, SymmGroup> const * mpo;
+            typename MPOTensor<Matrix, SymmGroup>::op_table_ptr operator_table;
+            Index<SymmGroup> phys_i, left_i, right_i;
+            block_matrix<Matrix, SymmGroup> diagonal;
+        };
+        static thread_local std::unique_ptr<entry> last;
+
+        std::unique_ptr<entry> current(new entry(BoundaryDiagonals<OtherMatrix, SymmGroup>(left, mpo, true),
+                                                 BoundaryDiagonals<OtherMatrix, SymmGroup>(right, mpo, false)));
+        if (last && last->mpo == &mpo && last->operator_table == mpo.get_operator_table()
+            && last->phys_i == x.site_dim() && last->left_i == x.row_dim() && last->right_i == x.col_dim()
+            && last->left == current->left && last->right == current->right)
+            return last->diagonal;
+
+        current->mpo = &mpo;
+        current->operator_table = mpo.get_operator_table();
+        current->phys_i = x.site_dim();
+        current->left_i = x.row_dim();
+        current->right_i = x.col_dim();
+        current->diagonal = diagonal_hamiltonian(current->left, current->right, mpo, x, coupling);
+        last = std::move(current);
+        return last->diagonal;
+    }
+
+} // namespace common
+} // namespace contraction
+
+#endif
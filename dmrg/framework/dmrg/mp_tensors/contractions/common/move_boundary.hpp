@@ -80,10 +80,10 @@ left_boundary_tensor_mpo(MPSTensor<Matrix, SymmGroup> mps,
     Index<SymmGroup> physical_i = mps.site_dim(), left_i = *in_low, right_i = mps.col_dim(),
                                   out_left_i = physical_i * left_i;
     BoundaryMPSProduct<Matrix, OtherMatrix, SymmGroup, Gemm> t(mps, left, mpo, left_i);
-    ProductBasis<SymmGroup> out_left_pb(physical_i, left_i);
-    ProductBasis<SymmGroup> in_right_pb(physical_i, right_i,
-                            boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                    -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+    ProductBasis<SymmGroup> const & out_left_pb = out_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+    ProductBasis<SymmGroup> const & in_right_pb = in_right_fb->offsets();
     index_type loop_max = mpo.col_dim();
     Boundary<Matrix, SymmGroup> ret;
     ret.resize(mpo.col_dim());
@@ -110,10 +110,10 @@ right_boundary_tensor_mpo(MPSTensor<Matrix, SymmGroup> mps,
     contraction::common::MPSBoundaryProduct<Matrix, OtherMatrix, SymmGroup, Gemm> t(mps, right, mpo);
     Index<SymmGroup> physical_i = mps.site_dim(), left_i = mps.row_dim(), right_i = *in_low,
                      out_right_i = adjoin(physical_i) * right_i;
-    ProductBasis<SymmGroup> in_left_pb(physical_i, left_i);
-    ProductBasis<SymmGroup> out_right_pb(physical_i, right_i,
-                                         boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                                             -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+    ProductBasis<SymmGroup> const & in_left_pb = in_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+    ProductBasis<SymmGroup> const & out_right_pb = out_right_fb->offsets();
     Boundary<Matrix, SymmGroup> ret;
     ret.resize(mpo.row_dim());
     index_type loop_max = mpo.row_dim();
@@ -142,10 +142,10 @@ overlap_mpo_left_step(MPSTensor<Matrix, SymmGroup> const & bra_tensor, MPSTensor
     Index<SymmGroup> bra_right_i = bra_tensor.col_dim();
     Index<SymmGroup> out_left_i = bra_tensor.site_dim() * left_i;
     common_subset(out_left_i, bra_right_i);
-    ProductBasis<SymmGroup> out_left_pb(bra_tensor.site_dim(), left_i);
-    ProductBasis<SymmGroup> in_right_pb(ket_tensor.site_dim(), right_i,
-                            boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                    -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_left_fb = FusedBasis<SymmGroup>::get(bra_tensor.site_dim(), left_i);
+    ProductBasis<SymmGroup> const & out_left_pb = out_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_right_fb = FusedBasis<SymmGroup>::get(ket_tensor.site_dim(), right_i, true);
+    ProductBasis<SymmGroup> const & in_right_pb = in_right_fb->offsets();
     index_type loop_max = mpo.col_dim();
     DualIndex<SymmGroup> bra_basis = bra_tensor.data().basis();
     bra_tensor.make_left_paired();
@@ -204,10 +204,10 @@ overlap_mpo_right_step(MPSTensor<Matrix, SymmGroup> const & bra_tensor, MPSTenso
     Index<SymmGroup> indexForTrim = bra_tensor.data().right_basis();
     contraction::common::MPSBoundaryProduct<Matrix, OtherMatrix, SymmGroup, Gemm> t(ket_cpy, right, mpo, indexForTrim, isHermitian);
     common_subset(out_right_i, bra_left_i);
-    ProductBasis<SymmGroup> in_left_pb(physical_i, left_i);
-    ProductBasis<SymmGroup> out_right_pb(physical_i, right_i,
-                                         boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                                             -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+    ProductBasis<SymmGroup> const & in_left_pb = in_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+    ProductBasis<SymmGroup> const & out_right_pb = out_right_fb->offsets();
     Boundary<Matrix, SymmGroup> ret;
     ret.resize(mpo.row_dim());
     //ket_tensor.make_right_paired();
@@ -255,10 +255,10 @@ generate_left_mpo_basis(MPSTensor<Matrix, SymmGroup> const & bra_tensor,   // Br
     // The input product basis (in_right_pb) is computed as product of the site_dim of the ket_tensor object
     // by the its col_dim. In fact, the tensor in input is right_paired. The output is instead left_paired
     // (and the fusion has to be done with the minus sign).
-    ProductBasis<SymmGroup> out_left_pb(ket_tensor.site_dim(), left_i);
-    ProductBasis<SymmGroup> in_right_pb(ket_tensor.site_dim(), right_i,
-                                        boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                                            -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_left_fb = FusedBasis<SymmGroup>::get(ket_tensor.site_dim(), left_i);
+    ProductBasis<SymmGroup> const & out_left_pb = out_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_right_fb = FusedBasis<SymmGroup>::get(ket_tensor.site_dim(), right_i, true);
+    ProductBasis<SymmGroup> const & in_right_pb = in_right_fb->offsets();
     index_type loop_max = mpo.col_dim();
     DualIndex<SymmGroup> ket_basis_transpose = ket_cpy.data().basis();
     for (std::size_t i = 0; i < ket_basis_transpose.size(); ++i) {
@@ -303,9 +303,10 @@ generate_right_mpo_basis(MPSTensor<Matrix, SymmGroup> const & bra_tensor, MPSTen
     Index<SymmGroup> left_i = ket_tensor.row_dim();
     Index<SymmGroup> out_right_i = adjoin(physical_i) * right_i;
     common_subset(out_right_i, left_i);
-    ProductBasis<SymmGroup> in_left_pb(physical_i, left_i);
-    ProductBasis<SymmGroup> out_right_pb(physical_i, right_i, boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                                             -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+    ProductBasis<SymmGroup> const & in_left_pb = in_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+    ProductBasis<SymmGroup> const & out_right_pb = out_right_fb->offsets();
     // Prepares output
     Boundary<Matrix, SymmGroup> ret;
     ret.resize(mpo.row_dim());
@@ -12,10 +12,100 @@
 #include "dmrg/mp_tensors/mpotensor.h"
 #include "dmrg/mp_tensors/reshapes.h"
 #include "dmrg/block_matrix/indexing.h"
+#include "dmrg/utils/random.hpp"
 
 namespace contraction {
 namespace common {
 
+namespace detail {
+
+/**
+ * @brief Number of random vectors used to sketch the expansion of each symmetry block.
+ *
+ * A block of the paired MPS with n rows and m columns can be enriched with at most n - min(n, m)
+ * new states. ceil(ratio*m) of them, and at least one, are sketched.
+ */
+template<class Matrix, class SymmGroup>
+std::map<typename SymmGroup::charge, std::size_t>
+cbe_sketch_sizes(block_matrix<Matrix, SymmGroup> const & A, double ratio)
+{
+    std::map<typename SymmGroup::charge, std::size_t> ret;
+    for (std::size_t k = 0; k < A.n_blocks(); ++k) {
+        std::size_t n = num_rows(A[k]), m = num_cols(A[k]);
+        std::size_t s = std::min(n - std::min(n, m), std::max<std::size_t>(1, std::ceil(ratio*m)));
+        if (s > 0)
+            ret[A.basis().left_charge(k)] = s;
+    }
+    return ret;
+}
+
+/**
+ * @brief Randomized range sketch P*G/sqrt(s) of one MPO component P of the perturbation.
+ *
+ * G is a Gaussian random matrix with s columns drawn from a generator seeded with [seed], so that
+ * the result does not depend on the order in which the MPO components are processed.
+ * Only the blocks whose row charge appears in [sizes] are sketched, the result is block-diagonal.
+ */
+template<class Matrix, class SymmGroup>
+block_matrix<Matrix, SymmGroup>
+cbe_sketch(block_matrix<Matrix, SymmGroup> const & P,
+           std::map<typename SymmGroup::charge, std::size_t> const & sizes, unsigned seed)
+{
+    boost::mt19937 rng(seed);
+    boost::normal_distribution<double> normal;
+    block_matrix<Matrix, SymmGroup> ret;
+    for (std::size_t k = 0; k < P.n_blocks(); ++k) {
+        auto it = sizes.find(P.basis().left_charge(k));
+        if (it == sizes.end())
+            continue;
+        Matrix G(num_cols(P[k]), it->second), tmp(num_rows(P[k]), it->second);
+        for (std::size_t j = 0; j < num_cols(G); ++j)
+            for (std::size_t i = 0; i < num_rows(G); ++i)
+                G(i, j) = normal(rng);
+        gemm(P[k], G, tmp);
+        tmp *= 1./std::sqrt(static_cast<double>(it->second));
+        ret.match_and_add_block(tmp, it->first, it->first);
+    }
+    return ret;
+}
+
+/**
+ * @brief Truncates the MPS enriched with the sketch of the perturbation.
+ *
+ * The sketch [Y] is first projected on the orthogonal complement of the range of [A], then
+ * the SVD of [A | sqrt(alpha) Y] is truncated. The left singular vectors span the expanded basis.
+ */
+template<class Matrix, class SymmGroup, class Gemm>
+truncation_results cbe_truncate(block_matrix<Matrix, SymmGroup> const & A, block_matrix<Matrix, SymmGroup> Y,
+                                double alpha, double cutoff, std::size_t Mmax, bool verbose,
+                                block_matrix<Matrix, SymmGroup> & U)
+{
+    block_matrix<Matrix, SymmGroup> Q, V, tmp, projection;
+    block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> S;
+    svd_truncate(A, Q, V, S, 1.0E-12, A.left_basis().sum_of_sizes(), false);
+    typename Gemm::gemm()(transpose(conjugate(Q)), Y, tmp);
+    typename Gemm::gemm()(Q, tmp, projection);
+    Y -= projection;
+    Y *= std::sqrt(alpha);
+    block_matrix<Matrix, SymmGroup> X;
+    for (std::size_t k = 0; k < A.n_blocks(); ++k) {
+        typename SymmGroup::charge lc = A.basis().left_charge(k), rc = A.basis().right_charge(k);
+        Matrix block = A[k];
+        std::size_t y = Y.find_block(lc, lc);
+        if (lc == rc && y < Y.n_blocks()) {
+            std::size_t m = num_cols(block);
+            block.resize(num_rows(block), m + num_cols(Y[y]));
+            for (std::size_t j = 0; j < num_cols(Y[y]); ++j)
+                for (std::size_t i = 0; i < num_rows(block); ++i)
+                    block(i, m+j) = Y[y](i, j);
+        }
+        X.insert_block(block, lc, rc);
+    }
+    return svd_truncate(X, U, V, S, cutoff, Mmax, verbose);
+}
+
+} // namespace detail
+
 template<class Matrix, class OtherMatrix, class SymmGroup, class Gemm, class Kernel>
 static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
 predict_new_state_l2r_sweep(MPSTensor<Matrix, SymmGroup> const & mps, MPOTensor<Matrix, SymmGroup> const & mpo,
@@ -55,6 +145,56 @@ predict_new_state_l2r_sweep(MPSTensor<Matrix, SymmGroup> const & mps, MPOTensor<
     return std::make_pair(ret, trunc);
 }
 
+/**
+ * @brief Controlled bond expansion of the MPS for a left-to-right sweep.
+ *
+ * Cheaper alternative to the perturbed density matrix of [predict_new_state_l2r_sweep].
+ * Each component of the perturbation (one per MPO bond index) is folded into a randomized sketch
+ * as soon as it is available, so that neither the full boundary-MPS product nor the density
+ * matrices are stored. The sketch is projected out of the range of the MPS and used to enrich
+ * the bond before the SVD truncation.
+ *
+ * @param expansionRatio number of sketched states, relative to the current bond dimension of each block.
+ */
+template<class Matrix, class OtherMatrix, class SymmGroup, class Gemm, class Kernel>
+static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+predict_expanded_state_l2r_sweep(MPSTensor<Matrix, SymmGroup> const & mps, MPOTensor<Matrix, SymmGroup> const & mpo,
+                                 Boundary<OtherMatrix, SymmGroup> const & left, Boundary<OtherMatrix, SymmGroup> const & right,
+                                 double alpha, double cutoff, std::size_t Mmax, double expansionRatio, bool verbose=false)
+{
+    typedef typename SymmGroup::charge charge;
+    typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+    mps.make_left_paired();
+    MPSTensor<Matrix, SymmGroup> ret = mps;
+    std::map<charge, std::size_t> sizes = detail::cbe_sketch_sizes(mps.data(), expansionRatio);
+    block_matrix<Matrix, SymmGroup> U, sketch;
+    if (!sizes.empty()) {
+        Index<SymmGroup> physical_i = mps.site_dim(), left_i = mps.row_dim(), right_i = mps.col_dim(),
+                         out_left_i = physical_i * left_i;
+        // The product may change the pairing of its input, so that it works on a copy
+        MPSTensor<Matrix, SymmGroup> ket = mps;
+        BoundaryMPSProduct<Matrix, OtherMatrix, SymmGroup, Gemm> t(ket, left, mpo, left_i);
+        std::shared_ptr<const FusedBasis<SymmGroup> > out_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+        ProductBasis<SymmGroup> const & out_left_pb = out_left_fb->offsets();
+        std::shared_ptr<const FusedBasis<SymmGroup> > in_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+        ProductBasis<SymmGroup> const & in_right_pb = in_right_fb->offsets();
+        unsigned seed = dmrg_random::engine();
+        omp_for(index_type b2, parallel::range<index_type>(0,mpo.col_dim()), {
+            ContractionGrid<Matrix, SymmGroup> contr_grid(mpo, 0, 0);
+            Kernel()(b2, contr_grid, left, t, mpo, ket.data().basis(), ket.data().basis(),
+                     right_i, out_left_i, in_right_pb, out_left_pb, true);
+            block_matrix<Matrix, SymmGroup> tmp = detail::cbe_sketch(contr_grid(0,0), sizes, seed + b2);
+            contr_grid(0,0).clear();
+            parallel_critical
+            for (std::size_t k = 0; k < tmp.n_blocks(); ++k)
+                sketch.match_and_add_block(tmp[k], tmp.basis().left_charge(k), tmp.basis().right_charge(k));
+        });
+    }
+    truncation_results trunc = detail::cbe_truncate<Matrix, SymmGroup, Gemm>(mps.data(), sketch, alpha, cutoff, Mmax, verbose, U);
+    ret.replace_left_paired(U);
+    return std::make_pair(ret, trunc);
+}
+
 template<class Matrix, class OtherMatrix, class SymmGroup, class Gemm>
 static block_matrix<Matrix, SymmGroup>
 getZeroSiteTensorL2R(MPSTensor<Matrix, SymmGroup> mpsNextSite, const MPSTensor<Matrix, SymmGroup>& mpsCurrentSite,
@@ -122,6 +262,50 @@ predict_new_state_r2l_sweep(MPSTensor<Matrix, SymmGroup> const & mps, MPOTensor<
     return std::make_pair(ret, trunc);
 }
 
+/**
+ * @brief Controlled bond expansion of the MPS for a right-to-left sweep.
+ *
+ * Same as [predict_expanded_state_l2r_sweep], applied to the adjoint of the right-paired MPS.
+ */
+template<class Matrix, class OtherMatrix, class SymmGroup, class Gemm, class Kernel>
+static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+predict_expanded_state_r2l_sweep(MPSTensor<Matrix, SymmGroup> const & mps, MPOTensor<Matrix, SymmGroup> const & mpo,
+                                 Boundary<OtherMatrix, SymmGroup> const & left, Boundary<OtherMatrix, SymmGroup> const & right,
+                                 double alpha, double cutoff, std::size_t Mmax, double expansionRatio, bool verbose=false)
+{
+    typedef typename SymmGroup::charge charge;
+    typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+    mps.make_right_paired();
+    MPSTensor<Matrix, SymmGroup> ret = mps;
+    block_matrix<Matrix, SymmGroup> A = transpose(conjugate(mps.data()));
+    std::map<charge, std::size_t> sizes = detail::cbe_sketch_sizes(A, expansionRatio);
+    block_matrix<Matrix, SymmGroup> U, sketch;
+    if (!sizes.empty()) {
+        MPSTensor<Matrix, SymmGroup> ket = mps;
+        MPSBoundaryProduct<Matrix, OtherMatrix, SymmGroup, Gemm> t(ket, right, mpo);
+        Index<SymmGroup> physical_i = mps.site_dim(), left_i = mps.row_dim(), right_i = mps.col_dim(),
+                         out_right_i = adjoin(physical_i) * right_i;
+        std::shared_ptr<const FusedBasis<SymmGroup> > in_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+        ProductBasis<SymmGroup> const & in_left_pb = in_left_fb->offsets();
+        std::shared_ptr<const FusedBasis<SymmGroup> > out_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+        ProductBasis<SymmGroup> const & out_right_pb = out_right_fb->offsets();
+        unsigned seed = dmrg_random::engine();
+        omp_for(index_type b1, parallel::range<index_type>(0,mpo.row_dim()), {
+            block_matrix<Matrix, SymmGroup> component;
+            Kernel()(b1, component, right, t, mpo, ket.data().basis(), ket.data().basis(),
+                     left_i, out_right_i, in_left_pb, out_right_pb, true);
+            block_matrix<Matrix, SymmGroup> componentAdjoint = transpose(conjugate(component));
+            block_matrix<Matrix, SymmGroup> tmp = detail::cbe_sketch(componentAdjoint, sizes, seed + b1);
+            parallel_critical
+            for (std::size_t k = 0; k < tmp.n_blocks(); ++k)
+                sketch.match_and_add_block(tmp[k], tmp.basis().left_charge(k), tmp.basis().right_charge(k));
+        });
+    }
+    truncation_results trunc = detail::cbe_truncate<Matrix, SymmGroup, Gemm>(A, sketch, alpha, cutoff, Mmax, verbose, U);
+    ret.replace_right_paired(adjoint(U));
+    return std::make_pair(ret, trunc);
+}
+
 template<class Matrix, class OtherMatrix, class SymmGroup, class Gemm>
 static block_matrix<Matrix, SymmGroup>
 getZeroSiteTensorR2L(MPSTensor<Matrix, SymmGroup> mpsPreviousSite,
@@ -226,8 +226,8 @@ namespace SU2 {
             if (otasks.size() == 0) continue;
             Matrix buf(otasks[0].l_size, out_right_i.size_of_block(it->first.second));
 
-            for (typename std::vector<micro_task>::const_iterator it2 = otasks.begin(); it2 != otasks.end(); ++it2)
-                detail::task_axpy(*it2, &buf(0,0), &t.at(it2->b2)[it2->k](0,0) + it2->in_offset);
+            detail::task_axpy_fused(otasks.cbegin(), otasks.cend(), &buf(0,0),
+                                    [&t](micro_task const & task) { return &t.at(task.b2)[task.k](0,0) + task.in_offset; });
 
             ret.insert_block(buf, it->first.first, it->first.second);
         }
@@ -290,8 +290,8 @@ namespace SU2 {
 
             size_t k = left_b1.basis().position(it->first.second, it->first.first); if (k == left_b1.basis().size()) continue;
 
-            for (typename std::vector<micro_task>::const_iterator it2 = otasks.begin(); it2 != otasks.end(); ++it2)
-                detail::task_axpy(*it2, &buf(0,0), &t.at(it2->b2)[it2->k](0,0) + it2->in_offset);
+            detail::task_axpy_fused(otasks.cbegin(), otasks.cend(), &buf(0,0),
+                                    [&t](micro_task const & task) { return &t.at(task.b2)[task.k](0,0) + task.in_offset; });
 
             charge_gemm(left_b1[k], buf, prod, it->first.second, phases[k]);
         }
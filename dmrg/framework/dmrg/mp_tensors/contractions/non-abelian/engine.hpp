@@ -24,6 +24,11 @@ namespace contraction {
 using ::contraction::common::BoundaryMPSProduct;
 using ::contraction::common::MPSBoundaryProduct;
 
+namespace SU2 {
+    template<class Matrix, class OtherMatrix, class SymmGroup>
+    class SiteHamilPlan;
+}
+
 template <class Matrix, class OtherMatrix, class SymmGroup>
 class Engine<Matrix, OtherMatrix, SymmGroup, symm_traits::enable_if_su2_t<SymmGroup>>
 {
@@ -136,6 +141,18 @@ public:
                (mps, mpo, left, right, alpha, cutoff, Mmax, perturbDM, verbose);
     }
 
+    static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+    predict_expanded_state_l2r_sweep(MPSTensor<Matrix, SymmGroup> const & mps,
+                                     MPOTensor<Matrix, SymmGroup> const & mpo,
+                                     Boundary<OtherMatrix, SymmGroup> const & left,
+                                     Boundary<OtherMatrix, SymmGroup> const & right,
+                                     double alpha, double cutoff, std::size_t Mmax,
+                                     double expansionRatio, bool verbose)
+    {
+        return common::predict_expanded_state_l2r_sweep<Matrix, OtherMatrix, SymmGroup, ::SU2::SU2Gemms, lbtm_functor>
+               (mps, mpo, left, right, alpha, cutoff, Mmax, expansionRatio, verbose);
+    }
+
     static MPSTensor<Matrix, SymmGroup>
     predict_lanczos_l2r_sweep(MPSTensor<Matrix, SymmGroup> B,
                               MPSTensor<Matrix, SymmGroup> const & psi,
@@ -164,6 +181,18 @@ public:
                (mps, mpo, left, right, alpha, cutoff, Mmax, perturbDM, verbose);
     }
 
+    static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+    predict_expanded_state_r2l_sweep(MPSTensor<Matrix, SymmGroup> const & mps,
+                                     MPOTensor<Matrix, SymmGroup> const & mpo,
+                                     Boundary<OtherMatrix, SymmGroup> const & left,
+                                     Boundary<OtherMatrix, SymmGroup> const & right,
+                                     double alpha, double cutoff, std::size_t Mmax,
+                                     double expansionRatio, bool verbose)
+    {
+        return common::predict_expanded_state_r2l_sweep<Matrix, OtherMatrix, SymmGroup, ::SU2::SU2Gemms, rbtm_functor>
+               (mps, mpo, left, right, alpha, cutoff, Mmax, expansionRatio, verbose);
+    }
+
     static MPSTensor<Matrix, SymmGroup>
     predict_lanczos_r2l_sweep(MPSTensor<Matrix, SymmGroup> B,
                               MPSTensor<Matrix, SymmGroup> const & psi,
@@ -194,6 +223,9 @@ public:
         return common::generate_right_mpo_basis<Matrix, OtherMatrix, SymmGroup, ::SU2::SU2Gemms, rbtm_functor>(bra_tensor, ket_tensor, right, mpo);
     }
 
+    /** @brief Sigma vector contraction precompiled for a given site, see [SU2::SiteHamilPlan] */
+    typedef SU2::SiteHamilPlan<Matrix, OtherMatrix, SymmGroup> site_hamil_plan;
+
     static MPSTensor<Matrix, SymmGroup>
     site_hamil2(MPSTensor<Matrix, SymmGroup> ket_tensor,
                 Boundary<OtherMatrix, SymmGroup> const & left, Boundary<OtherMatrix, SymmGroup> const & right,
@@ -220,15 +252,17 @@ public:
 
     static block_matrix<Matrix, SymmGroup>
     diagonal_hamiltonian(Boundary<OtherMatrix, SymmGroup> const & left, Boundary<OtherMatrix, SymmGroup> const & right,
-                         MPOTensor<Matrix, SymmGroup> const & mpo, MPSTensor<Matrix, SymmGroup> const & x)
+                         MPOTensor<Matrix, SymmGroup> const & mpo, MPSTensor<Matrix, SymmGroup> const & x,
+                         bool reuse=false)
     {
-        return contraction::SU2::diagonal_hamiltonian(left, right, mpo, x);
+        return contraction::SU2::diagonal_hamiltonian(left, right, mpo, x, reuse);
     }
 };
 
 } // namespace contraction
 
 #include "dmrg/mp_tensors/contractions/non-abelian/site_hamil.hpp"
+#include "dmrg/mp_tensors/contractions/non-abelian/site_hamil_plan.hpp"
 #include "dmrg/mp_tensors/contractions/non-abelian/zero_site_hamil.hpp"
 
 #endif
@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#include <cstddef>
+
+// GCC generates one clone of the kernel per target and dispatches at load time, based on the CPU.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define MICRO_KERNEL_TARGETS __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define MICRO_KERNEL_TARGETS
+#endif
+
+namespace contraction {
+namespace SU2 {
+namespace detail {
+
+    MICRO_KERNEL_TARGETS
+    void strided_multi_axpy(std::size_t l_size, std::size_t r_size, std::size_t n_tasks, double const * scales,
+                            double const * const * sources, std::size_t const * stripes, double * out)
+    {
+        for (std::size_t rr = 0; rr < r_size; ++rr)
+        {
+            double * __restrict__ o = out + rr*l_size;
+            std::size_t t = 0;
+            // Four tasks per sweep over the output column
+            for ( ; t + 4 <= n_tasks; t += 4)
+            {
+                double const * __restrict__ s0 = sources[t]   + stripes[t]*rr;
+                double const * __restrict__ s1 = sources[t+1] + stripes[t+1]*rr;
+                double const * __restrict__ s2 = sources[t+2] + stripes[t+2]*rr;
+                double const * __restrict__ s3 = sources[t+3] + stripes[t+3]*rr;
+                double a0 = scales[t], a1 = scales[t+1], a2 = scales[t+2], a3 = scales[t+3];
+                for (std::size_t i = 0; i < l_size; ++i)
+                    o[i] += a0*s0[i] + a1*s1[i] + a2*s2[i] + a3*s3[i];
+            }
+            for ( ; t < n_tasks; ++t)
+            {
+                double const * __restrict__ s0 = sources[t] + stripes[t]*rr;
+                double a0 = scales[t];
+                for (std::size_t i = 0; i < l_size; ++i)
+                    o[i] += a0*s0[i];
+            }
+        }
+    }
+
+} // namespace detail
+} // namespace SU2
+} // namespace contraction
@@ -15,31 +15,58 @@ namespace contraction {
 namespace SU2 {
 namespace detail {
 
+    /** @brief Non-zero element of a sparse site operator, scaled by the coupling coefficient of its spin case */
+    template <typename T>
+    struct scaled_element
+    {
+        std::size_t ss1, ss2;
+        T alfa;
+    };
+
+    /**
+     * @brief Collects the elements of the w_block-th block of W, scaled by the coupling coefficients.
+     *
+     * The spin case of each element is resolved once here, instead of being recomputed in the
+     * innermost loops of the kernels below.
+     */
+    template<class Matrix, class SymmGroup>
+    std::vector<scaled_element<typename Matrix::value_type> >
+    scaled_elements(typename operator_selector<Matrix, SymmGroup>::type const & W, std::size_t w_block,
+                    typename Matrix::value_type couplings[])
+    {
+        auto blocks = W.get_sparse().block(w_block);
+        std::vector<scaled_element<typename Matrix::value_type> > ret;
+        ret.reserve(std::distance(blocks.first, blocks.second));
+        for (auto it = blocks.first; it != blocks.second; ++it)
+        {
+            std::size_t casenr = 0;
+            if (it->row_spin == 2 && it->col_spin == 2) casenr = 3;
+            else if (it->row_spin == 2) casenr = 1;
+            else if (it->col_spin == 2) casenr = 2;
+            scaled_element<typename Matrix::value_type> element;
+            element.ss1 = it->row;
+            element.ss2 = it->col;
+            element.alfa = it->coefficient * couplings[casenr];
+            ret.push_back(element);
+        }
+        return ret;
+    }
+
 
     template<class Matrix, class SymmGroup>
     void lbtm(Matrix const & iblock, Matrix & oblock, typename operator_selector<Matrix, SymmGroup>::type const & W,
               std::size_t in_right_offset, std::size_t out_left_offset, std::size_t l_size, std::size_t r_size, std::size_t w_block,
               typename Matrix::value_type couplings[])
     {
-        auto blocks = W.get_sparse().block(w_block);
+        auto elements = scaled_elements<Matrix, SymmGroup>(W, w_block, couplings);
 
         for(size_t rr = 0; rr < r_size; ++rr) {
-            for (auto it = blocks.first; it != blocks.second; ++it)
+            for (auto it = elements.begin(); it != elements.end(); ++it)
             {
-                std::size_t ss1 = it->row;
-                std::size_t ss2 = it->col;
-                std::size_t rspin = it->row_spin;
-                std::size_t cspin = it->col_spin;
-                std::size_t casenr = 0;
-                if (rspin == 2 && cspin == 2) casenr = 3;
-                else if (rspin == 2) casenr = 1;
-                else if (cspin == 2) casenr = 2;
-
-                typename Matrix::value_type alfa_t = it->coefficient * couplings[casenr];
-                maquis::dmrg::detail::iterator_axpy(&iblock(0, in_right_offset + ss1*r_size + rr),
-                                                    &iblock(0, in_right_offset + ss1*r_size + rr) + l_size,
-                                                    &oblock(out_left_offset + ss2*l_size, rr),
-                                                    alfa_t);
+                maquis::dmrg::detail::iterator_axpy(&iblock(0, in_right_offset + it->ss1*r_size + rr),
+                                                    &iblock(0, in_right_offset + it->ss1*r_size + rr) + l_size,
+                                                    &oblock(out_left_offset + it->ss2*l_size, rr),
+                                                    it->alfa);
             }
         }
     }
@@ -50,50 +77,28 @@ namespace detail {
                                  std::size_t in_right_offset, std::size_t out_right_offset, std::size_t l_size, std::size_t r_size, std::size_t w_block,
                                  typename Matrix::value_type couplings[])
     {
-        auto blocks = W.get_sparse().block(w_block);
+        auto elements = scaled_elements<Matrix, SymmGroup>(W, w_block, couplings);
 
         const size_t chunk = 1024;
         const size_t blength = r_size*l_size;
         for(size_t rr = 0; rr < blength/chunk; ++rr) {
-            for (auto it = blocks.first; it != blocks.second; ++it)
+            for (auto it = elements.begin(); it != elements.end(); ++it)
             {
-                std::size_t ss1 = it->row;
-                std::size_t ss2 = it->col;
-                std::size_t rspin = it->row_spin;
-                std::size_t cspin = it->col_spin;
-                std::size_t casenr = 0;
-                if (rspin == 2 && cspin == 2) casenr = 3;
-                else if (rspin == 2) casenr = 1;
-                else if (cspin == 2) casenr = 2;
-
-                typename Matrix::value_type alfa_t = it->coefficient * couplings[casenr];
-
                 assert(rr + chunk <= r_size*l_size);
-                maquis::dmrg::detail::iterator_axpy(&iblock(0, in_right_offset + ss1*r_size) + rr*chunk,
-                                                    &iblock(0, in_right_offset + ss1*r_size) + rr*chunk + chunk,
-                                                    &oblock(0, out_right_offset + ss2*r_size) + rr*chunk,
-                                                    alfa_t);
+                maquis::dmrg::detail::iterator_axpy(&iblock(0, in_right_offset + it->ss1*r_size) + rr*chunk,
+                                                    &iblock(0, in_right_offset + it->ss1*r_size) + rr*chunk + chunk,
+                                                    &oblock(0, out_right_offset + it->ss2*r_size) + rr*chunk,
+                                                    it->alfa);
             }
         }
 
-        for (auto it = blocks.first; it != blocks.second; ++it)
+        std::size_t start = blength - blength%chunk;
+        for (auto it = elements.begin(); it != elements.end(); ++it)
         {
-            std::size_t ss1 = it->row;
-            std::size_t ss2 = it->col;
-            std::size_t rspin = it->row_spin;
-            std::size_t cspin = it->col_spin;
-            std::size_t casenr = 0;
-            if (rspin == 2 && cspin == 2) casenr = 3;
-            else if (rspin == 2) casenr = 1;
-            else if (cspin == 2) casenr = 2;
-
-            typename Matrix::value_type alfa_t = it->coefficient * couplings[casenr];
-
-            std::size_t start = blength - blength%chunk;
-            maquis::dmrg::detail::iterator_axpy(&iblock(0, in_right_offset + ss1*r_size) + start,
-                                                &iblock(0, in_right_offset + ss1*r_size) + blength,
-                                                &oblock(0, out_right_offset + ss2*r_size) + start,
-                                                alfa_t);
+            maquis::dmrg::detail::iterator_axpy(&iblock(0, in_right_offset + it->ss1*r_size) + start,
+                                                &iblock(0, in_right_offset + it->ss1*r_size) + blength,
+                                                &oblock(0, out_right_offset + it->ss2*r_size) + start,
+                                                it->alfa);
         }
     }
 
@@ -102,25 +107,15 @@ namespace detail {
                          std::size_t in_left_offset, std::size_t out_right_offset, std::size_t l_size, std::size_t r_size, std::size_t w_block,
                          typename Matrix::value_type couplings[])
     {
-        auto blocks = W.get_sparse().block(w_block);
+        auto elements = scaled_elements<Matrix, SymmGroup>(W, w_block, couplings);
 
         for (size_t rr = 0; rr < r_size; ++rr) {
-            for (auto it = blocks.first; it != blocks.second; ++it)
+            for (auto it = elements.begin(); it != elements.end(); ++it)
             {
-                std::size_t ss1 = it->row;
-                std::size_t ss2 = it->col;
-                std::size_t rspin = it->row_spin;
-                std::size_t cspin = it->col_spin;
-                std::size_t casenr = 0;
-                if (rspin == 2 && cspin == 2) casenr = 3;
-                else if (rspin == 2) casenr = 1;
-                else if (cspin == 2) casenr = 2;
-
-                typename Matrix::value_type alfa_t = it->coefficient * couplings[casenr];
-                maquis::dmrg::detail::iterator_axpy(&iblock(in_left_offset + ss1*l_size, rr),
-                                                    &iblock(in_left_offset + ss1*l_size, rr) + l_size,
-                                                    &oblock(0, out_right_offset + ss2*r_size + rr),
-                                                    alfa_t);
+                maquis::dmrg::detail::iterator_axpy(&iblock(in_left_offset + it->ss1*l_size, rr),
+                                                    &iblock(in_left_offset + it->ss1*l_size, rr) + l_size,
+                                                    &oblock(0, out_right_offset + it->ss2*r_size + rr),
+                                                    it->alfa);
             }
         }
     }
@@ -142,7 +137,8 @@ namespace detail {
     {
         bool operator ()(micro_task<T> const & t1, micro_task<T> const & t2)
         {
-            return t1.out_offset < t2.out_offset;
+            // Tasks writing to the same output stripe end up next to each other, see [task_axpy_fused]
+            return t1.out_offset < t2.out_offset || (t1.out_offset == t2.out_offset && t1.r_size < t2.r_size);
         }
     };
 
@@ -155,25 +151,15 @@ namespace detail {
                     size_t in_offset,
                     size_t r_size_cache, size_t r_size, size_t out_right_offset)
     {
-        auto blocks = W.get_sparse().block(w_block);
-        for (auto it = blocks.first; it != blocks.second; ++it)
+        auto elements = scaled_elements<Matrix, SymmGroup>(W, w_block, couplings);
+        for (auto it = elements.begin(); it != elements.end(); ++it)
         {
             micro_task<typename Matrix::value_type> task = tpl;
-
-            std::size_t ss1 = it->row;
-            std::size_t ss2 = it->col;
-            std::size_t rspin = it->row_spin;
-            std::size_t cspin = it->col_spin;
-            std::size_t casenr = 0;
-            if (rspin == 2 && cspin == 2) casenr = 3;
-            else if (rspin == 2) casenr = 1;
-            else if (cspin == 2) casenr = 2;
-
             //task.source = source + ss1*tpl.l_size;
-            task.in_offset = in_offset + ss1*tpl.l_size;
-            task.scale = it->coefficient * couplings[casenr];
+            task.in_offset = in_offset + it->ss1*tpl.l_size;
+            task.scale = it->alfa;
             task.r_size = r_size_cache;
-            task.out_offset = out_right_offset + ss2*r_size;
+            task.out_offset = out_right_offset + it->ss2*r_size;
             tasks.push_back(task);
         }
     }
@@ -197,6 +183,60 @@ namespace detail {
         }
     }
 
+    /**
+     * @brief Strided multi-axpy, out(:, rr) += sum_t scales[t] * sources[t][stripes[t]*rr + (0:l_size)]
+     *
+     * This is the inner kernel of [task_axpy_fused]: the output columns are loaded and stored once for
+     * all the tasks sharing them, instead of once per task.
+     * The double precision overload is compiled in micro_kernels.cpp for several instruction sets,
+     * and the version matching the CPU is selected at runtime.
+     */
+    template <typename T>
+    void strided_multi_axpy(std::size_t l_size, std::size_t r_size, std::size_t n_tasks, T const * scales,
+                            T const * const * sources, std::size_t const * stripes, T * out)
+    {
+        for (std::size_t rr = 0; rr < r_size; ++rr)
+            for (std::size_t t = 0; t < n_tasks; ++t)
+                for (std::size_t i = 0; i < l_size; ++i)
+                    out[rr*l_size + i] += scales[t] * sources[t][stripes[t]*rr + i];
+    }
+
+    void strided_multi_axpy(std::size_t l_size, std::size_t r_size, std::size_t n_tasks, double const * scales,
+                            double const * const * sources, std::size_t const * stripes, double * out);
+
+    /**
+     * @brief Executes a list of micro tasks sorted with [task_compare].
+     *
+     * Consecutive tasks with the same output offset and column count write the same output stripe,
+     * and are fused into a single call to [strided_multi_axpy].
+     * Equivalent to calling [task_axpy] for each task, up to the order of the floating point sums.
+     *
+     * @param source functor returning the address of the first input element of a task
+     */
+    template <typename T, class Iterator, class Source>
+    void task_axpy_fused(Iterator begin, Iterator end, T * oblock, Source source)
+    {
+        // Scratch buffers, reused across calls
+        static thread_local std::vector<T> scales;
+        static thread_local std::vector<T const *> sources;
+        static thread_local std::vector<std::size_t> stripes;
+        for (Iterator it = begin; it != end; )
+        {
+            scales.clear();
+            sources.clear();
+            stripes.clear();
+            Iterator group_end = it;
+            for ( ; group_end != end && group_end->out_offset == it->out_offset && group_end->r_size == it->r_size; ++group_end) {
+                scales.push_back(group_end->scale);
+                sources.push_back(source(*group_end));
+                stripes.push_back(group_end->stripe);
+            }
+            strided_multi_axpy(it->l_size, it->r_size, scales.size(), scales.data(), sources.data(), stripes.data(),
+                               oblock + it->out_offset * it->l_size);
+            it = group_end;
+        }
+    }
+
 } // namespace detail
 } // namespace SU2
 } // namespace contraction
@@ -8,8 +8,30 @@
 #ifndef CONTRACTIONS_SU2_SITE_HAMIL_HPP
 #define CONTRACTIONS_SU2_SITE_HAMIL_HPP
 
+#include "dmrg/utils/parallel/work_stealing.hpp"
+
 namespace contraction {
 
+namespace SU2 {
+
+    /** @brief Adds the blocks of [partial] to [acc], used to merge the per-thread sigma vector contributions */
+    template<class Matrix, class SymmGroup>
+    void merge_blocks(block_matrix<Matrix, SymmGroup> & acc, block_matrix<Matrix, SymmGroup> & partial)
+    {
+        for (std::size_t k = 0; k < partial.n_blocks(); ++k)
+            acc.match_and_add_block(partial[k], partial.basis().left_charge(k), partial.basis().right_charge(k));
+        partial.clear();
+    }
+
+    /** @brief Cost estimate for the contraction of the MPO row/column [proxy], i.e. its number of operator terms */
+    template<class Proxy>
+    double proxy_cost(Proxy const & proxy)
+    {
+        return std::distance(proxy.begin(), proxy.end());
+    }
+
+} // namespace SU2
+
 // forward declarations
 template<class Matrix, class OtherMatrix, class SymmGroup>
 MPSTensor<Matrix, SymmGroup>
@@ -71,10 +93,10 @@ site_hamil_lbtm(MPSTensor<Matrix, SymmGroup> ket_tensor, MPSTensor<Matrix, SymmG
     Index<SymmGroup> out_left_i = physical_i * left_i;
     Index<SymmGroup> right_i_bra = bra_tensor.col_dim();
     common_subset(out_left_i, right_i_bra);
-    ProductBasis<SymmGroup> out_left_pb(physical_i, left_i);
-    ProductBasis<SymmGroup> in_right_pb(physical_i, right_i,
-                            boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                    -boost::lambda::_1, boost::lambda::_2));
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+    ProductBasis<SymmGroup> const & out_left_pb = out_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+    ProductBasis<SymmGroup> const & in_right_pb = in_right_fb->offsets();
     bra_tensor.make_right_paired();
     Index<SymmGroup> indexForTrim = bra_tensor.data().left_basis(); 
     contraction::common::BoundaryMPSProduct<Matrix, OtherMatrix, SymmGroup, ::SU2::SU2Gemms> t(ket_tensor, left, mpo, indexForTrim, isHermitian);
@@ -112,7 +134,12 @@ site_hamil_lbtm(MPSTensor<Matrix, SymmGroup> ket_tensor, MPSTensor<Matrix, SymmG
         parallel::sync();
 
 #else
-    omp_for(index_type b2, parallel::range<index_type>(0,loop_max), {
+    std::vector<double> costs(loop_max);
+    for (index_type b2 = 0; b2 < loop_max; ++b2)
+        costs[b2] = SU2::proxy_cost(mpo.column(b2));
+    parallel::work_stealing_executor executor(costs);
+    std::vector<block_matrix<Matrix, SymmGroup> > partials(executor.num_threads());
+    executor.run([&](std::size_t b2, int thread) {
         ContractionGrid<Matrix, SymmGroup> contr_grid(mpo, 0, 0);
         block_matrix<Matrix, SymmGroup> tmp, tmp2;
         typename MPOTensor<OtherMatrix, SymmGroup>::col_proxy cp = mpo.column(b2);
@@ -138,10 +165,10 @@ site_hamil_lbtm(MPSTensor<Matrix, SymmGroup> ket_tensor, MPSTensor<Matrix, SymmG
                 if (!out_left_i.has(tmp.basis().left_charge(k)))
                     tmp.remove_block(k--);
         }
-        parallel_critical
-        for (std::size_t k = 0; k < tmp.n_blocks(); ++k)
-            ret.data().match_and_add_block(tmp[k], tmp.basis().left_charge(k), tmp.basis().right_charge(k));
+        SU2::merge_blocks(partials[thread], tmp);
     });
+    parallel::tree_reduce(partials, SU2::merge_blocks<Matrix, SymmGroup>);
+    swap(ret.data(), partials[0]);
 #endif
     return ret;
 }
@@ -165,17 +192,21 @@ site_hamil_rbtm(MPSTensor<Matrix, SymmGroup> ket_tensor, MPSTensor<Matrix, SymmG
                      out_right_i = adjoin(physical_i) * right_i;
     Index<SymmGroup> left_i_ket = ket_tensor.row_dim();
     common_subset(out_right_i, left_i_ket);
-    ProductBasis<SymmGroup> in_left_pb(physical_i, left_i);
-    ProductBasis<SymmGroup> out_right_pb(physical_i, right_i,
-                                         boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
-                                            -boost::lambda::_1, boost::lambda::_2));
-    block_matrix<Matrix, SymmGroup> collector;
+    std::shared_ptr<const FusedBasis<SymmGroup> > in_left_fb = FusedBasis<SymmGroup>::get(physical_i, left_i);
+    ProductBasis<SymmGroup> const & in_left_pb = in_left_fb->offsets();
+    std::shared_ptr<const FusedBasis<SymmGroup> > out_right_fb = FusedBasis<SymmGroup>::get(physical_i, right_i, true);
+    ProductBasis<SymmGroup> const & out_right_pb = out_right_fb->offsets();
     MPSTensor<Matrix, SymmGroup> ret;
     ret.phys_i = bra_tensor.site_dim();
     ret.left_i = bra_tensor.row_dim();
     ret.right_i = bra_tensor.col_dim();
     index_type loop_max = mpo.row_dim();
-    omp_for(index_type b1, parallel::range<index_type>(0,loop_max), {
+    std::vector<double> costs(loop_max);
+    for (index_type b1 = 0; b1 < loop_max; ++b1)
+        costs[b1] = SU2::proxy_cost(mpo.row(b1));
+    parallel::work_stealing_executor executor(costs);
+    std::vector<block_matrix<Matrix, SymmGroup> > partials(executor.num_threads());
+    executor.run([&](std::size_t b1, int thread) {
         block_matrix<Matrix, SymmGroup> tmp, tmp2;
         SU2::task_capsule<Matrix, SymmGroup> tasks_cap;
         SU2::rbtm_tasks(b1, t, mpo, ket_tensor.data().basis(), left_i, out_right_i, in_left_pb, out_right_pb, tasks_cap);
@@ -192,11 +223,10 @@ site_hamil_rbtm(MPSTensor<Matrix, SymmGroup> ket_tensor, MPSTensor<Matrix, SymmG
         //else
         //    ::SU2::gemm_trim(transpose(left[b1]), tmp, tmp2, std::vector<value_type>(tmp.n_blocks(), 1.), false);
         //tmp.clear();
-        parallel_critical
-        for (std::size_t k = 0; k < tmp2.n_blocks(); ++k)
-            collector.match_and_add_block(tmp2[k], tmp2.basis().left_charge(k), tmp2.basis().right_charge(k));
+        SU2::merge_blocks(partials[thread], tmp2);
     });
-    reshape_right_to_left_new(physical_i, left_i, right_i, collector, ret.data());
+    parallel::tree_reduce(partials, SU2::merge_blocks<Matrix, SymmGroup>);
+    reshape_right_to_left_new(physical_i, left_i, right_i, partials[0], ret.data());
     DualIndex<SymmGroup> kb2 = ket_tensor.data().basis();
     if (!(kb1 == kb2))
         throw std::runtime_error("XX\n");
@@ -0,0 +1,356 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef CONTRACTIONS_SU2_SITE_HAMIL_PLAN_HPP
+#define CONTRACTIONS_SU2_SITE_HAMIL_PLAN_HPP
+
+#include <memory>
+#include <mutex>
+#include <boost/type_traits/is_complex.hpp>
+
+namespace contraction {
+namespace SU2 {
+
+/**
+ * @brief Precompiled contraction plan for the SU2 sigma vector.
+ *
+ * During the optimization of a given site, site_hamil2 is called many times with the same
+ * boundaries and MPO tensor, and with vectors having the same block structure. Only the
+ * values of the vector change between two calls.
+ * The plan collects everything that depends only on the block structure -- the product bases,
+ * the transposed MPS basis, the conjugation phases and, for the rbtm kernel, the flattened and
+ * sorted list of micro tasks together with the matching blocks of the left boundary.
+ * All these quantities are generated by the first call to [apply], subsequent calls only
+ * execute the contraction.
+ *
+ * The plan is recompiled if it is called with different boundaries, a different MPO tensor,
+ * or with a vector whose (left-paired) block structure differs from the one used to build it.
+ * Compilation is serialized, so that the plan can be shared among threads.
+ *
+ * [apply_batch] calculates the sigma vectors of several tensors sharing the same block structure
+ * (e.g. the trial vectors of a block Davidson iteration) with a single pass over the boundaries:
+ * each block of the boundary is contracted with all the vectors of the batch before moving on.
+ */
+template<class Matrix, class OtherMatrix, class SymmGroup>
+class SiteHamilPlan
+{
+    typedef typename SymmGroup::charge charge;
+    typedef typename Matrix::value_type value_type;
+    typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+    typedef typename task_capsule<Matrix, SymmGroup>::map_t map_t;
+    typedef typename task_capsule<Matrix, SymmGroup>::micro_task micro_task;
+    typedef Boundary<OtherMatrix, SymmGroup> boundary_type;
+
+    /** @brief Output block of the rbtm kernel for a given b1 */
+    struct rbtm_block
+    {
+        charge lc, rc;
+        std::size_t l_size, r_size;
+        // Position of the matching block of the left boundary
+        std::size_t left_block;
+        value_type phase;
+        // Tasks sorted by output offset
+        std::vector<micro_task> tasks;
+    };
+
+public:
+    SiteHamilPlan() : left_(nullptr), right_(nullptr), mpo_(nullptr), isHermitian_(true), compiled_(false) { }
+
+    /** @brief Calculates the sigma vector, compiling the plan if required */
+    MPSTensor<Matrix, SymmGroup> apply(MPSTensor<Matrix, SymmGroup> ket_tensor, boundary_type const & left,
+                                       boundary_type const & right, MPOTensor<Matrix, SymmGroup> const & mpo,
+                                       bool isHermitian=true)
+    {
+        std::vector<MPSTensor<Matrix, SymmGroup> > kets(1);
+        kets[0].swap_with(ket_tensor);
+        return apply_batch(kets, left, right, mpo, isHermitian)[0];
+    }
+
+    /** @brief Calculates the sigma vectors of a batch of tensors, compiling the plan if required */
+    std::vector<MPSTensor<Matrix, SymmGroup> > apply_batch(std::vector<MPSTensor<Matrix, SymmGroup> > kets, boundary_type const & left,
+                                                           boundary_type const & right, MPOTensor<Matrix, SymmGroup> const & mpo,
+                                                           bool isHermitian=true)
+    {
+        std::vector<MPSTensor<Matrix, SymmGroup> > ret;
+        if (kets.empty())
+            return ret;
+#ifdef USE_AMBIENT
+        for (std::size_t n = 0; n < kets.size(); ++n)
+            ret.push_back(site_hamil_rbtm(kets[n], kets[n], left, right, mpo, isHermitian));
+        return ret;
+#else
+        for (std::size_t n = 0; n < kets.size(); ++n)
+            kets[n].make_left_paired();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!matches(kets[0], left, right, mpo, isHermitian))
+                compile(kets[0], left, right, mpo, isHermitian);
+        }
+        // Tensors with a different block structure cannot share the plan, they are processed one at a time
+        for (std::size_t n = 1; n < kets.size(); ++n)
+            if (!matches(kets[n], left, right, mpo, isHermitian)) {
+                for (std::size_t m = 0; m < kets.size(); ++m)
+                    ret.push_back(apply(kets[m], left, right, mpo, isHermitian));
+                return ret;
+            }
+        if (lbtm_)
+            return apply_lbtm(kets, left, right, mpo);
+        else
+            return apply_rbtm(kets, left, right, mpo);
+#endif
+    }
+
+private:
+    /** @brief Checks whether the plan has been compiled for the given input */
+    bool matches(MPSTensor<Matrix, SymmGroup> const & ket_tensor, boundary_type const & left, boundary_type const & right,
+                 MPOTensor<Matrix, SymmGroup> const & mpo, bool isHermitian) const
+    {
+        return compiled_ && left_ == &left && right_ == &right && mpo_ == &mpo && isHermitian_ == isHermitian
+               && phys_i_ == ket_tensor.site_dim() && left_i_ == ket_tensor.row_dim() && right_i_ == ket_tensor.col_dim()
+               && ket_basis_ == ket_tensor.data().basis();
+    }
+
+    /** @brief Generates all the quantities that depend only on the block structure */
+    void compile(MPSTensor<Matrix, SymmGroup> ket_tensor, boundary_type const & left, boundary_type const & right,
+                 MPOTensor<Matrix, SymmGroup> const & mpo, bool isHermitian)
+    {
+        left_ = &left;
+        right_ = &right;
+        mpo_ = &mpo;
+        isHermitian_ = isHermitian;
+        ket_basis_ = ket_tensor.data().basis();
+        phys_i_ = ket_tensor.site_dim();
+        left_i_ = ket_tensor.row_dim();
+        right_i_ = ket_tensor.col_dim();
+        lbtm_ = (mpo.row_dim() - mpo.num_one_rows()) < (mpo.col_dim() - mpo.num_one_cols());
+        rbtm_blocks_.clear();
+        conj_left_.clear();
+        right_phases_.clear();
+        costs_.clear();
+        if (lbtm_)
+            compile_lbtm(ket_tensor, right, mpo);
+        else
+            compile_rbtm(ket_tensor, left, right, mpo);
+        compiled_ = true;
+    }
+
+    void compile_lbtm(MPSTensor<Matrix, SymmGroup> & ket_tensor, boundary_type const & right,
+                      MPOTensor<Matrix, SymmGroup> const & mpo)
+    {
+        out_i_ = phys_i_ * left_i_;
+        Index<SymmGroup> right_i_bra = right_i_;
+        common_subset(out_i_, right_i_bra);
+        out_pb_ = std::make_shared<ProductBasis<SymmGroup> >(phys_i_, left_i_);
+        in_pb_ = std::make_shared<ProductBasis<SymmGroup> >(phys_i_, right_i_,
+                     boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
+                                         -boost::lambda::_1, boost::lambda::_2));
+        ket_tensor.make_right_paired();
+        trim_i_ = ket_tensor.data().left_basis();
+        ket_basis_transpose_ = ket_tensor.data().basis();
+        for (std::size_t i = 0; i < ket_basis_transpose_.size(); ++i) {
+            std::swap(ket_basis_transpose_[i].lc, ket_basis_transpose_[i].rc);
+            std::swap(ket_basis_transpose_[i].ls, ket_basis_transpose_[i].rs);
+        }
+        right_phases_.resize(mpo.col_dim());
+        costs_.resize(mpo.col_dim());
+        for (index_type b2 = 0; b2 < mpo.col_dim(); ++b2) {
+            costs_[b2] = proxy_cost(mpo.column(b2));
+            if (mpo.herm_info.right_skip(b2) && isHermitian_)
+                right_phases_[b2] = ::contraction::common::conjugate_phases(adjoint(right[mpo.herm_info.right_conj(b2)]),
+                                                                            mpo, b2, false, true);
+        }
+    }
+
+    void compile_rbtm(MPSTensor<Matrix, SymmGroup> & ket_tensor, boundary_type const & left, boundary_type const & right,
+                      MPOTensor<Matrix, SymmGroup> const & mpo)
+    {
+        out_i_ = adjoin(phys_i_) * right_i_;
+        Index<SymmGroup> left_i_ket = left_i_;
+        common_subset(out_i_, left_i_ket);
+        in_pb_ = std::make_shared<ProductBasis<SymmGroup> >(phys_i_, left_i_);
+        out_pb_ = std::make_shared<ProductBasis<SymmGroup> >(phys_i_, right_i_,
+                      boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
+                                          -boost::lambda::_1, boost::lambda::_2));
+        trim_i_ = ket_tensor.data().left_basis();
+        // The product with the right boundary is only needed for the block structure
+        MPSBoundaryProduct<Matrix, OtherMatrix, SymmGroup, ::SU2::SU2Gemms> t(ket_tensor, right, mpo, trim_i_, isHermitian_);
+        index_type loop_max = mpo.row_dim();
+        rbtm_blocks_.resize(loop_max);
+        conj_left_.resize(loop_max);
+        costs_.resize(loop_max);
+        omp_for(index_type b1, parallel::range<index_type>(0,loop_max), {
+            task_capsule<Matrix, SymmGroup> tasks_cap;
+            rbtm_tasks(b1, t, mpo, ket_basis_, left_i_, out_i_, *in_pb_, *out_pb_, tasks_cap);
+            bool conj = mpo.herm_info.left_skip(b1) && isHermitian_;
+            if (conj)
+                compile_rbtm_blocks(b1, tasks_cap, mpo, conjugate(left[mpo.herm_info.left_conj(b1)]), left[b1]);
+            else
+                compile_rbtm_blocks(b1, tasks_cap, mpo, transpose(left[b1]), left[b1]);
+            // Real boundaries are left untouched by the conjugation, and are accessed directly
+            if (conj && boost::is_complex<value_type>::value)
+                conj_left_[b1] = conjugate(left[mpo.herm_info.left_conj(b1)]);
+        });
+    }
+
+    /** @brief Counterpart of [rbtm_axpy_gemm] that stores the tasks instead of executing them */
+    template<class TVMatrix>
+    void compile_rbtm_blocks(index_type b1, task_capsule<Matrix, SymmGroup> & tasks_cap, MPOTensor<Matrix, SymmGroup> const & mpo,
+                             block_matrix<TVMatrix, SymmGroup> const & left_b1, block_matrix<OtherMatrix, SymmGroup> const & left_orig)
+    {
+        std::vector<value_type> phases = (mpo.herm_info.left_skip(b1)) ? ::contraction::common::conjugate_phases(left_b1, mpo, b1, true, false)
+                                                                       : std::vector<value_type>(left_b1.n_blocks(), 1.);
+        for (typename map_t::iterator it = tasks_cap.tasks.begin(); it != tasks_cap.tasks.end(); ++it)
+        {
+            std::vector<micro_task> & otasks = it->second;
+            if (otasks.size() == 0) continue;
+            std::size_t k = left_b1.basis().position(it->first.second, it->first.first);
+            if (k == left_b1.basis().size()) continue;
+            rbtm_block block;
+            block.lc = it->first.first;
+            block.rc = it->first.second;
+            block.l_size = otasks[0].l_size;
+            block.r_size = out_i_.size_of_block(block.rc);
+            block.phase = phases[k];
+            // For the transposed boundary, store the position of the block in the non-transposed one
+            block.left_block = (mpo.herm_info.left_skip(b1) && isHermitian_) ? k : left_orig.basis().position(block.lc, block.rc);
+            std::sort(otasks.begin(), otasks.end(), detail::task_compare<value_type>());
+            block.tasks.swap(otasks);
+            // Flops of the axpy tasks and of the gemm with the left boundary
+            costs_[b1] += double(block.l_size) * block.r_size * (block.tasks.size() + left_b1.basis()[k].ls);
+            rbtm_blocks_[b1].push_back(std::move(block));
+        }
+    }
+
+    /** @brief Merges the per-thread partial results of a batch */
+    static void merge_batch(std::vector<block_matrix<Matrix, SymmGroup> > & acc, std::vector<block_matrix<Matrix, SymmGroup> > & partial)
+    {
+        for (std::size_t n = 0; n < acc.size(); ++n)
+            merge_blocks(acc[n], partial[n]);
+    }
+
+    std::vector<MPSTensor<Matrix, SymmGroup> > apply_rbtm(std::vector<MPSTensor<Matrix, SymmGroup> > const & kets, boundary_type const & left,
+                                                          boundary_type const & right, MPOTensor<Matrix, SymmGroup> const & mpo) const
+    {
+        typedef MPSBoundaryProduct<Matrix, OtherMatrix, SymmGroup, ::SU2::SU2Gemms> product_type;
+        std::size_t nvec = kets.size();
+        std::vector<std::unique_ptr<product_type> > t(nvec);
+        for (std::size_t n = 0; n < nvec; ++n)
+            t[n].reset(new product_type(kets[n], right, mpo, trim_i_, isHermitian_));
+        parallel::work_stealing_executor executor(costs_);
+        std::vector<std::vector<block_matrix<Matrix, SymmGroup> > > partials(executor.num_threads(),
+                                                                              std::vector<block_matrix<Matrix, SymmGroup> >(nvec));
+        executor.run([&](std::size_t b1, int thread) {
+            std::vector<block_matrix<Matrix, SymmGroup> > tmp(nvec);
+            bool conj = mpo.herm_info.left_skip(b1) && isHermitian_;
+            block_matrix<OtherMatrix, SymmGroup> const & conj_left_b1 = boost::is_complex<value_type>::value ? conj_left_[b1]
+                                                                        : left[conj ? mpo.herm_info.left_conj(b1) : b1];
+            for (typename std::vector<rbtm_block>::const_iterator it = rbtm_blocks_[b1].begin(); it != rbtm_blocks_[b1].end(); ++it)
+            {
+                for (std::size_t n = 0; n < nvec; ++n)
+                {
+                    product_type & tn = *t[n];
+                    Matrix buf(it->l_size, it->r_size);
+                    detail::task_axpy_fused(it->tasks.cbegin(), it->tasks.cend(), &buf(0,0),
+                                            [&tn](micro_task const & task) { return &tn.at(task.b2)[task.k](0,0) + task.in_offset; });
+                    if (conj)
+                        charge_gemm(conj_left_b1[it->left_block], buf, tmp[n], it->rc, it->phase);
+                    else
+                        charge_gemm(transpose(left[b1][it->left_block]), buf, tmp[n], it->rc, it->phase);
+                }
+            }
+            for (std::size_t n = 0; n < nvec; ++n) {
+                t[n]->free(b1);
+                merge_blocks(partials[thread][n], tmp[n]);
+            }
+        });
+        parallel::tree_reduce(partials, merge_batch);
+        std::vector<MPSTensor<Matrix, SymmGroup> > ret(nvec);
+        for (std::size_t n = 0; n < nvec; ++n) {
+            ret[n].phys_i = phys_i_;
+            ret[n].left_i = left_i_;
+            ret[n].right_i = right_i_;
+            ReshapePlan<SymmGroup>::get(true, phys_i_, left_i_, right_i_, partials[0][n].basis())->apply(partials[0][n], ret[n].data());
+        }
+        return ret;
+    }
+
+    std::vector<MPSTensor<Matrix, SymmGroup> > apply_lbtm(std::vector<MPSTensor<Matrix, SymmGroup> > const & kets, boundary_type const & left,
+                                                          boundary_type const & right, MPOTensor<Matrix, SymmGroup> const & mpo) const
+    {
+        typedef BoundaryMPSProduct<Matrix, OtherMatrix, SymmGroup, ::SU2::SU2Gemms> product_type;
+        std::size_t nvec = kets.size();
+        std::vector<std::unique_ptr<product_type> > t(nvec);
+        for (std::size_t n = 0; n < nvec; ++n)
+            t[n].reset(new product_type(kets[n], left, mpo, trim_i_, isHermitian_));
+        parallel::work_stealing_executor executor(costs_);
+        std::vector<std::vector<block_matrix<Matrix, SymmGroup> > > partials(executor.num_threads(),
+                                                                              std::vector<block_matrix<Matrix, SymmGroup> >(nvec));
+        executor.run([&](std::size_t b2, int thread) {
+            typename MPOTensor<OtherMatrix, SymmGroup>::col_proxy cp = mpo.column(b2);
+            index_type num_ops = std::distance(cp.begin(), cp.end());
+            bool conj = mpo.herm_info.right_skip(b2) && isHermitian_;
+            for (std::size_t n = 0; n < nvec; ++n)
+            {
+                ContractionGrid<Matrix, SymmGroup> contr_grid(mpo, 0, 0);
+                block_matrix<Matrix, SymmGroup> tmp, tmp2;
+                if (num_ops > 3) {
+                    lbtm_kernel_rp(b2, contr_grid, left, *t[n], mpo, ket_basis_transpose_, right_i_, out_i_, *in_pb_, *out_pb_);
+                    reshape_right_to_left_new(phys_i_, left_i_, right_i_, contr_grid(0,0), tmp2);
+                    contr_grid(0,0).clear();
+                    swap(contr_grid(0,0), tmp2);
+                }
+                else {
+                    lbtm_kernel(b2, contr_grid, left, *t[n], mpo, ket_basis_transpose_, right_i_, out_i_, *in_pb_, *out_pb_);
+                }
+                if (conj)
+                    ::SU2::gemm_trim(contr_grid(0,0), adjoint(right[mpo.herm_info.right_conj(b2)]), tmp, right_phases_[b2], false);
+                else
+                    ::SU2::gemm_trim(contr_grid(0,0), right[b2], tmp, std::vector<value_type>(contr_grid(0,0).n_blocks(), 1.), true);
+                contr_grid(0,0).clear();
+                if (num_ops > 3) {
+                    for (std::size_t k = 0; k < tmp.n_blocks(); ++k)
+                        if (!out_i_.has(tmp.basis().left_charge(k)))
+                            tmp.remove_block(k--);
+                }
+                merge_blocks(partials[thread][n], tmp);
+            }
+        });
+        parallel::tree_reduce(partials, merge_batch);
+        std::vector<MPSTensor<Matrix, SymmGroup> > ret(nvec);
+        for (std::size_t n = 0; n < nvec; ++n) {
+            ret[n].phys_i = phys_i_;
+            ret[n].left_i = left_i_;
+            ret[n].right_i = right_i_;
+            swap(ret[n].data(), partials[0][n]);
+        }
+        return ret;
+    }
+
+    // Input for which the plan has been compiled
+    boundary_type const * left_;
+    boundary_type const * right_;
+    MPOTensor<Matrix, SymmGroup> const * mpo_;
+    bool isHermitian_, compiled_, lbtm_;
+    DualIndex<SymmGroup> ket_basis_;
+    // Index objects shared by both kernels
+    Index<SymmGroup> phys_i_, left_i_, right_i_, out_i_, trim_i_;
+    std::shared_ptr<ProductBasis<SymmGroup> > in_pb_, out_pb_;
+    // lbtm-specific data
+    DualIndex<SymmGroup> ket_basis_transpose_;
+    std::vector<std::vector<value_type> > right_phases_;
+    // rbtm-specific data
+    std::vector<std::vector<rbtm_block> > rbtm_blocks_;
+    std::vector<block_matrix<OtherMatrix, SymmGroup> > conj_left_;
+    // Estimated cost of each MPO row (rbtm) or column (lbtm), used to schedule the threads
+    std::vector<double> costs_;
+    std::mutex mutex_;
+};
+
+} // namespace SU2
+} // namespace contraction
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef EXPVAL_BOUNDARY_CACHE_H
+#define EXPVAL_BOUNDARY_CACHE_H
+
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mpo.h"
+#include "dmrg/mp_tensors/boundary.h"
+#include "dmrg/mp_tensors/contractions.h"
+#include "dmrg/mp_tensors/mps_mpo_ops.h"
+
+/**
+ * @brief Cache of the partial contractions of <bra|ket> used to evaluate many local expectation values.
+ *
+ * Operators such as the ones entering n-RDMs act non-trivially only on a window [first, last] of
+ * the lattice, and their MPOs are a string of identities outside of this window.
+ * All these operators share the same left environment up to site first, and the same right
+ * environment starting from site last+1.
+ * This class stores these environments and reuses them for all the operators, so that only the
+ * sites within the window are contracted for each operator, instead of the full lattice.
+ *
+ * The environments are generated lazily, from the MPO tensors of the first operator that requires them.
+ * The identity strings must therefore be identical (also in the MPO bond indexing) for all the operators
+ * that are evaluated with the same cache, which is the case for all MPOs generated by the same
+ * MPO maker (TaggedMPOMaker or sign_and_fill).
+ *
+ * Within the window, the environment of each prefix [first, p] is kept as well, and is reused by
+ * the next operator with the same first site and the same MPO tensors on [first, p] (up to a scalar
+ * factor, for the tensors with a single entry), so that consecutive operators that differ only
+ * on their last sites only contract these sites.
+ * Operators that are evaluated alternately (e.g. the spin components of the same RDM element)
+ * should use different streams, so that each keeps its own prefix.
+ *
+ * Note that the class is not thread-safe. Each thread should work with its own copy (which also
+ * copies the MPSs, exactly as for the expval-based measurements).
+ */
+template<class Matrix, class SymmGroup>
+class ExpvalBoundaryCache
+{
+    using boundary_type = Boundary<Matrix, SymmGroup>;
+    using contr = contraction::Engine<Matrix, Matrix, SymmGroup>;
+    using value_type = typename Matrix::value_type;
+
+public:
+    /** @brief Class constructor from the bra and the ket */
+    ExpvalBoundaryCache(MPS<Matrix, SymmGroup> const & bra, MPS<Matrix, SymmGroup> const & ket)
+        : bra_(bra), ket_(ket), L_(bra.length())
+    {
+        assert(bra_.length() == ket_.length());
+        left_.push_back(mps_mpo_detail::mixed_left_boundary(bra_, ket_));
+        right_.push_back(mps_mpo_detail::mixed_right_boundary(bra_, ket_));
+    }
+
+    /**
+     * @brief Calculates <bra|mpo|ket> for an operator that is non-trivial only on [first, last].
+     * @param mpo Input MPO
+     * @param first first site on which the operator is not the identity
+     * @param last last site on which the operator is not the identity
+     * @param stream index of the window prefix that is reused
+     * @return Matrix::value_type <bra|mpo|ket>
+     */
+    value_type expval(MPO<Matrix, SymmGroup> const & mpo, int first, int last, std::size_t stream = 0)
+    {
+        assert(mpo.length() == L_);
+        assert(first >= 0 && first <= last && last < L_);
+        extend_left(mpo, first);
+        extend_right(mpo, last+1);
+        if (windows_.size() <= stream)
+            windows_.resize(stream+1);
+        window & w = windows_[stream];
+        if (w.first != first) {
+            w.first = first;
+            w.tensors.clear();
+            w.envs.clear();
+        }
+        // Longest prefix of the window shared with the previous operator of this stream. The stored
+        // tensors and environments of this prefix are kept as they are, and differ by [factor].
+        value_type factor = 1.;
+        std::size_t shared = 0;
+        while (shared < w.tensors.size() && first+shared <= last
+               && proportional(mpo[first+shared], w.tensors[shared], factor))
+            ++shared;
+        w.tensors.erase(w.tensors.begin()+shared, w.tensors.end());
+        w.envs.erase(w.envs.begin()+shared, w.envs.end());
+        for (int p = first+shared; p <= last; ++p) {
+            boundary_type const & previous = (p == first) ? left_[first] : w.envs.back();
+            boundary_type next = contr::overlap_mpo_left_step(bra_[p], ket_[p], previous, mpo[p], false);
+            w.envs.push_back(std::move(next));
+            w.tensors.push_back(mpo[p]);
+        }
+        value_type ret = factor * mps_mpo_detail::join(w.envs[last-first], right_[L_-last-1]);
+        if (mpo.getCoreEnergy() != 0.)
+            ret += mpo.getCoreEnergy()*::overlap(bra_, ket_);
+        return ret;
+    }
+
+private:
+    /** @brief Environments of the prefixes [first, first+i] of a window, with the MPO tensors that generated them */
+    struct window
+    {
+        window() : first(-1) { }
+        int first;
+        std::vector<MPOTensor<Matrix, SymmGroup> > tensors;
+        std::vector<boundary_type> envs;
+    };
+
+    /**
+     * @brief Checks if [a] is [b] times a scalar, which is then multiplied into [factor].
+     *
+     * Tensors with more than one entry are only matched when equal. The operators are compared by
+     * tag, so that the tensors must come from MPOs built with the same TagHandler.
+     */
+    static bool proportional(MPOTensor<Matrix, SymmGroup> const & a, MPOTensor<Matrix, SymmGroup> const & b, value_type & factor)
+    {
+        if (a.get_operator_table() != b.get_operator_table() || a.row_dim() != b.row_dim() || a.col_dim() != b.col_dim()
+            || a.row_spin_dim() != b.row_spin_dim() || a.col_spin_dim() != b.col_spin_dim())
+            return false;
+        bool single = (a.row_dim() == 1 && a.col_dim() == 1);
+        for (std::size_t r = 0; r < a.row_dim(); ++r)
+            for (std::size_t c = 0; c < a.col_dim(); ++c) {
+                if (a.has(r, c) != b.has(r, c))
+                    return false;
+                if (!a.has(r, c))
+                    continue;
+                auto ta = a.at(r, c);
+                auto tb = b.at(r, c);
+                if (ta.size() != tb.size())
+                    return false;
+                single = single && ta.size() == 1;
+                for (std::size_t i = 0; i < ta.size(); ++i)
+                    if (a.tag_number(r, c, i) != b.tag_number(r, c, i) || (!single && ta.scale(i) != tb.scale(i)))
+                        return false;
+                if (single) {
+                    if (tb.scale() == value_type(0.))
+                        return false;
+                    factor *= ta.scale() / tb.scale();
+                }
+            }
+        return true;
+    }
+
+    /** @brief Generates the left environments up to site p (excluded) */
+    void extend_left(MPO<Matrix, SymmGroup> const & mpo, int p)
+    {
+        for (int i = left_.size()-1; i < p; ++i)
+            left_.push_back(contr::overlap_mpo_left_step(bra_[i], ket_[i], left_[i], mpo[i], false));
+    }
+
+    /** @brief Generates the right environments down to site p (included). Stored in reversed order. */
+    void extend_right(MPO<Matrix, SymmGroup> const & mpo, int p)
+    {
+        for (int i = L_-right_.size()+1; i > p; --i)
+            right_.push_back(contr::overlap_mpo_right_step(bra_[i-1], ket_[i-1], right_.back(), mpo[i-1], false));
+    }
+
+    MPS<Matrix, SymmGroup> bra_, ket_;
+    int L_;
+    // left_[i] is the environment of sites [0, i), right_[i] the one of sites [L-i, L)
+    std::vector<boundary_type> left_, right_;
+    std::vector<window> windows_;
+};
+
+#endif
@@ -10,6 +10,8 @@
 
 #include <vector>
 #include <set>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include "dmrg/mp_tensors/mpotensor.h"
 
@@ -19,7 +21,7 @@ class MPO : public std::vector<MPOTensor<Matrix, SymmGroup> >
 public:
     typedef MPOTensor<Matrix, SymmGroup> elem_type;
 
-    MPO() { }
+    MPO() : core_energy(0) { }
 
     MPO(std::size_t L, elem_type elem = elem_type())
     : std::vector<elem_type>(L, elem)
@@ -56,6 +58,13 @@ public:
     void setCoreEnergy(double e) { core_energy = e; }
     double getCoreEnergy() const { return core_energy; }
 
+    // Only the tensors and the core energy are stored, the bond charges are recomputed by compress()
+    template <class Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+        ar & boost::serialization::base_object<std::vector<elem_type> >(*this) & core_energy;
+    }
+
 private:
     std::vector<std::map<std::size_t, typename SymmGroup::charge> > bond_index_charges;
     std::vector<Index<SymmGroup> > bond_indices;
@@ -387,10 +396,11 @@ class MPO<Matrix, SymmGroup, symm_traits::enable_if_su2_t<SymmGroup> >
 public:
     typedef MPOTensor<Matrix, SymmGroup> elem_type;
 
-    MPO() { }
+    MPO() : core_energy(0) { }
 
     MPO(std::size_t L, elem_type elem = elem_type())
     : std::vector<elem_type>(L, elem)
+    , core_energy(0)
     { }
 
     std::size_t length() const { return this->size(); }
@@ -403,6 +413,13 @@ public:
     void setCoreEnergy(double e) { core_energy = e; }
     double getCoreEnergy() const { return core_energy; }
 
+    // Only the tensors and the core energy are stored, the bond charges are recomputed by compress()
+    template <class Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+        ar & boost::serialization::base_object<std::vector<elem_type> >(*this) & core_energy;
+    }
+
 private:
     double core_energy;
 };
@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef MPO_CACHE_H
+#define MPO_CACHE_H
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/filesystem.hpp>
+
+#include "dmrg/mp_tensors/mpo.h"
+#include "dmrg/utils/BaseParameters.h"
+#include "dmrg/utils/content_hash.h"
+
+/**
+ * @brief On-disk cache of MPOs.
+ *
+ * The MPOs are stored with Boost.Serialization in a cache directory, in files named after a
+ * 64-bit key. The key of the Hamiltonian MPO is a hash of all the parameters which may enter
+ * its construction (model, lattice, symmetry, integrals, ...), where the integral_file enters
+ * through its content. The key of the two-site MPO is a hash of the (serialized) one-site MPO
+ * and of the physical dimensions. A stale entry can therefore never be matched, and changing
+ * any sweep-related parameter keeps the cache valid.
+ */
+namespace mpo_cache {
+
+    // Incremented whenever the MPO construction or its serialized layout changes
+    static const std::uint64_t format_version = 1;
+
+    /** @brief True for the parameters which do not affect the Hamiltonian MPO */
+    inline bool is_irrelevant(std::string const & key)
+    {
+        static const std::set<std::string> keys = {
+            "nsweeps", "ngrowsweeps", "nmainsweeps", "max_bond_dimension", "sweep_bond_dimensions",
+            "optimization", "conv_thresh", "chkpfile", "resultfile", "storagedir", "donotsave",
+            "init_type", "init_bond_dimension", "hf_occ", "seed", "chkp_each", "measure_each",
+            "n_ortho_states", "ortho_states", "mpo_cache", "integral_cache", "run_seconds"
+        };
+        static const std::vector<std::string> prefixes = {
+            "truncation_", "alpha_", "ietl_", "storage_", "MEASURE", "measure", "time_", "propagator_",
+            "TD_", "imaginary_time", "hamiltonian_units"
+        };
+        if (keys.count(key))
+            return true;
+        for (auto const & p : prefixes)
+            if (key.compare(0, p.size(), p) == 0)
+                return true;
+        return false;
+    }
+
+    /** @brief Key of the Hamiltonian MPO of a given parameter set */
+    template <class SymmGroup>
+    std::uint64_t hamiltonian_key(BaseParameters const & parms)
+    {
+        using maquis::detail::hash_combine;
+        using maquis::detail::fnv1a;
+        std::uint64_t key = hash_combine(format_version, fnv1a(typeid(SymmGroup).name()));
+        // The parameters are sorted, so that the key does not depend on the order in which they have been set
+        auto range = parms.get_range();
+        std::map<std::string, std::string> sorted(range.begin(), range.end());
+        for (auto const & kv : sorted) {
+            if (is_irrelevant(kv.first))
+                continue;
+            key = hash_combine(key, fnv1a(kv.first));
+            if (kv.first == "integral_file" && boost::filesystem::exists(kv.second))
+                key = hash_combine(key, maquis::detail::file_hash(kv.second));
+            else
+                key = hash_combine(key, maquis::detail::content_hash(kv.second.data(), kv.second.size()));
+        }
+        return key;
+    }
+
+    /** @brief Key of an MPO, from its serialized content and (optionally) the physical dimensions */
+    template <class Matrix, class SymmGroup>
+    std::uint64_t content_key(MPO<Matrix, SymmGroup> const & mpo,
+                              std::vector<Index<SymmGroup> > const & site_dims = std::vector<Index<SymmGroup> >())
+    {
+        std::ostringstream ss;
+        {
+            boost::archive::binary_oarchive oa(ss);
+            oa << mpo;
+            for (auto const & phys : site_dims)
+                for (auto const & cs : phys)
+                    oa << cs.first << cs.second;
+        }
+        std::string data = ss.str();
+        return maquis::detail::hash_combine(format_version, maquis::detail::content_hash(data.data(), data.size()));
+    }
+
+    inline std::string file_name(std::string const & dir, std::string const & prefix, std::uint64_t key)
+    {
+        std::ostringstream ss;
+        ss << prefix << "." << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+        return (boost::filesystem::path(dir) / ss.str()).string();
+    }
+
+    /** @brief Loads an MPO, returns false if the file is missing or cannot be read */
+    template <class Matrix, class SymmGroup>
+    bool load(std::string const & fp, MPO<Matrix, SymmGroup> & mpo)
+    {
+        std::ifstream ifs(fp.c_str(), std::ifstream::binary);
+        if (!ifs)
+            return false;
+        try {
+            boost::archive::binary_iarchive ia(ifs);
+            ia >> mpo;
+        }
+        catch (std::exception &) {
+            mpo = MPO<Matrix, SymmGroup>();
+            return false;
+        }
+        // The sparse representation of the operators is restored by the operator tables
+        return true;
+    }
+
+    /**
+     * @brief Stores an MPO, failures are reported but not fatal.
+     *
+     * The MPO is written to a temporary file which is then renamed, so that concurrent runs
+     * sharing the cache never load a partially written file.
+     */
+    template <class Matrix, class SymmGroup>
+    void save(std::string const & fp, MPO<Matrix, SymmGroup> const & mpo)
+    {
+        std::string tmp = fp + ".tmp" + std::to_string(::getpid());
+        try {
+            boost::filesystem::create_directories(boost::filesystem::path(fp).parent_path());
+            {
+                std::ofstream ofs(tmp.c_str(), std::ofstream::binary);
+                boost::archive::binary_oarchive oa(ofs);
+                oa << mpo;
+            }
+            boost::filesystem::rename(tmp, fp);
+        }
+        catch (std::exception & e) {
+            maquis::cout << "Could not store the MPO in " << fp << ": " << e.what() << std::endl;
+            boost::system::error_code ec;
+            boost::filesystem::remove(tmp, ec);
+        }
+    }
+
+}
+
+#endif
@@ -104,6 +104,7 @@ void cleanup_mpo_(MPO<Matrix, SymmGroup> const & in_mpo,
                 MPOTensor_detail::term_descriptor<Matrix, SymmGroup, false> o = out_mpo[t].at(get<0>(ops[t]), get<1>(ops[t]));
                 if (o.op().n_blocks() == 0) {
                     o.op()    = get<2>(ops[t]);
+                    o.op().update_sparse();
                     o.scale() = 1.;
                 }
             }
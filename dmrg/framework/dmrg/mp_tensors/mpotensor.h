@@ -8,11 +8,18 @@
 #ifndef MPOTENSOR_H
 #define MPOTENSOR_H
 
+#include <algorithm>
 #include <iostream>
 #include <set>
 #include <iterator>
 #include <boost/numeric/ublas/matrix_sparse.hpp>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/serialization/complex.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include "dmrg/block_matrix/block_matrix.h"
 #include "dmrg/block_matrix/indexing.h"
@@ -96,6 +103,57 @@ public:
     index_type num_one_cols() const;
     MPOTensor_detail::Hermitian herm_info;
 
+    // The operator table is shared by the tensors of an MPO, and stays shared upon loading.
+    // The sparse operators are not stored, they are updated by the table upon loading.
+    // The tags are stored element-wise, in column-major order, and not as (tag, scale) pairs,
+    // so that the archive does not contain the spare capacity of the compressed matrix nor
+    // the padding of the pairs.
+    template <class Archive>
+    void save(Archive & ar, const unsigned int version) const
+    {
+        std::vector<std::pair<index_type, index_type> > elements;
+        for (index_type r = 0; r < row_index.size(); ++r)
+            for (index_type c : row_index[r])
+                elements.push_back(std::make_pair(c, r));
+        std::sort(elements.begin(), elements.end());
+        std::vector<index_type> positions, sizes;
+        std::vector<tag_type> tags;
+        std::vector<value_type> scales;
+        for (auto const & e : elements) {
+            internal_value_type const & element = col_tags(e.second, e.first);
+            positions.push_back(e.second);
+            positions.push_back(e.first);
+            sizes.push_back(element.size());
+            for (auto const & pv : element) {
+                tags.push_back(pv.first);
+                scales.push_back(pv.second);
+            }
+        }
+        ar & left_i & right_i & left_spins & right_spins & row_non_zeros & col_non_zeros
+           & num_one_rows_ & num_one_cols_ & positions & sizes & tags & scales
+           & row_index & operator_table & herm_info;
+    }
+
+    template <class Archive>
+    void load(Archive & ar, const unsigned int version)
+    {
+        std::vector<index_type> positions, sizes;
+        std::vector<tag_type> tags;
+        std::vector<value_type> scales;
+        ar & left_i & right_i & left_spins & right_spins & row_non_zeros & col_non_zeros
+           & num_one_rows_ & num_one_cols_ & positions & sizes & tags & scales
+           & row_index & operator_table & herm_info;
+        col_tags = CSCMatrix(left_i, right_i);
+        for (std::size_t i = 0, offset = 0; i < sizes.size(); offset += sizes[i++]) {
+            internal_value_type element(sizes[i]);
+            for (std::size_t j = 0; j < sizes[i]; ++j)
+                element[j] = std::make_pair(tags[offset+j], scales[offset+j]);
+            col_tags(positions[2*i], positions[2*i+1]) = element;
+        }
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
 private:
     index_type left_i, right_i;
     spin_index left_spins, right_spins;
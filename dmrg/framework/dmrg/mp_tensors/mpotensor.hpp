@@ -33,8 +33,8 @@ MPOTensor<Matrix, SymmGroup>::MPOTensor(index_type ld, index_type rd, prempo_t t
                 std::swap(element, new_element);
             }
         }
-        for (std::size_t i = 0; i < operator_table->size(); ++i)
-            operator_table->operator[](i).update_sparse();
+        // The sparse representation of the operators is updated by the operator table when they are
+        // registered, the table is not modified here as it can be shared with other threads.
     }
     else {
         // Initialize a private operator table
@@ -153,7 +153,7 @@ template<class Matrix, class SymmGroup>
 void MPOTensor<Matrix, SymmGroup>::set(index_type li, index_type ri, op_t const & op, value_type scale_){
     if (this->has(li, ri)) {
         (*col_tags.find_element(li, ri))[0].second = scale_;
-        (*operator_table)[(*col_tags.find_element(li, ri))[0].first] = op;
+        operator_table->replace((*col_tags.find_element(li, ri))[0].first, op);
     }
     else {
         tag_type new_tag = operator_table->register_op(op);
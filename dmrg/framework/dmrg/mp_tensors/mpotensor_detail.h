@@ -154,6 +154,12 @@ namespace MPOTensor_detail
         int left_phase(std::size_t i) const { return LeftPhase[i]; }
         int right_phase(std::size_t i) const { return RightPhase[i]; }
 
+        template <class Archive>
+        void serialize(Archive & ar, const unsigned int version)
+        {
+            ar & LeftHerm & RightHerm & LeftPhase & RightPhase;
+        }
+
     private:
         std::vector<index_type> LeftHerm;
         std::vector<index_type> RightHerm;
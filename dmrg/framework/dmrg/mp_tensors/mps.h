@@ -82,6 +82,20 @@ public:
                                       std::size_t l, double alpha,
                                       double cutoff, std::size_t Mmax,
                                       bool perturbDM, bool verbose);
+    template<class OtherMatrix>
+    truncation_results expand_l2r_sweep(MPOTensor<Matrix, SymmGroup> const & mpo,
+                                        Boundary<OtherMatrix, SymmGroup> const & left,
+                                        Boundary<OtherMatrix, SymmGroup> const & right,
+                                        std::size_t l, double alpha,
+                                        double cutoff, std::size_t Mmax,
+                                        double expansionRatio, bool verbose);
+    template<class OtherMatrix>
+    truncation_results expand_r2l_sweep(MPOTensor<Matrix, SymmGroup> const & mpo,
+                                        Boundary<OtherMatrix, SymmGroup> const & left,
+                                        Boundary<OtherMatrix, SymmGroup> const & right,
+                                        std::size_t l, double alpha,
+                                        double cutoff, std::size_t Mmax,
+                                        double expansionRatio, bool verbose);
 
     Boundary<Matrix, SymmGroup> left_boundary() const;
     Boundary<Matrix, SymmGroup> right_boundary() const;
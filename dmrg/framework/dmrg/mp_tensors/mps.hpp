@@ -239,6 +239,38 @@ MPS<Matrix, SymmGroup>::grow_r2l_sweep(MPOTensor<Matrix, SymmGroup> const & mpo,
     return trunc;
 }
 
+template<class Matrix, class SymmGroup>
+template<class OtherMatrix>
+truncation_results
+MPS<Matrix, SymmGroup>::expand_l2r_sweep(MPOTensor<Matrix, SymmGroup> const & mpo, Boundary<OtherMatrix, SymmGroup> const & left,
+                                         Boundary<OtherMatrix, SymmGroup> const & right, std::size_t l, double alpha,
+                                         double cutoff, std::size_t Mmax, double expansionRatio, bool verbose)
+{ // canonized_i invalided through (*this)[]
+    using Contractor = typename contraction::Engine<Matrix, OtherMatrix, SymmGroup>;
+    MPSTensor<Matrix, SymmGroup> new_mps;
+    truncation_results trunc;
+    boost::tie(new_mps, trunc) = Contractor::predict_expanded_state_l2r_sweep((*this)[l], mpo, left, right, alpha, cutoff, Mmax, expansionRatio, verbose);
+    (*this)[l+1] = Contractor::predict_lanczos_l2r_sweep((*this)[l+1], (*this)[l], new_mps);
+    (*this)[l] = new_mps;
+    return trunc;
+}
+
+template<class Matrix, class SymmGroup>
+template<class OtherMatrix>
+truncation_results
+MPS<Matrix, SymmGroup>::expand_r2l_sweep(MPOTensor<Matrix, SymmGroup> const & mpo, Boundary<OtherMatrix, SymmGroup> const & left,
+                                         Boundary<OtherMatrix, SymmGroup> const & right, std::size_t l, double alpha,
+                                         double cutoff, std::size_t Mmax, double expansionRatio, bool verbose)
+{ // canonized_i invalided through (*this)[]
+    using Contractor = typename contraction::Engine<Matrix, OtherMatrix, SymmGroup>;
+    MPSTensor<Matrix, SymmGroup> new_mps;
+    truncation_results trunc;
+    boost::tie(new_mps, trunc) = Contractor::predict_expanded_state_r2l_sweep((*this)[l], mpo, left, right, alpha, cutoff, Mmax, expansionRatio, verbose);
+    (*this)[l-1] = Contractor::predict_lanczos_r2l_sweep((*this)[l-1], (*this)[l], new_mps);
+    (*this)[l] = new_mps;
+    return trunc;
+}
+
 template<class Matrix, class SymmGroup>
 Boundary<Matrix, SymmGroup>
 MPS<Matrix, SymmGroup>::left_boundary() const
@@ -0,0 +1,256 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef MPS_CI_EXPANSION_H
+#define MPS_CI_EXPANSION_H
+
+#include <algorithm>
+#include <complex>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "dmrg/block_matrix/indexing.h"
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/utils/parallel/work_stealing.hpp"
+
+/**
+ * @brief Expansion of an MPS in the basis of the occupation vectors (determinants).
+ *
+ * The coefficient of a determinant (s_1, ..., s_L) is the product of the matrices A_1^{s_1} ... A_L^{s_L}.
+ * The class extracts, once for all, the matrix A_p^{s} associated with each physical charge s and
+ * each left sector of every site, so that the coefficient of a determinant only requires L
+ * vector-matrix products.
+ *
+ * Many determinants are evaluated together by sorting them lexicographically, i.e. by visiting
+ * the prefix trie of the determinants in depth-first order. Consecutive determinants share the
+ * partial product of their common prefix, so that only the sites after the first difference
+ * are contracted. The sorted list is split in contiguous chunks, one per thread.
+ *
+ * The class also supports the perfect sampling of the determinants with probability |c|^2
+ * (see Ferris and Vidal, PRB 85, 165146 (2012)). For a right-normalized MPS, the probability
+ * of a prefix (s_1, ..., s_p) is the squared norm of the row vector A_1^{s_1} ... A_p^{s_p}, so
+ * that the determinants can be drawn site by site from the conditional probabilities.
+ *
+ * Note that determinants are given as the vector of the physical charges of each site, and that
+ * the class stores a copy of all the MPS tensors.
+ */
+template<class Matrix, class SymmGroup>
+class MPSCIExpansion
+{
+public:
+    using charge = typename SymmGroup::charge;
+    using Determinant = std::vector<charge>;
+    using value_type = typename Matrix::value_type;
+
+    /** @brief Determinant drawn by the perfect sampling, [count] times */
+    struct Sample {
+        Determinant determinant;
+        value_type coefficient;
+        std::size_t count;
+    };
+
+    /** @brief Class constructor, extracts the site matrices of each physical charge */
+    explicit MPSCIExpansion(MPS<Matrix, SymmGroup> const & mps)
+        : L_(mps.length()), blocks_(mps.length())
+    {
+        leftCharge_ = mps[0].row_dim()[0].first;
+        for (int p = 0; p < L_; ++p) {
+            mps[p].make_left_paired();
+            Index<SymmGroup> const & phys = mps[p].site_dim();
+            Index<SymmGroup> const & left = mps[p].row_dim();
+            block_matrix<Matrix, SymmGroup> const & data = mps[p].data();
+            ProductBasis<SymmGroup> leftPB(phys, left);
+            siteCharges_.push_back(std::vector<charge>());
+            for (std::size_t s = 0; s < phys.size(); ++s)
+                siteCharges_[p].push_back(phys[s].first);
+            for (std::size_t b = 0; b < data.n_blocks(); ++b) {
+                charge outSector = data.left_basis()[b].first;
+                for (std::size_t s = 0; s < phys.size(); ++s) {
+                    charge inSector = SymmGroup::fuse(outSector, -phys[s].first);
+                    if (!left.has(inSector))
+                        continue;
+                    std::size_t offset = leftPB(phys[s].first, inSector);
+                    std::size_t nRows = left.size_of_block(inSector);
+                    std::size_t nCols = data[b].num_cols();
+                    SiteBlock & siteBlock = blocks_[p][std::make_pair(phys[s].first, inSector)];
+                    siteBlock.outSector = outSector;
+                    siteBlock.matrix = Matrix(nRows, nCols);
+                    for (std::size_t i = 0; i < nRows; ++i)
+                        std::copy(data[b].row(offset+i).first, data[b].row(offset+i).second, siteBlock.matrix.row(i).first);
+                }
+            }
+        }
+    }
+
+    /** @brief Coefficient of a single determinant (zero if it does not match the symmetry of the MPS) */
+    value_type coefficient(Determinant const & det) const
+    {
+        checkLength(det);
+        Matrix product = seed();
+        charge sector = leftCharge_;
+        for (int p = 0; p < L_; ++p) {
+            Matrix next;
+            if (!multiply(p, det[p], product, sector, next, sector))
+                return value_type(0.);
+            std::swap(product, next);
+        }
+        return product(0, 0);
+    }
+
+    /**
+     * @brief Coefficients of many determinants, sharing the partial products of common prefixes.
+     * @param dets determinants, in any order
+     * @return coefficients, in the order of [dets]
+     */
+    std::vector<value_type> coefficients(std::vector<Determinant> const & dets) const
+    {
+        for (auto const & det : dets)
+            checkLength(det);
+        std::vector<value_type> ret(dets.size(), value_type(0.));
+        std::vector<std::size_t> order(dets.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&dets](std::size_t i, std::size_t j) { return dets[i] < dets[j]; });
+        int nChunks = std::max<int>(1, std::min<std::size_t>(parallel::max_threads(), dets.size()));
+        threaded_for(int iChunk = 0; iChunk < nChunks; ++iChunk) {
+            std::size_t first = dets.size()*iChunk/nChunks, last = dets.size()*(iChunk+1)/nChunks;
+            // products[p] is the product of the first p sites of the previous determinant,
+            // which is valid up to p = nValid
+            std::vector<Matrix> products(L_+1);
+            std::vector<charge> sectors(L_+1);
+            products[0] = seed();
+            sectors[0] = leftCharge_;
+            int nValid = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                Determinant const & det = dets[order[i]];
+                int p = 0;
+                if (i > first) {
+                    Determinant const & previous = dets[order[i-1]];
+                    while (p < nValid && det[p] == previous[p])
+                        ++p;
+                }
+                for (; p < L_; ++p)
+                    if (!multiply(p, det[p], products[p], sectors[p], products[p+1], sectors[p+1]))
+                        break;
+                nValid = p;
+                if (p == L_)
+                    ret[order[i]] = products[L_](0, 0);
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Perfect sampling of the determinants.
+     *
+     * The [nSamples] draws are distributed over the prefix trie with multinomial draws, so that
+     * each prefix is contracted once, regardless of how many samples go through it.
+     * The MPS must be right-normalized (e.g., with MPS::normalize_right), but not necessarily
+     * with unit norm.
+     *
+     * @param nSamples number of draws
+     * @param generator uniform random number generator
+     * @return distinct determinants that have been drawn, with their coefficient and number of draws
+     */
+    template<class Generator>
+    std::vector<Sample> sample(std::size_t nSamples, Generator & generator) const
+    {
+        std::vector<Sample> ret;
+        Determinant prefix(L_);
+        if (nSamples > 0)
+            sampleSubtree(0, leftCharge_, seed(), nSamples, prefix, generator, ret);
+        return ret;
+    }
+
+private:
+    /** @brief Matrix of a site for a given physical charge and left sector */
+    struct SiteBlock {
+        charge outSector;
+        Matrix matrix;
+    };
+
+    using BlockMap = std::map<std::pair<charge, charge>, SiteBlock>;
+
+    /** @brief Product of zero sites */
+    static Matrix seed() { return Matrix(1, 1, value_type(1.)); }
+
+    void checkLength(Determinant const & det) const {
+        if (det.size() != static_cast<std::size_t>(L_))
+            throw std::runtime_error("MPSCIExpansion: length of mps != length of basis state");
+    }
+
+    /** @brief Contracts the row vector [in] with site [p], returns false if the matrix is zero by symmetry */
+    bool multiply(int p, charge siteCharge, Matrix const & in, charge inSector, Matrix & out, charge & outSector) const
+    {
+        auto it = blocks_[p].find(std::make_pair(siteCharge, inSector));
+        if (it == blocks_[p].end())
+            return false;
+        out = Matrix(in.num_rows(), it->second.matrix.num_cols());
+        gemm(in, it->second.matrix, out);
+        outSector = it->second.outSector;
+        return true;
+    }
+
+    static double squaredNorm(Matrix const & m) {
+        double ret = 0.;
+        for (std::size_t j = 0; j < m.num_cols(); ++j)
+            ret += std::norm(m(0, j));
+        return ret;
+    }
+
+    /** @brief Distributes [count] samples among the subtrees of the prefix (s_1, ..., s_p) */
+    template<class Generator>
+    void sampleSubtree(int p, charge sector, Matrix const & product, std::size_t count, Determinant & prefix,
+                       Generator & generator, std::vector<Sample> & samples) const
+    {
+        if (p == L_) {
+            samples.push_back(Sample{prefix, product(0, 0), count});
+            return;
+        }
+        std::vector<charge> childCharges, childSectors;
+        std::vector<Matrix> childProducts;
+        std::vector<double> probabilities;
+        for (auto const & siteCharge : siteCharges_[p]) {
+            Matrix next;
+            charge nextSector;
+            if (!multiply(p, siteCharge, product, sector, next, nextSector))
+                continue;
+            double probability = squaredNorm(next);
+            if (probability == 0.)
+                continue;
+            childCharges.push_back(siteCharge);
+            childSectors.push_back(nextSector);
+            childProducts.push_back(std::move(next));
+            probabilities.push_back(probability);
+        }
+        if (probabilities.empty())
+            throw std::runtime_error("MPSCIExpansion: the MPS has zero norm");
+        // Multinomial draw, as a sequence of binomial draws on the remaining probability
+        double remaining = std::accumulate(probabilities.begin(), probabilities.end(), 0.);
+        for (std::size_t k = 0; k < probabilities.size() && count > 0; ++k) {
+            std::size_t childCount = count;
+            if (k+1 < probabilities.size()) {
+                std::binomial_distribution<std::size_t> binomial(count, std::min(1., probabilities[k]/remaining));
+                childCount = binomial(generator);
+            }
+            count -= childCount;
+            remaining -= probabilities[k];
+            if (childCount == 0)
+                continue;
+            prefix[p] = childCharges[k];
+            sampleSubtree(p+1, childSectors[k], childProducts[k], childCount, prefix, generator, samples);
+        }
+    }
+
+    int L_;
+    charge leftCharge_;
+    std::vector<std::vector<charge> > siteCharges_;
+    std::vector<BlockMap> blocks_;
+};
+
+#endif
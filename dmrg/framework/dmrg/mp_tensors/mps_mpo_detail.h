@@ -38,6 +38,139 @@ mixed_right_boundary(MPS<Matrix, SymmGroup> const & bra, MPS<Matrix, SymmGroup>
     return ret;
 }
 
+/** @brief Contracts a left and a right environment defined on the same MPS bond */
+template<class Matrix, class SymmGroup>
+typename Matrix::value_type join(Boundary<Matrix, SymmGroup> const & left, Boundary<Matrix, SymmGroup> const & right)
+{
+    assert(left.aux_dim() == right.aux_dim());
+    typename Matrix::value_type ret = 0.;
+    for (std::size_t b = 0; b < left.aux_dim(); ++b) {
+        for (std::size_t k = 0; k < left[b].n_blocks(); ++k) {
+            std::size_t m = right[b].find_block(left[b].basis().left_charge(k), left[b].basis().right_charge(k));
+            if (m == right[b].n_blocks())
+                continue;
+            Matrix const & lblock = left[b][k];
+            Matrix const & rblock = right[b][m];
+            for (std::size_t c = 0; c < num_cols(lblock); ++c)
+                for (std::size_t r = 0; r < num_rows(lblock); ++r)
+                    ret += lblock(r, c) * rblock(r, c);
+        }
+    }
+    return ret;
+}
+
+/** @brief Checks if two site operators have the same blocks and the same elements */
+template<class Operator>
+bool same_operator(Operator const & a, Operator const & b)
+{
+    if (!shape_equal(a, b))
+        return false;
+    for (std::size_t k = 0; k < a.n_blocks(); ++k)
+        for (std::size_t c = 0; c < num_cols(a[k]); ++c)
+            for (std::size_t r = 0; r < num_rows(a[k]); ++r)
+                if (a[k](r, c) != b[k](r, c))
+                    return false;
+    return true;
+}
+
+/**
+ * @brief Checks if two MPO tensors represent the same operator.
+ *
+ * The operators are compared by tag when the tensors share the operator table, and by content
+ * otherwise, so that also the tensors of MPOs built independently (e.g. by different MPOMakers) match.
+ */
+template<class Matrix, class SymmGroup>
+bool same_tensor(MPOTensor<Matrix, SymmGroup> const & a, MPOTensor<Matrix, SymmGroup> const & b)
+{
+    if (&a == &b)
+        return true;
+    if (a.row_dim() != b.row_dim() || a.col_dim() != b.col_dim()
+        || a.row_spin_dim() != b.row_spin_dim() || a.col_spin_dim() != b.col_spin_dim())
+        return false;
+    bool same_table = (a.get_operator_table() == b.get_operator_table());
+    for (std::size_t r = 0; r < a.row_dim(); ++r)
+        for (std::size_t c = 0; c < a.col_dim(); ++c) {
+            if (a.has(r, c) != b.has(r, c))
+                return false;
+            if (!a.has(r, c))
+                continue;
+            auto ta = a.at(r, c);
+            auto tb = b.at(r, c);
+            if (ta.size() != tb.size())
+                return false;
+            for (std::size_t i = 0; i < ta.size(); ++i) {
+                if (ta.scale(i) != tb.scale(i))
+                    return false;
+                if (same_table && a.tag_number(r, c, i) == b.tag_number(r, c, i))
+                    continue;
+                if (!same_operator(ta.op(i), tb.op(i)))
+                    return false;
+            }
+        }
+    return true;
+}
+
+/**
+ * @brief Environments of a batch of MPOs, shared among the MPOs with the same tensors on the first sites.
+ *
+ * The MPOs are grouped site by site in a prefix tree, and the environments are generated once for
+ * each group with at least two MPOs.
+ * ret[i][s] is the environment of the first s sites of the i-th MPO (of the last s sites if
+ * [from_right] is true), for all s up to the length of the longest prefix (suffix) that the MPO
+ * shares with another MPO of the batch.
+ *
+ * @param selected only the MPOs for which selected[i] is true enter the batch, the others get no environment.
+ */
+template<class Matrix, class SymmGroup>
+std::vector<std::vector<std::shared_ptr<const Boundary<Matrix, SymmGroup> > > >
+shared_environments(MPS<Matrix, SymmGroup> const & bra, MPS<Matrix, SymmGroup> const & ket,
+                    std::vector<MPO<Matrix, SymmGroup> > const & mpos, std::vector<bool> const & selected, bool from_right)
+{
+    typedef contraction::Engine<Matrix, Matrix, SymmGroup> contr;
+    typedef std::shared_ptr<const Boundary<Matrix, SymmGroup> > boundary_ptr;
+    typedef std::pair<std::vector<std::size_t>, boundary_ptr> group;
+
+    std::size_t L = bra.length();
+    std::vector<std::vector<boundary_ptr> > ret(mpos.size());
+    std::vector<group> groups(1);
+    for (std::size_t i = 0; i < mpos.size(); ++i)
+        if (selected[i])
+            groups[0].first.push_back(i);
+    groups[0].second = std::make_shared<const Boundary<Matrix, SymmGroup> >(from_right ? mixed_right_boundary(bra, ket)
+                                                                                      : mixed_left_boundary(bra, ket));
+    for (std::size_t s = 0; s <= L && !groups.empty(); ++s) {
+        std::vector<group> next;
+        for (group const & g : groups) {
+            for (std::size_t i : g.first)
+                ret[i].push_back(g.second);
+            if (s == L)
+                continue;
+            std::size_t p = from_right ? L-1-s : s;
+            // Splits the group by the tensor on the next site
+            std::vector<std::vector<std::size_t> > classes;
+            for (std::size_t i : g.first) {
+                std::size_t c = 0;
+                while (c < classes.size() && !same_tensor(mpos[classes[c][0]][p], mpos[i][p]))
+                    ++c;
+                if (c == classes.size())
+                    classes.push_back(std::vector<std::size_t>());
+                classes[c].push_back(i);
+            }
+            for (std::vector<std::size_t> & members : classes) {
+                if (members.size() < 2)
+                    continue;
+                MPOTensor<Matrix, SymmGroup> const & tensor = mpos[members[0]][p];
+                boundary_ptr env = std::make_shared<const Boundary<Matrix, SymmGroup> >(from_right
+                    ? contr::overlap_mpo_right_step(bra[p], ket[p], *g.second, tensor, false)
+                    : contr::overlap_mpo_left_step(bra[p], ket[p], *g.second, tensor, false));
+                next.push_back(group(std::move(members), env));
+            }
+        }
+        groups.swap(next);
+    }
+    return ret;
+}
+
 } // mps_mpo_detail
 
 #endif
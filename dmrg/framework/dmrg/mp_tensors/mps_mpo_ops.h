@@ -130,6 +130,65 @@ std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> multi_expval(MPS<Matri
     return multi_expval(mps, mps, mpo);
 }
 
+/**
+ * @brief Calculates the traces of the matrix elements of a batch of MPOs in a single pass.
+ *
+ * The environments of the sites on which consecutive MPOs of the batch have the same tensors
+ * (see [mps_mpo_detail::same_tensor]) are calculated only once. The MPOs are arranged in a prefix
+ * tree from the left and, for the MPOs with a single trace, in a suffix tree from the right, so that
+ * for each MPO only the sites between the end of its shared prefix and the beginning of its shared
+ * suffix are contracted separately.
+ * For MPOs that act non-trivially on a few sites (e.g. local densities or nearest-neighbour
+ * correlation functions), the cost is a few sweeps instead of one sweep per MPO.
+ *
+ * @param bra Input MPS representing the bra
+ * @param ket Input MPS representing the ket
+ * @param mpos Input MPOs
+ * @return the traces of <bra|mpo|ket> of each MPO, as in [multi_expval] (without the core energy)
+ */
+template<class Matrix, class SymmGroup>
+std::vector<std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> > multi_expval(MPS<Matrix, SymmGroup> const & bra,
+                                                                                    MPS<Matrix, SymmGroup> const & ket,
+                                                                                    std::vector<MPO<Matrix, SymmGroup> > const & mpos)
+{
+    assert(bra.length() == ket.length());
+    std::size_t L = bra.length();
+    std::vector<bool> all(mpos.size(), true), single_trace(mpos.size());
+    for (std::size_t i = 0; i < mpos.size(); ++i) {
+        assert(mpos[i].length() == L);
+        single_trace[i] = (mpos[i][L-1].col_dim() == 1);
+    }
+    auto left = mps_mpo_detail::shared_environments(bra, ket, mpos, all, false);
+    auto right = mps_mpo_detail::shared_environments(bra, ket, mpos, single_trace, true);
+
+    std::vector<std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> > ret(mpos.size());
+    for (std::size_t i = 0; i < mpos.size(); ++i) {
+        // Sites covered by the shared prefix and by the shared suffix
+        std::size_t shared_left = left[i].size()-1;
+        std::size_t shared_right = single_trace[i] ? right[i].size()-1 : 0;
+        std::size_t bond = L - shared_right;
+        if (single_trace[i] && shared_left >= bond) {
+            ret[i].push_back(mps_mpo_detail::join(*left[i][bond], *right[i][shared_right]));
+            continue;
+        }
+        Boundary<Matrix, SymmGroup> env = *left[i][shared_left];
+        for (std::size_t p = shared_left; p < bond; ++p)
+            env = contraction::Engine<Matrix, Matrix, SymmGroup>::overlap_mpo_left_step(bra[p], ket[p], env, mpos[i][p], false);
+        if (single_trace[i])
+            ret[i].push_back(mps_mpo_detail::join(env, *right[i][shared_right]));
+        else
+            ret[i] = env.traces();
+    }
+    return ret;
+}
+
+template<class Matrix, class SymmGroup>
+std::vector<std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> > multi_expval(MPS<Matrix, SymmGroup> const & mps,
+                                                                                    std::vector<MPO<Matrix, SymmGroup> > const & mpos)
+{
+    return multi_expval(mps, mps, mpos);
+}
+
 template<class Matrix, class SymmGroup>
 double norm(MPS<Matrix, SymmGroup> const & mps)
 {
@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <memory>
 
 #include "dmrg/block_matrix/block_matrix.h"
 #include "dmrg/block_matrix/indexing.h"
@@ -26,6 +27,9 @@ static DecompMethod DefaultSolver() {return QR;} // QR or SVD
 template<class Matrix, class SymmGroup>
 class TwoSiteTensor;
 
+template<class SymmGroup>
+class ReshapePlan;
+
 template<class Matrix, class SymmGroup>
 class MPSTensor
 {
@@ -139,6 +143,8 @@ private:
     mutable block_matrix<Matrix, SymmGroup> data_;
     mutable MPSStorageLayout cur_storage;
     Indicator cur_normalization;
+    // Cached maps of the reshapes, shared among copies of the tensor
+    mutable std::shared_ptr<const ReshapePlan<SymmGroup> > to_left_plan_, to_right_plan_;
 };
 
 // this is also required by IETL
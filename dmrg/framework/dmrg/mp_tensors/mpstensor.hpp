@@ -158,9 +158,10 @@ void MPSTensor<Matrix, SymmGroup>::make_left_paired() const
     if (cur_storage == LeftPaired)
         return;
 
+    if (!to_left_plan_ || !to_left_plan_->matches(phys_i, left_i, right_i, data_.basis()))
+        to_left_plan_ = ReshapePlan<SymmGroup>::get(true, phys_i, left_i, right_i, data_.basis());
     block_matrix<Matrix, SymmGroup> tmp;
-    reshape_right_to_left_new<Matrix>(phys_i, left_i, right_i,
-                                      data(), tmp);
+    to_left_plan_->apply(data_, tmp);
     cur_storage = LeftPaired;
     swap(data_, tmp);
 
@@ -173,9 +174,10 @@ void MPSTensor<Matrix, SymmGroup>::make_right_paired() const
     if (cur_storage == RightPaired)
         return;
 
+    if (!to_right_plan_ || !to_right_plan_->matches(phys_i, left_i, right_i, data_.basis()))
+        to_right_plan_ = ReshapePlan<SymmGroup>::get(false, phys_i, left_i, right_i, data_.basis());
     block_matrix<Matrix, SymmGroup> tmp;
-    reshape_left_to_right_new<Matrix>(phys_i, left_i, right_i,
-                                      data(), tmp);
+    to_right_plan_->apply(data_, tmp);
     cur_storage = RightPaired;
     swap(data_, tmp);
 
@@ -538,6 +540,8 @@ void MPSTensor<Matrix, SymmGroup>::swap_with(MPSTensor<Matrix, SymmGroup> & b)
     swap(this->data_, b.data_);
     swap(this->cur_storage, b.cur_storage);
     swap(this->cur_normalization, b.cur_normalization);
+    swap(this->to_left_plan_, b.to_left_plan_);
+    swap(this->to_right_plan_, b.to_right_plan_);
 }
 
 template<class Matrix, class SymmGroup>
@@ -8,7 +8,10 @@
 #ifndef RESHAPE_H
 #define RESHAPE_H
 
+#include <algorithm>
 #include <map>
+#include <memory>
+#include <vector>
 #include "dmrg/block_matrix/indexing.h"
 
 template<class Matrix, class SymmGroup>
@@ -334,6 +337,163 @@ void reshape_right_to_left_new(Index<SymmGroup> const & physical_i,
     }
 }
 
+/**
+ * @brief Precomputed map of the reshape of a MPSTensor between the left- and the right-paired layout.
+ *
+ * The map depends only on the indices of the tensor and on the block structure of the input.
+ * It stores the basis of the output and, for each strided copy, the input and output blocks and
+ * offsets, so that the reshape itself is a sequence of copies without any lookup of charges, any
+ * construction of ProductBasis objects and any insertion of blocks.
+ * The plan is immutable and can therefore be shared by all the tensors with the same structure
+ * (e.g. the copies of a tensor generated by the eigensolvers).
+ */
+template<class SymmGroup>
+class ReshapePlan
+{
+public:
+    /** @brief Copy of a strided [sdim x ldim x rdim] slice from an input to an output block */
+    struct slice
+    {
+        std::size_t in_block, out_block, in_offset, out_offset, sdim, ldim, rdim;
+    };
+
+    /** @brief Builds the map of the reshape [(phys_i, left_i), right_i] --> [left_i, (-phys_i, right_i)] */
+    static std::shared_ptr<ReshapePlan> left_to_right_plan(Index<SymmGroup> const & physical_i, Index<SymmGroup> const & left_i,
+                                                      Index<SymmGroup> const & right_i, DualIndex<SymmGroup> const & in_basis)
+    {
+        typedef typename SymmGroup::charge charge;
+        std::shared_ptr<ReshapePlan> ret(new ReshapePlan(physical_i, left_i, right_i, in_basis, false));
+        ProductBasis<SymmGroup> in_left(physical_i, left_i);
+        ProductBasis<SymmGroup> out_right(physical_i, right_i,
+                                          boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
+                                                              -boost::lambda::_1, boost::lambda::_2));
+        std::vector<std::pair<charge, charge> > out_charges;
+        for (std::size_t block = 0; block < in_basis.size(); ++block)
+        {
+            std::size_t r = right_i.position(in_basis[block].rc);
+            if (r == right_i.size()) continue;
+            charge in_r_charge = right_i[r].first;
+            for (std::size_t s = 0; s < physical_i.size(); ++s)
+            {
+                std::size_t l = left_i.position(SymmGroup::fuse(in_basis[block].lc, -physical_i[s].first));
+                if (l == left_i.size()) continue;
+                charge out_l_charge = left_i[l].first;
+                charge out_r_charge = SymmGroup::fuse(-physical_i[s].first, in_r_charge);
+                if (!ret->out_basis_.has(out_l_charge, out_r_charge))
+                    ret->out_basis_.insert(typename DualIndex<SymmGroup>::value_type(out_l_charge, out_r_charge,
+                                                                                     left_i[l].second, out_right.size(out_r_charge)));
+                slice sl = { block, 0, in_left(physical_i[s].first, left_i[l].first), out_right(physical_i[s].first, in_r_charge),
+                             physical_i[s].second, left_i[l].second, right_i[r].second };
+                ret->slices_.push_back(sl);
+                out_charges.push_back(std::make_pair(out_l_charge, out_r_charge));
+            }
+        }
+        ret->resolve(out_charges);
+        return ret;
+    }
+
+    /** @brief Builds the map of the reshape [left_i, (-phys_i, right_i)] --> [(phys_i, left_i), right_i] */
+    static std::shared_ptr<ReshapePlan> right_to_left_plan(Index<SymmGroup> const & physical_i, Index<SymmGroup> const & left_i,
+                                                      Index<SymmGroup> const & right_i, DualIndex<SymmGroup> const & in_basis)
+    {
+        typedef typename SymmGroup::charge charge;
+        std::shared_ptr<ReshapePlan> ret(new ReshapePlan(physical_i, left_i, right_i, in_basis, true));
+        ProductBasis<SymmGroup> in_right(physical_i, right_i,
+                                         boost::lambda::bind(static_cast<charge(*)(charge, charge)>(SymmGroup::fuse),
+                                                             -boost::lambda::_1, boost::lambda::_2));
+        ProductBasis<SymmGroup> out_left(physical_i, left_i);
+        std::vector<std::pair<charge, charge> > out_charges;
+        for (std::size_t block = 0; block < in_basis.size(); ++block)
+        {
+            std::size_t l = left_i.position(in_basis[block].lc);
+            if (l == left_i.size()) continue;
+            charge in_l_charge = left_i[l].first;
+            for (std::size_t s = 0; s < physical_i.size(); ++s)
+            {
+                std::size_t r = right_i.position(SymmGroup::fuse(in_basis[block].rc, physical_i[s].first));
+                if (r == right_i.size()) continue;
+                charge out_l_charge = SymmGroup::fuse(physical_i[s].first, in_l_charge);
+                charge out_r_charge = right_i[r].first;
+                if (!ret->out_basis_.has(out_l_charge, out_r_charge))
+                    ret->out_basis_.insert(typename DualIndex<SymmGroup>::value_type(out_l_charge, out_r_charge,
+                                                                                     out_left.size(physical_i[s].first, in_l_charge), right_i[r].second));
+                slice sl = { block, 0, in_right(physical_i[s].first, out_r_charge), out_left(physical_i[s].first, in_l_charge),
+                             physical_i[s].second, left_i[l].second, right_i[r].second };
+                ret->slices_.push_back(sl);
+                out_charges.push_back(std::make_pair(out_l_charge, out_r_charge));
+            }
+        }
+        ret->resolve(out_charges);
+        return ret;
+    }
+
+    /**
+     * @brief Returns the plan of a reshape, looking first in a per-thread cache of recently used plans.
+     *
+     * Tensors with the same structure are often created from scratch (e.g. the sigma vectors of an
+     * eigensolver), so that their plans are shared through this cache rather than through the tensors.
+     */
+    static std::shared_ptr<const ReshapePlan> get(bool right_to_left, Index<SymmGroup> const & physical_i, Index<SymmGroup> const & left_i,
+                                                  Index<SymmGroup> const & right_i, DualIndex<SymmGroup> const & in_basis)
+    {
+        static const std::size_t capacity = 16;
+        static thread_local std::vector<std::shared_ptr<const ReshapePlan> > recent;
+        for (std::size_t i = 0; i < recent.size(); ++i) {
+            if (recent[i]->right_to_left_ == right_to_left && recent[i]->matches(physical_i, left_i, right_i, in_basis)) {
+                std::rotate(recent.begin(), recent.begin() + i, recent.begin() + i + 1);
+                return recent.front();
+            }
+        }
+        std::shared_ptr<const ReshapePlan> ret = right_to_left ? right_to_left_plan(physical_i, left_i, right_i, in_basis)
+                                                               : left_to_right_plan(physical_i, left_i, right_i, in_basis);
+        if (recent.size() == capacity)
+            recent.pop_back();
+        recent.insert(recent.begin(), ret);
+        return ret;
+    }
+
+    /** @brief Checks whether the plan can reshape a tensor with the given indices and block structure */
+    bool matches(Index<SymmGroup> const & physical_i, Index<SymmGroup> const & left_i,
+                 Index<SymmGroup> const & right_i, DualIndex<SymmGroup> const & in_basis) const
+    {
+        return in_basis == in_basis_ && left_i == left_i_ && right_i == right_i_ && physical_i == physical_i_;
+    }
+
+    /** @brief Executes the reshape of [m1] into [m2] */
+    template<class Matrix, class OtherMatrix>
+    void apply(block_matrix<OtherMatrix, SymmGroup> const & m1, block_matrix<Matrix, SymmGroup> & m2) const
+    {
+        assert( m1.basis() == in_basis_ );
+        m2 = block_matrix<Matrix, SymmGroup>(out_basis_);
+        for (typename std::vector<slice>::const_iterator it = slices_.begin(); it != slices_.end(); ++it) {
+            if (right_to_left_)
+                maquis::dmrg::detail::reshape_r2l(m2[it->out_block], m1[it->in_block], it->out_offset, it->in_offset,
+                                                  it->sdim, it->ldim, it->rdim);
+            else
+                maquis::dmrg::detail::reshape_l2r(m1[it->in_block], m2[it->out_block], it->in_offset, it->out_offset,
+                                                  it->sdim, it->ldim, it->rdim);
+        }
+    }
+
+private:
+    ReshapePlan(Index<SymmGroup> const & physical_i, Index<SymmGroup> const & left_i, Index<SymmGroup> const & right_i,
+                DualIndex<SymmGroup> const & in_basis, bool right_to_left)
+    : physical_i_(physical_i), left_i_(left_i), right_i_(right_i), in_basis_(in_basis), right_to_left_(right_to_left)
+    { }
+
+    /** @brief Translates the charges of the output blocks into positions, once the output basis is complete */
+    void resolve(std::vector<std::pair<typename SymmGroup::charge, typename SymmGroup::charge> > const & out_charges)
+    {
+        for (std::size_t i = 0; i < slices_.size(); ++i)
+            slices_[i].out_block = out_basis_.position(out_charges[i].first, out_charges[i].second);
+    }
+
+    Index<SymmGroup> physical_i_, left_i_, right_i_;
+    DualIndex<SymmGroup> in_basis_, out_basis_;
+    std::vector<slice> slices_;
+    bool right_to_left_;
+};
+
 // Moving two auxiliary indexes to the right
 // [(phys_i, left_i), right_i]  -->  [phys_i, (-left_i, right_i)]
 template<class Matrix, class SymmGroup>
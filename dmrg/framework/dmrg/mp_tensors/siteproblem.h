@@ -5,6 +5,7 @@
  *            See LICENSE.txt for details.
  */
 
+#include <memory>
 #include "dmrg/mp_tensors/boundary.h"
 #include "dmrg/mp_tensors/mpstensor.h"
 #include "dmrg/mp_tensors/mpotensor.h"
@@ -18,14 +19,19 @@
  * 
  * This class wraps, in practice, all ingredients that are required to calculate
  * the sigma vector for a MPS/MPO contraction.
+ * The contraction plan is shared among the copies of the site problem, and is
+ * built by the first sigma vector calculation.
  */
 template<class Matrix, class SymmGroup>
 struct SiteProblem
 {
+    using plan_type = typename contraction::Engine<Matrix, typename storage::constrained<Matrix>::type, SymmGroup>::site_hamil_plan;
+
     /** @brief Default constructor */
     SiteProblem(Boundary<typename storage::constrained<Matrix>::type, SymmGroup> const & left_,
                 Boundary<typename storage::constrained<Matrix>::type, SymmGroup> const & right_,
-                MPOTensor<Matrix, SymmGroup> const & mpo_) : left(left_), right(right_), mpo(mpo_)
+                MPOTensor<Matrix, SymmGroup> const & mpo_) : left(left_), right(right_), mpo(mpo_),
+                plan(std::make_shared<plan_type>())
     { }
 
     /** @brief Method to evaluate the sigma vector */
@@ -49,6 +55,7 @@ struct SiteProblem
     Boundary<typename storage::constrained<Matrix>::type, SymmGroup> const & left;
     Boundary<typename storage::constrained<Matrix>::type, SymmGroup> const & right;
     MPOTensor<Matrix, SymmGroup> const & mpo;
+    std::shared_ptr<plan_type> plan;
     double ortho_shift=0.;
 };
 
@@ -15,6 +15,8 @@
 #include "dmrg/block_matrix/site_operator.h"
 #include "dmrg/block_matrix/site_operator_algorithms.h"
 #include "dmrg/models/OperatorHandlers/KronHandler.h"
+#include "dmrg/mp_tensors/mpo_cache.h"
+#include "dmrg/utils/BaseParameters.h"
 
 namespace ts_ops_detail
 {
@@ -151,4 +153,31 @@ void make_ts_cache_mpo(MPO<MPOMatrix, SymmGroup> const & mpo_orig,
     // maquis::cout << "Total number of tags: " << ntags << std::endl;
 }
 
+/**
+ * @brief Same as above, with the two-site MPO loaded from (or stored in) the [mpo_cache] directory.
+ *
+ * The cache entry is keyed by the content of the input MPO and by the physical dimensions,
+ * so that it is shared by all the runs with the same Hamiltonian.
+ */
+template<class MPOMatrix, class MPSMatrix, class SymmGroup>
+void make_ts_cache_mpo(MPO<MPOMatrix, SymmGroup> const & mpo_orig, MPO<MPSMatrix, SymmGroup> & mpo_out,
+                       MPS<MPSMatrix, SymmGroup> const & mps, BaseParameters & parms)
+{
+    std::string cache_dir = parms["mpo_cache"].str();
+    if (cache_dir.empty()) {
+        make_ts_cache_mpo(mpo_orig, mpo_out, mps);
+        return;
+    }
+    std::vector<Index<SymmGroup> > site_dims;
+    for (int p = 0; p < mps.length(); ++p)
+        site_dims.push_back(mps[p].site_dim());
+    std::string fp = mpo_cache::file_name(cache_dir, "ts_mpo", mpo_cache::content_key(mpo_orig, site_dims));
+    if (mpo_cache::load(fp, mpo_out)) {
+        maquis::cout << "Two-site MPO loaded from " << fp << std::endl;
+        return;
+    }
+    make_ts_cache_mpo(mpo_orig, mpo_out, mps);
+    mpo_cache::save(fp, mpo_out);
+}
+
 #endif
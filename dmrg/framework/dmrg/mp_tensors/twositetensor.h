@@ -58,6 +58,11 @@ public:
     
     boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
     split_mps_r2l(std::size_t Mmax, double cutoff) const;
+
+    /** @brief Split into U, S and V, with U left- and V right-normalized (the singular values are not absorbed) */
+    boost::tuple<MPSTensor<Matrix, SymmGroup>, block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup>,
+                 MPSTensor<Matrix, SymmGroup>, truncation_results>
+    split_mps_bond(std::size_t Mmax, double cutoff) const;
     
     boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
     predict_split_l2r(std::size_t Mmax, double cutoff, double alpha, Boundary<Matrix, SymmGroup> const& left,
@@ -179,6 +179,25 @@ TwoSiteTensor<Matrix, SymmGroup>::split_mps_r2l(std::size_t Mmax, double cutoff)
     return boost::make_tuple(mps_tensor1, mps_tensor2, trunc);
 }
 
+template<class Matrix, class SymmGroup>
+boost::tuple<MPSTensor<Matrix, SymmGroup>, block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup>,
+             MPSTensor<Matrix, SymmGroup>, truncation_results>
+TwoSiteTensor<Matrix, SymmGroup>::split_mps_bond(std::size_t Mmax, double cutoff) const
+{
+    make_both_paired();
+
+    typedef typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type dmt;
+    block_matrix<Matrix, SymmGroup> u, v;
+    block_matrix<dmt, SymmGroup> s;
+
+    truncation_results trunc = svd_truncate(data_, u, v, s, cutoff, Mmax, false);
+
+    MPSTensor<Matrix, SymmGroup> mps_tensor1(phys_i_left, left_i, u.right_basis(), u, LeftPaired);
+    MPSTensor<Matrix, SymmGroup> mps_tensor2(phys_i_right, v.left_basis(), right_i, v, RightPaired);
+
+    return boost::make_tuple(mps_tensor1, s, mps_tensor2, trunc);
+}
+
 template<class Matrix, class SymmGroup>
 boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
 TwoSiteTensor<Matrix, SymmGroup>::predict_split_l2r(std::size_t Mmax, double cutoff, double alpha, const Boundary<Matrix, SymmGroup>& left,
@@ -0,0 +1,212 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+// Multi-root (block) variant of the Davidson algorithm of davidson.h
+
+#ifndef IETL_BLOCK_DAVIDSON_H
+#define IETL_BLOCK_DAVIDSON_H
+
+#include <ietl/traits.h>
+#include <ietl/fmatrix.h>
+#include <ietl/ietl2lapack.h>
+
+#include <algorithm>
+#include <complex>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace ietl
+{
+    namespace block_davidson_detail {
+        template<class T> T conj(T x) { return x; }
+        template<class T> std::complex<T> conj(std::complex<T> x) { return std::conj(x); }
+    }
+
+    /**
+     * @brief Block Davidson eigensolver for the lowest [nroots] eigenpairs.
+     *
+     * At each iteration, one correction vector is generated per non-converged root, and the
+     * whole block is multiplied by the matrix at once, i.e. with a single call to
+     * mult(matrix, std::vector<vector_type>, std::vector<vector_type>). For the SiteProblem,
+     * this calculates all the sigma vectors with one pass over the boundaries.
+     *
+     * When the subspace grows beyond [max_subspace] vectors, it is collapsed onto the current
+     * Ritz vectors.
+     */
+    template <class MATRIX, class VS>
+    class block_davidson
+    {
+    public:
+        typedef typename vectorspace_traits<VS>::vector_type vector_type;
+        typedef typename vectorspace_traits<VS>::scalar_type scalar_type;
+        typedef typename ietl::number_traits<scalar_type>::magnitude_type magnitude_type;
+
+        block_davidson(const MATRIX& matrix, const VS& vec, std::size_t nroots, std::size_t max_subspace = 20);
+
+        /**
+         * @brief Calculates the eigenpairs, sorted by increasing eigenvalue.
+         *
+         * Missing guesses (less than [nroots]) are generated as a Krylov sequence from the last one.
+         * If the resulting subspace is still too small (e.g. because the guess is an eigenvector),
+         * it is completed with random vectors.
+         * The iteration stops when the largest residual norm fulfills the criterion of [iter].
+         */
+        template <class PRECOND, class ITER>
+        std::vector<std::pair<magnitude_type, vector_type> > calculate_eigenvalues(std::vector<vector_type> guess,
+                                                                                   PRECOND& mdiag,
+                                                                                   ITER& iter);
+    private:
+        MATRIX const & matrix_;
+        VS vecspace_;
+        std::size_t nroots_, max_subspace_;
+    };
+
+    template <class MATRIX, class VS>
+    block_davidson<MATRIX, VS>::block_davidson(const MATRIX& matrix, const VS& vec, std::size_t nroots, std::size_t max_subspace) :
+    matrix_(matrix),
+    vecspace_(vec),
+    nroots_(nroots),
+    max_subspace_(std::max(max_subspace, 2*nroots))
+    {}
+
+    template <class MATRIX, class VS>
+    template <class PRECOND, class ITER>
+    std::vector<std::pair<typename block_davidson<MATRIX,VS>::magnitude_type, typename block_davidson<MATRIX, VS>::vector_type> >
+    block_davidson<MATRIX, VS>::calculate_eigenvalues(std::vector<vector_type> guess,
+                                                      PRECOND& mdiag,
+                                                      ITER& iter)
+    {
+        typedef alps::numeric::matrix<scalar_type> matrix_t;
+
+        if (guess.empty())
+            throw std::runtime_error("Block Davidson requires at least one starting vector\n");
+
+        std::size_t nroots = std::min(nroots_, vec_dimension(vecspace_));
+        magnitude_type kappa = 0.25;
+
+        // Krylov completion of the starting guesses
+        while (guess.size() < nroots) {
+            vector_type w;
+            ietl::mult(matrix_, guess.back(), w);
+            guess.push_back(w);
+        }
+
+        std::vector<vector_type> V, VA, t = guess, u(nroots), uA(nroots);
+        std::vector<magnitude_type> theta(nroots);
+        matrix_t M;
+
+        // Modified Gram-Schmidt Orthogonalization with Refinement, linearly dependent directions are dropped
+        auto add_direction = [&](vector_type & w)
+        {
+            ietl::project(w, vecspace_);
+            magnitude_type tau = ietl::two_norm(w);
+            for (std::size_t i = 0; i < V.size(); i++)
+                w -= ietl::dot(V[i], w) * V[i];
+            if (ietl::two_norm(w) < kappa * tau)
+                for (std::size_t i = 0; i < V.size(); i++)
+                    w -= ietl::dot(V[i], w) * V[i];
+            ietl::project(w, vecspace_);
+            magnitude_type nrm = ietl::two_norm(w);
+            if (nrm > 1e-10 * tau && nrm > 1e-14)
+                V.push_back(w / nrm);
+        };
+
+        do
+        {
+            // The new vectors are orthogonalized against the subspace and among themselves
+            std::size_t old_dim = V.size();
+            for (std::size_t k = 0; k < t.size(); ++k)
+                add_direction(t[k]);
+            t.clear();
+            if (old_dim == 0 && V.size() < nroots)
+            {
+                std::mt19937 rng(V.size());
+                std::uniform_real_distribution<magnitude_type> dist(-1., 1.);
+                for (std::size_t attempt = 0; attempt < 2*nroots && V.size() < nroots; ++attempt) {
+                    vector_type w = new_vector(vecspace_);
+                    ietl::generate(w, [&]() { return dist(rng); });
+                    add_direction(w);
+                }
+            }
+            if (V.size() == old_dim)
+                break;
+
+            // v_m^A = A v_m, for all the new vectors at once
+            std::vector<vector_type> newV(V.begin() + old_dim, V.end()), newVA;
+            ietl::mult(matrix_, newV, newVA);
+            VA.insert(VA.end(), newVA.begin(), newVA.end());
+
+            // Extension of the projected matrix
+            std::size_t iter_dim = V.size();
+            matrix_t Mnew(iter_dim, iter_dim);
+            for (std::size_t i = 0; i < old_dim; ++i)
+                for (std::size_t j = 0; j < old_dim; ++j)
+                    Mnew(i,j) = M(i,j);
+            for (std::size_t j = old_dim; j < iter_dim; ++j)
+                for (std::size_t i = 0; i <= j; ++i)
+                {
+                    Mnew(i,j) = ietl::dot(V[i], VA[j]);
+                    Mnew(j,i) = block_davidson_detail::conj(Mnew(i,j));
+                }
+            M = Mnew;
+
+            std::vector<magnitude_type> Mevals(iter_dim);
+            boost::numeric::bindings::lapack::heevd('V', Mnew, Mevals);
+
+            // Ritz vectors and residuals
+            std::size_t nritz = std::min(nroots, iter_dim);
+            std::vector<vector_type> r(nritz);
+            std::vector<magnitude_type> rnorm(nritz);
+            magnitude_type max_rnorm = 0.;
+            for (std::size_t k = 0; k < nritz; ++k)
+            {
+                u[k] = V[0] * Mnew(0,k);
+                uA[k] = VA[0] * Mnew(0,k);
+                for (std::size_t i = 1; i < iter_dim; ++i)
+                {
+                    u[k] += V[i] * Mnew(i,k);
+                    uA[k] += VA[i] * Mnew(i,k);
+                }
+                theta[k] = Mevals[k];
+                r[k] = uA[k] - u[k] * theta[k];
+                rnorm[k] = ietl::two_norm(r[k]);
+                max_rnorm = std::max(max_rnorm, rnorm[k]);
+            }
+
+            ++iter;
+            if (iter.finished(max_rnorm, theta[0]))
+                break;
+
+            // Correction vectors for the roots which are not converged yet
+            for (std::size_t k = 0; k < nritz; ++k)
+                if (!iter.converged(rnorm[k], theta[k])) {
+                    mdiag.precondition(r[k], u[k], theta[k]);
+                    magnitude_type nrm = ietl::two_norm(r[k]);
+                    if (nrm > 0.)
+                        t.push_back(r[k] / nrm);
+                }
+
+            // Restart from the Ritz vectors
+            if (V.size() + t.size() > max_subspace_)
+            {
+                V.assign(u.begin(), u.begin() + nritz);
+                VA.assign(uA.begin(), uA.begin() + nritz);
+                M = matrix_t(nritz, nritz, 0.);
+                for (std::size_t k = 0; k < nritz; ++k)
+                    M(k,k) = theta[k];
+            }
+
+        } while (true);
+
+        std::vector<std::pair<magnitude_type, vector_type> > ret;
+        for (std::size_t k = 0; k < std::min(nroots, V.size()); ++k)
+            ret.push_back(std::make_pair(theta[k], u[k]));
+        return ret;
+    }
+}
+#endif
@@ -13,6 +13,7 @@
 #include "ietl_lanczos_solver.h"
 
 #include "davidson.h"
+#include "block_davidson.h"
 
 namespace davidson_detail {
 
@@ -64,7 +65,7 @@ namespace davidson_detail {
 
     public:
 
-        MultDiagonal(SiteProblem<Matrix, SymmGroup> const& H, vector_type const& x)
+        MultDiagonal(SiteProblem<Matrix, SymmGroup> const& H, vector_type const& x, bool reuse = false)
         {
             throw std::runtime_error("Davidson only implemented for spin-adapted Hamiltonians\n");
         }
@@ -82,9 +83,10 @@ namespace davidson_detail {
 
     public:
 
-        MultDiagonal(SiteProblem<Matrix, SymmGroup> const& H, vector_type const& x)
+        /** @brief Builds the preconditioner, reusing the last diagonal of this thread if [reuse] is true and it is still valid */
+        MultDiagonal(SiteProblem<Matrix, SymmGroup> const& H, vector_type const& x, bool reuse = false)
         {
-            Hdiag = contraction::SU2::diagonal_hamiltonian(H.left, H.right, H.mpo, x);
+            Hdiag = contraction::SU2::diagonal_hamiltonian(H.left, H.right, H.mpo, x, reuse);
         }
 
         void precondition(vector_type& r, vector_type& V, value_type theta)
@@ -141,7 +143,7 @@ solve_ietl_davidson(SiteProblem<Matrix, SymmGroup> & sp,
     ietl::davidson<SiteProblem<Matrix, SymmGroup>, SingleSiteVS<Matrix, SymmGroup> >
     jd(sp, vs, ietl::Smallest);
 
-    davidson_detail::MultDiagonal<Matrix, SymmGroup> mdiag(sp, initial);
+    davidson_detail::MultDiagonal<Matrix, SymmGroup> mdiag(sp, initial, params["ietl_diag_reuse"]);
 
     double tol = params["ietl_jcd_tol"];
     ietl::basic_iteration<double> iter(params["ietl_jcd_maxiter"], tol, tol);
@@ -161,4 +163,68 @@ solve_ietl_davidson(SiteProblem<Matrix, SymmGroup> & sp,
     return r0;
 }
 
+/**
+ * @brief Lowest [ietl_davidson_nroots] eigenpairs of the site problem, calculated with the block Davidson algorithm.
+ *
+ * [initial] contains the starting guesses, missing ones are generated by the solver.
+ * The eigenpairs are returned sorted by increasing energy.
+ */
+template<class Matrix, class SymmGroup>
+std::vector<std::pair<double, MPSTensor<Matrix, SymmGroup> > >
+solve_ietl_block_davidson(SiteProblem<Matrix, SymmGroup> & sp,
+                          std::vector<MPSTensor<Matrix, SymmGroup> > const & initial,
+                          BaseParameters & params,
+                          std::vector<MPSTensor<Matrix, SymmGroup> > ortho_vecs = std::vector<MPSTensor<Matrix, SymmGroup> >())
+{
+    if (initial[0].num_elements() <= ortho_vecs.size())
+        ortho_vecs.resize(initial[0].num_elements()-1);
+    // Gram-Schmidt the ortho_vecs
+    for (int n = 1; n < ortho_vecs.size(); ++n)
+        for (int n0 = 0; n0 < n; ++n0)
+            ortho_vecs[n] -= ietl::dot(ortho_vecs[n0], ortho_vecs[n])/ietl::dot(ortho_vecs[n0],ortho_vecs[n0])*ortho_vecs[n0];
+
+    SingleSiteVS<Matrix, SymmGroup> vs(initial[0], ortho_vecs);
+
+    std::size_t nroots = params["ietl_davidson_nroots"];
+    ietl::block_davidson<SiteProblem<Matrix, SymmGroup>, SingleSiteVS<Matrix, SymmGroup> >
+    bd(sp, vs, nroots, params["ietl_davidson_max_subspace"]);
+
+    davidson_detail::MultDiagonal<Matrix, SymmGroup> mdiag(sp, initial[0], params["ietl_diag_reuse"]);
+
+    double tol = params["ietl_jcd_tol"];
+    ietl::basic_iteration<double> iter(params["ietl_jcd_maxiter"], tol, tol);
+
+    std::vector<std::pair<double, MPSTensor<Matrix, SymmGroup> > > roots = bd.calculate_eigenvalues(initial, mdiag, iter);
+
+    maquis::cout << "Block Davidson used " << iter.iterations() << " iterations for " << roots.size() << " roots." << std::endl;
+
+    return roots;
+}
+
+/**
+ * @brief Block Davidson optimization of the site problem, following the root [ietl_davidson_target_root].
+ *
+ * The energies of all the roots, shifted by [energy_shift] (e.g. the core energy), are printed.
+ */
+template<class Matrix, class SymmGroup>
+std::pair<double, MPSTensor<Matrix, SymmGroup> >
+solve_ietl_block_davidson(SiteProblem<Matrix, SymmGroup> & sp,
+                          MPSTensor<Matrix, SymmGroup> const & initial,
+                          BaseParameters & params,
+                          std::vector<MPSTensor<Matrix, SymmGroup> > const & ortho_vecs,
+                          double energy_shift = 0.)
+{
+    std::vector<std::pair<double, MPSTensor<Matrix, SymmGroup> > > roots
+        = solve_ietl_block_davidson(sp, std::vector<MPSTensor<Matrix, SymmGroup> >(1, initial), params, ortho_vecs);
+    std::size_t target = params["ietl_davidson_target_root"];
+    if (target >= roots.size())
+        throw std::runtime_error("Target root of the block Davidson eigensolver not available\n");
+    int prec = maquis::cout.precision();
+    maquis::cout.precision(15);
+    for (std::size_t k = 0; k < roots.size(); ++k)
+        maquis::cout << "Root " << k << " energy " << roots[k].first + energy_shift << std::endl;
+    maquis::cout.precision(prec);
+    return roots[target];
+}
+
 #endif
@@ -110,10 +110,21 @@ namespace ietl
               MPSTensor<Matrix, SymmGroup> const & x,
               MPSTensor<Matrix, SymmGroup> & y)
     {
-        y = contraction::Engine<Matrix, Matrix, SymmGroup>::site_hamil2(x, H.left, H.right, H.mpo);
+        y = H.plan->apply(x, H.left, H.right, H.mpo);
         x.make_left_paired();
     }
 
+    /** @brief Sigma vectors of a batch of tensors, calculated with a single pass over the boundaries */
+    template<class Matrix, class SymmGroup>
+    void mult(SiteProblem<Matrix, SymmGroup> const & H,
+              std::vector<MPSTensor<Matrix, SymmGroup> > const & x,
+              std::vector<MPSTensor<Matrix, SymmGroup> > & y)
+    {
+        y = H.plan->apply_batch(x, H.left, H.right, H.mpo);
+        for (std::size_t n = 0; n < x.size(); ++n)
+            x[n].make_left_paired();
+    }
+
     template<class Matrix, class SymmGroup>
     struct vectorspace_traits<SingleSiteVS<Matrix, SymmGroup> >
     {
@@ -22,6 +22,7 @@
 #include "ietl_davidson.h"
 
 #include "dmrg/utils/BaseParameters.h"
+#include "dmrg/utils/pool_allocator.hpp"
 #include "dmrg/utils/results_collector.h"
 #include "dmrg/utils/storage.h"
 #include "dmrg/utils/time_limit_exception.h"
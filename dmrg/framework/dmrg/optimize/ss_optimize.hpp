@@ -122,6 +122,10 @@ public:
                     BEGIN_TIMING("JCD")
                     res = solve_ietl_jcd(sp, mps[site], parms, ortho_vecs);
                     END_TIMING("JCD")
+                } else if (parms["eigensolver"] == std::string("IETL_BLOCK_DAVIDSON")) {
+                    BEGIN_TIMING("BLOCK_DAVIDSON")
+                    res = solve_ietl_block_davidson(sp, mps[site], parms, ortho_vecs, mpo.getCoreEnergy());
+                    END_TIMING("BLOCK_DAVIDSON")
                 } else {
                     throw std::runtime_error("I don't know this eigensolver.");
                 }
@@ -166,8 +170,12 @@ public:
             if (lr == +1) {
                 if (site < L-1) {
                     maquis::cout << "Growing, alpha = " << alpha << std::endl;
-                    trunc = mps.grow_l2r_sweep(mpo[site], left_[site], right_[site+1],
-                                               site, alpha, cutoff, Mmax);
+                    if (parms["singlesite_noise"] == "cbe")
+                        trunc = mps.expand_l2r_sweep(mpo[site], left_[site], right_[site+1], site, alpha, cutoff, Mmax,
+                                                     parms["cbe_expansion_ratio"], false);
+                    else
+                        trunc = mps.grow_l2r_sweep(mpo[site], left_[site], right_[site+1],
+                                                   site, alpha, cutoff, Mmax, true, false);
                 } else {
                     block_matrix<Matrix, SymmGroup> t = mps[site].normalize_left(DefaultSolver());
                     if (site < L-1)
@@ -183,8 +191,12 @@ public:
                 if (site > 0) {
                     maquis::cout << "Growing, alpha = " << alpha << std::endl;
                     // Invalid read occurs after this!\n
-                    trunc = mps.grow_r2l_sweep(mpo[site], left_[site], right_[site+1],
-                                               site, alpha, cutoff, Mmax);
+                    if (parms["singlesite_noise"] == "cbe")
+                        trunc = mps.expand_r2l_sweep(mpo[site], left_[site], right_[site+1], site, alpha, cutoff, Mmax,
+                                                     parms["cbe_expansion_ratio"], false);
+                    else
+                        trunc = mps.grow_r2l_sweep(mpo[site], left_[site], right_[site+1],
+                                                   site, alpha, cutoff, Mmax, true, false);
                 } else {
                     block_matrix<Matrix, SymmGroup> t = mps[site].normalize_right(DefaultSolver());
                     if (site > 0)
@@ -201,6 +213,7 @@ public:
             iteration_results_["BondDimension"]   << trunc.bond_dimension;
             iteration_results_["TruncatedWeight"] << trunc.truncated_weight;
             iteration_results_["SmallestEV"]      << trunc.smallest_ev;
+            maquis::trim_memory_pools();
 
             std::chrono::high_resolution_clock::time_point sweep_then = std::chrono::high_resolution_clock::now();
             double elapsed = std::chrono::duration<double>(sweep_then - sweep_now).count();
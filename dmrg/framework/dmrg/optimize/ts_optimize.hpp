@@ -41,7 +41,7 @@ public:
     , initial_site((initial_site_ < 0) ? 0 : initial_site_)
     {
         parallel::guard::serial guard;
-        make_ts_cache_mpo(mpo, ts_cache_mpo, mps);
+        make_ts_cache_mpo(mpo, ts_cache_mpo, mps, parms_);
     }
 
     inline int to_site(const int L, const int i) const
@@ -144,6 +144,10 @@ public:
                     BEGIN_TIMING("DAVIDSON")
                     res = solve_ietl_davidson(sp, twin_mps, parms, ortho_vecs);
                     END_TIMING("DAVIDSON")
+                } else if (parms["eigensolver"] == std::string("IETL_BLOCK_DAVIDSON")) {
+                    BEGIN_TIMING("BLOCK_DAVIDSON")
+                    res = solve_ietl_block_davidson(sp, twin_mps, parms, ortho_vecs, mpo.getCoreEnergy());
+                    END_TIMING("BLOCK_DAVIDSON")
                 } else {
                     throw std::runtime_error("I don't know this eigensolver.");
                 }
@@ -261,6 +265,7 @@ public:
             iteration_results_["TruncatedWeight"]   << trunc.truncated_weight;
             iteration_results_["TruncatedFraction"] << trunc.truncated_fraction;
             iteration_results_["SmallestEV"]        << trunc.smallest_ev;
+            maquis::trim_memory_pools();
 
             parallel::meminfo();
 
@@ -410,7 +410,7 @@ public:
       // construct new model and mpo with new integrals
       // hope this doesn't give any memory leaks
       model = Model<Matrix, SymmGroup>(lat, parms);
-      mpo = make_mpo(lat, model);
+      mpo = make_mpo(lat, model, parms);
       // check if MPS is still OK
       maquis::checks::right_end_check(mps, model.total_quantum_numbers(parms));
       all_measurements = model.measurements();
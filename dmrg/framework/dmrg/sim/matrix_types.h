@@ -16,6 +16,15 @@ typedef ambient::tiles<ambient::matrix<double> > matrix;
 typedef ambient::tiles<ambient::matrix< std::complex<double> > > cmatrix;
 template <class V>
     using tmatrix = ambient::tiles<ambient::matrix<V> >;
+#elif defined MAQUIS_POOL_ALLOCATOR
+#include "dmrg/block_matrix/detail/alps.hpp"
+#include "dmrg/utils/pool_allocator.hpp"
+#include <complex>
+// Dense blocks are taken from per-thread memory pools, see utils/pool_allocator.hpp
+typedef alps::numeric::matrix<double, std::vector<double, maquis::memory::pool_allocator<double> > > matrix;
+typedef alps::numeric::matrix<std::complex<double>, std::vector<std::complex<double>, maquis::memory::pool_allocator<std::complex<double> > > > cmatrix;
+template <class V>
+    using tmatrix = alps::numeric::matrix<V, std::vector<V, maquis::memory::pool_allocator<V> > >;
 #else
 #include "dmrg/block_matrix/detail/alps.hpp"
 #include <complex>
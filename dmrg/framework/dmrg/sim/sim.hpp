@@ -140,7 +140,7 @@ sim<Matrix, SymmGroup>::sim(DmrgParameters & parms_)
     // Model initialization
     lat = Lattice(parms);
     model = Model<Matrix, SymmGroup>(lat, parms);
-    mpo = make_mpo(lat, model);
+    mpo = make_mpo(lat, model, parms);
     all_measurements = model.measurements();
     all_measurements << overlap_measurements<Matrix, SymmGroup>(parms);
 
@@ -43,6 +43,9 @@ private:
 
         add_option("optimization", "singlesite or twosite", value("twosite"));
         add_option("twosite_truncation", "`svd` on the two-site mps or `heev` on the reduced density matrix (with alpha factor)", value("svd"));
+        add_option("singlesite_noise", "`dm` perturbed density matrix or `cbe` controlled bond expansion (single-site optimization, with alpha factor)", value("dm"));
+        add_option("cbe_expansion_ratio", "Number of states sketched by the controlled bond expansion, relative to the bond dimension", value(0.5));
+        add_option("pdmrg_inverse_cutoff", "Singular values of the bonds between the segments of the parallel DMRG below which (relative to the largest one) the inverse is set to zero", value(1e-10));
 
         add_option("alpha_initial","", value(1e-2));
         add_option("alpha_main", "", value(1e-4));
@@ -53,6 +56,10 @@ private:
         add_option("ietl_jcd_tol", "", value(1e-8));
         add_option("ietl_jcd_gmres", "", value(0));
         add_option("ietl_jcd_maxiter", "", value(10));
+        add_option("ietl_davidson_nroots", "Number of roots converged together by the IETL_BLOCK_DAVIDSON eigensolver", value(1));
+        add_option("ietl_davidson_target_root", "Root followed by the optimization with IETL_BLOCK_DAVIDSON (0 is the lowest one)", value(0));
+        add_option("ietl_davidson_max_subspace", "Dimension of the IETL_BLOCK_DAVIDSON subspace triggering a restart", value(20));
+        add_option("ietl_diag_reuse", "Reuse the diagonal of the site Hamiltonian of the previous micro-iteration for the preconditioner, when its boundaries are unchanged", value(true));
 
         add_option("nsweeps", "Number of sweeps of the optimization", 10);
         add_option("ngrowsweeps", "Number of the grow sweeps (used for the truncation and noise parameters)", 2);
@@ -64,6 +71,10 @@ private:
         add_option("donotsave", "", value(0));
         add_option("run_seconds", "", value(0));
         add_option("storagedir", "", value(""));
+        add_option("storage_memory", "memory (in MB) for the boundaries that are kept in core when storagedir is set, 0 stores all of them", value(0.));
+        add_option("storage_io_threads", "number of threads used for the disk storage of the boundaries", value(1));
+        add_option("storage_mode", "how the boundaries are written to storagedir: stream (buffered files) or mmap (memory-mapped files)", value("stream"));
+        add_option("mpo_cache", "directory where the MPO and the two-site MPO are cached, keyed by the integrals and the model parameters (disabled if empty)", value(""));
         add_option("use_compressed", "", value(0));
         add_option("seed", "", value(42));
         add_option("ALWAYS_MEASURE", "comma separated list of measurements", value(""));
@@ -114,6 +125,7 @@ private:
         // Settings for integral read-in
         add_option("integral_file", "path to model parameters, e.g. FCIDUMP-style integral file", value("FCIDUMP"));
         add_option("integral_cutoff", "Ignore electron integrals below a certain magnitude", value(0));
+        add_option("integral_cache", "binary cache of the parsed integral_file: auto (integral_file.cache), none, or a path", value("auto"));
         add_option("beta_mode", "", value(0));
 
         // Excited states calculation with ORTHO
@@ -124,6 +136,8 @@ private:
         add_option("MEASURE[EnergyVariance]", "", value(0));
         add_option("MEASURE[Entropy]", "", value(false));
         add_option("MEASURE[Renyi2]", "", value(false));
+        add_option("MEASURE_PARTITION[count]", "Number of independent processes among which the 3- and 4-RDM elements are divided", value(1));
+        add_option("MEASURE_PARTITION[index]", "Part of the 3- and 4-RDM elements evaluated by this process, from 0 to MEASURE_PARTITION[count]-1", value(0));
 
         // Electronic-structure calculations
         add_option("irrep", "Index of the irreducible representation associated with the wave function", value(0));
@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dmrg/utils/parallel/loops.hpp"
+
+namespace maquis {
+    namespace detail {
+
+        // Size of the independent pieces which are hashed concurrently
+        static const std::size_t hash_chunk_size = 1 << 20;
+
+        inline std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t v)
+        {
+            return seed ^ (v + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+        }
+
+        // 64-bit FNV-1a hash of [n] bytes
+        inline std::uint64_t fnv1a(char const * data, std::size_t n, std::uint64_t h = 0xcbf29ce484222325ull)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ull;
+            return h;
+        }
+
+        inline std::uint64_t fnv1a(std::string const & s) { return fnv1a(s.data(), s.size()); }
+
+        // Hash of a (large) piece of memory, combined from the FNV-1a hashes of chunks of fixed size.
+        // The chunks are hashed in parallel, the result does not depend on the number of threads.
+        inline std::uint64_t content_hash(char const * data, std::size_t size)
+        {
+            std::size_t nchunks = (size + hash_chunk_size - 1) / hash_chunk_size;
+            std::vector<std::uint64_t> hashes(nchunks);
+            threaded_for(std::size_t c = 0; c < nchunks; ++c)
+                hashes[c] = fnv1a(data + c*hash_chunk_size, std::min(hash_chunk_size, size - c*hash_chunk_size));
+            std::uint64_t ret = hash_combine(0, size);
+            for (std::uint64_t h : hashes)
+                ret = hash_combine(ret, h);
+            return ret;
+        }
+
+        // Same as content_hash, for the content of a file which is read chunk by chunk
+        inline std::uint64_t file_hash(std::string const & fp)
+        {
+            std::ifstream ifs(fp.c_str(), std::ifstream::binary);
+            if (!ifs)
+                throw std::runtime_error("Cannot open " + fp);
+            std::vector<char> buffer(hash_chunk_size);
+            std::vector<std::uint64_t> hashes;
+            std::uint64_t size = 0;
+            while (ifs.read(buffer.data(), buffer.size()) || ifs.gcount() > 0) {
+                hashes.push_back(fnv1a(buffer.data(), ifs.gcount()));
+                size += ifs.gcount();
+            }
+            std::uint64_t ret = hash_combine(0, size);
+            for (std::uint64_t h : hashes)
+                ret = hash_combine(ret, h);
+            return ret;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef PARALLEL_WORK_STEALING_HPP
+#define PARALLEL_WORK_STEALING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <vector>
+#if defined(MAQUIS_OPENMP)
+#include <omp.h>
+#endif
+#include "dmrg/utils/parallel/loops.hpp"
+
+namespace parallel {
+
+    inline int max_threads()
+    {
+#if defined(MAQUIS_OPENMP)
+        return omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    /**
+     * @brief Executor for independent tasks of (roughly) known cost.
+     *
+     * The tasks are sorted by decreasing cost and dealt round-robin to one queue per thread.
+     * Each thread consumes its own queue first and, once it is empty, steals the remaining tasks
+     * of the other queues. Queues are plain arrays with an atomic head, so that neither the owner
+     * nor the thieves take any lock.
+     *
+     * The functor receives the task index and the index of the executing thread, which can be
+     * used to address per-thread accumulators that are merged at the end with [tree_reduce].
+     */
+    class work_stealing_executor {
+    public:
+        explicit work_stealing_executor(std::vector<double> const & costs, int nthreads = max_threads())
+            : nthreads_(std::max(1, std::min<int>(nthreads, costs.size()))), queues_(nthreads_), heads_(new std::atomic<std::size_t>[nthreads_])
+        {
+            std::vector<std::size_t> order(costs.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&costs](std::size_t i, std::size_t j) { return costs[i] > costs[j]; });
+            for (std::size_t i = 0; i < order.size(); ++i)
+                queues_[i % nthreads_].push_back(order[i]);
+            for (int i = 0; i < nthreads_; ++i)
+                heads_[i] = 0;
+        }
+
+        int num_threads() const { return nthreads_; }
+
+        template<class Function>
+        void run(Function f)
+        {
+#if defined(MAQUIS_OPENMP)
+            parallel_pragma(omp parallel num_threads(nthreads_))
+            work(omp_get_thread_num(), f);
+#else
+            work(0, f);
+#endif
+        }
+
+    private:
+        template<class Function>
+        void work(int thread, Function & f)
+        {
+            for (int i = 0; i < nthreads_; ++i) {
+                int victim = (thread + i) % nthreads_;
+                std::vector<std::size_t> const & queue = queues_[victim];
+                for (std::size_t pos = heads_[victim]++; pos < queue.size(); pos = heads_[victim]++)
+                    f(queue[pos], thread);
+            }
+        }
+
+        int nthreads_;
+        std::vector<std::vector<std::size_t> > queues_;
+        std::unique_ptr<std::atomic<std::size_t>[]> heads_;
+    };
+
+    /**
+     * @brief Pairwise reduction of per-thread partial results into partials[0].
+     *
+     * Each level of the tree merges independent pairs, in parallel.
+     */
+    template<class T, class Merge>
+    void tree_reduce(std::vector<T> & partials, Merge merge)
+    {
+        int n = partials.size();
+        for (int stride = 1; stride < n; stride *= 2)
+            threaded_for(int i = 0; i < n - stride; i += 2*stride)
+                merge(partials[i], partials[i+stride]);
+    }
+
+}
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#ifndef MAQUIS_POOL_ALLOCATOR_HPP
+#define MAQUIS_POOL_ALLOCATOR_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace maquis {
+
+// The pool lives in its own namespace, so that the matrices using it do not pull the
+// algorithms of namespace maquis into argument-dependent lookup.
+namespace memory {
+
+/**
+ * @brief Per-thread cache of freed memory chunks, grouped by size class.
+ *
+ * The sizes are rounded up to four classes per power of two, so that at most 25% of each chunk
+ * is wasted and the temporaries of a contraction, whose sizes repeat from one sigma vector to the
+ * next, are served from the cache without going through malloc. A chunk freed by a thread goes
+ * to the cache of that thread, also when it was allocated by another one.
+ *
+ * The cache never outlives the data, since it only holds chunks that have been freed, and it
+ * is returned to the system when it exceeds [max_cached_bytes], at thread exit and after each
+ * call to [memory_pool::trim] (lazily, i.e. at the next allocation of each thread).
+ */
+class memory_pool
+{
+public:
+    static const std::size_t alignment = 64;
+
+    /**
+     * @brief Pool of the calling thread.
+     *
+     * Returns nullptr once the pool has been destroyed at thread exit, so that the matrices
+     * with static storage duration that are freed after it go directly to the system.
+     */
+    static memory_pool* local()
+    {
+        static thread_local memory_pool pool;
+        return alive() ? &pool : nullptr;
+    }
+
+    /** @brief Allocates [bytes] from the pool of the calling thread */
+    static void* allocate_bytes(std::size_t bytes)
+    {
+        if (memory_pool* pool = local())
+            return pool->allocate(bytes);
+        void* p = 0;
+        if (posix_memalign(&p, alignment, size_class(bytes)))
+            throw std::bad_alloc();
+        return p;
+    }
+
+    /** @brief Gives back [bytes] bytes at [p] to the pool of the calling thread */
+    static void deallocate_bytes(void* p, std::size_t bytes)
+    {
+        if (memory_pool* pool = local())
+            pool->deallocate(p, bytes);
+        else
+            std::free(p);
+    }
+
+    /** @brief Asks all the pools to release their cached chunks */
+    static void trim() { epoch()++; }
+
+    /** @brief Upper bound for the memory cached by each thread (in bytes) */
+    static std::atomic<std::size_t>& max_cached_bytes()
+    {
+        static std::atomic<std::size_t> value(std::size_t(1) << 30);
+        return value;
+    }
+
+    void* allocate(std::size_t bytes)
+    {
+        check_epoch();
+        bytes = size_class(bytes);
+        auto it = free_chunks_.find(bytes);
+        if (it != free_chunks_.end() && !it->second.empty()) {
+            void* p = it->second.back();
+            it->second.pop_back();
+            cached_bytes_ -= bytes;
+            return p;
+        }
+        void* p = 0;
+        if (posix_memalign(&p, alignment, bytes))
+            throw std::bad_alloc();
+        return p;
+    }
+
+    void deallocate(void* p, std::size_t bytes)
+    {
+        bytes = size_class(bytes);
+        if (cached_bytes_ + bytes > max_cached_bytes()) {
+            std::free(p);
+            return;
+        }
+        free_chunks_[bytes].push_back(p);
+        cached_bytes_ += bytes;
+    }
+
+    /** @brief Returns all the cached chunks of this thread to the system */
+    void release()
+    {
+        for (auto& bucket : free_chunks_)
+            for (void* p : bucket.second)
+                std::free(p);
+        free_chunks_.clear();
+        cached_bytes_ = 0;
+    }
+
+    std::size_t cached_bytes() const { return cached_bytes_; }
+
+    ~memory_pool()
+    {
+        release();
+        alive() = false;
+    }
+
+private:
+    memory_pool() : cached_bytes_(0), epoch_(epoch()) { }
+    memory_pool(memory_pool const&) = delete;
+    memory_pool& operator=(memory_pool const&) = delete;
+
+    static std::atomic<unsigned long>& epoch()
+    {
+        static std::atomic<unsigned long> value(0);
+        return value;
+    }
+
+    static bool& alive()
+    {
+        static thread_local bool value = true;
+        return value;
+    }
+
+    void check_epoch()
+    {
+        unsigned long current = epoch();
+        if (current != epoch_) {
+            release();
+            epoch_ = current;
+        }
+    }
+
+    /** @brief Rounds [bytes] up to the closest of the four classes of its power of two */
+    static std::size_t size_class(std::size_t bytes)
+    {
+        if (bytes <= alignment)
+            return alignment;
+        std::size_t step = alignment >> 2;
+        while ((step << 3) < bytes)
+            step <<= 1;
+        return (bytes + step - 1) / step * step;
+    }
+
+    std::unordered_map<std::size_t, std::vector<void*> > free_chunks_;
+    std::size_t cached_bytes_;
+    unsigned long epoch_;
+};
+
+/**
+ * @brief Standard allocator backed by the per-thread [memory_pool].
+ *
+ * Used as allocator of the MemoryBlock of alps::numeric::matrix when MAQUIS_POOL_ALLOCATOR is
+ * defined (see sim/matrix_types.h).
+ */
+template <typename T>
+class pool_allocator {
+  public:
+    typedef T*              pointer;
+    typedef T const*        const_pointer;
+    typedef T&              reference;
+    typedef T const&        const_reference;
+    typedef T               value_type;
+    typedef std::size_t     size_type;
+    typedef std::ptrdiff_t  difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef pool_allocator<U> other;
+    };
+
+    pool_allocator() noexcept { }
+
+    pool_allocator(pool_allocator const& a) noexcept { }
+
+    template <typename U>
+    pool_allocator(pool_allocator<U> const& b) noexcept { }
+
+    pointer allocate(size_type n) {
+        return static_cast<pointer>(memory_pool::allocate_bytes(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type n) noexcept {
+        memory_pool::deallocate_bytes(p, n * sizeof(T));
+    }
+
+    size_type max_size() const noexcept {
+        std::allocator<T> a;
+        return a.max_size();
+    }
+
+    template <typename C, class... Args>
+    void construct(C* c, Args&&... args) {
+        new ((void*)c) C(std::forward<Args>(args)...);
+    }
+
+    template <typename C>
+    void destroy(C* c) {
+        c->~C();
+    }
+
+    template <typename U>
+    bool operator == (pool_allocator<U> const& b) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator != (pool_allocator<U> const& b) const noexcept {
+        return false;
+    }
+};
+
+}
+
+/** @brief Releases the memory cached by the pools, to be called at the end of each site optimization */
+inline void trim_memory_pools()
+{
+#ifdef MAQUIS_POOL_ALLOCATOR
+    memory::memory_pool::trim();
+    if (memory::memory_pool* pool = memory::memory_pool::local())
+        pool->release();
+#endif
+}
+
+}
+
+#endif
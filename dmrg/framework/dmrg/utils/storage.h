@@ -12,12 +12,26 @@
 #include <boost/thread.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <fstream>
+#include <list>
+#include <memory>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "utils.hpp"
 #include "utils/timings.h"
 
+#include "dmrg/utils/aligned_allocator.hpp"
 #include "dmrg/utils/BaseParameters.h"
 #include "dmrg/utils/parallel/tracking.hpp"
 #include "dmrg/utils/parallel.hpp"
@@ -109,16 +123,256 @@ class fetch_request {};
 template<class T>
 class drop_request {};
 
+template<class T>
+class size_request {};
+
+namespace detail {
+
+// Alignment and size of the staging buffer used for the disk I/O
+constexpr std::size_t io_alignment = 4096;
+constexpr std::size_t io_buffer_size = 1024*io_alignment;
+
+using io_buffer_type = std::vector<char, maquis::aligned_allocator<char, io_alignment> >;
+
+/**
+ * @brief Staging buffer for the disk I/O.
+ * Each I/O thread owns its own buffer, which is allocated only once.
+ */
+inline io_buffer_type& io_buffer() {
+  static thread_local io_buffer_type buffer(io_buffer_size);
+  return buffer;
+}
+
+/**
+ * @brief Binary output stream that writes the data in large, aligned chunks.
+ *
+ * The data are collected in the staging buffer and written to disk only when the buffer
+ * is full, so that the size of the write operations does not depend on the size of the
+ * blocks (or of the columns of the blocks) that are stored.
+ */
+class staged_ofstream {
+public:
+  /** @brief Class constructor */
+  explicit staged_ofstream(std::string const& fp) : buffer(io_buffer()), pos(0) {
+    ofs.rdbuf()->pubsetbuf(0, 0);
+    ofs.open(fp.c_str(), std::ofstream::binary);
+    if (!ofs)
+      throw std::runtime_error("Cannot open " + fp + " to store the boundaries");
+  }
+
+  /** @brief Appends [n] bytes to the stream */
+  void write(const char* data, std::size_t n) {
+    while (n > 0) {
+      std::size_t chunk = std::min(n, buffer.size()-pos);
+      std::memcpy(&buffer[pos], data, chunk);
+      pos += chunk;
+      data += chunk;
+      n -= chunk;
+      if (pos == buffer.size())
+        flush();
+    }
+  }
+
+  /** @brief Writes the remaining data and closes the file */
+  void close() {
+    flush();
+    ofs.close();
+  }
+
+private:
+  void flush() {
+    ofs.write(&buffer[0], pos);
+    if (!ofs)
+      throw std::runtime_error("Error while storing the boundaries to disk");
+    pos = 0;
+  }
+
+  std::ofstream ofs;
+  io_buffer_type& buffer;
+  std::size_t pos;
+};
+
+/** @brief Binary input stream, counterpart of [staged_ofstream] */
+class staged_ifstream {
+public:
+  /** @brief Class constructor */
+  explicit staged_ifstream(std::string const& fp) : buffer(io_buffer()), pos(0), filled(0) {
+    ifs.rdbuf()->pubsetbuf(0, 0);
+    ifs.open(fp.c_str(), std::ifstream::binary);
+    if (!ifs)
+      throw std::runtime_error("Cannot open " + fp + " to load the boundaries");
+  }
+
+  /** @brief Extracts [n] bytes from the stream */
+  void read(char* data, std::size_t n) {
+    while (n > 0) {
+      if (pos == filled)
+        fill();
+      std::size_t chunk = std::min(n, filled-pos);
+      std::memcpy(data, &buffer[pos], chunk);
+      pos += chunk;
+      data += chunk;
+      n -= chunk;
+    }
+  }
+
+private:
+  void fill() {
+    ifs.read(&buffer[0], buffer.size());
+    filled = ifs.gcount();
+    pos = 0;
+    if (filled == 0)
+      throw std::runtime_error("Error while loading the boundaries from disk");
+  }
+
+  std::ifstream ifs;
+  io_buffer_type& buffer;
+  std::size_t pos, filled;
+};
+
+/**
+ * @brief Binary output stream writing into a memory-mapped file.
+ *
+ * The file is resized upfront to its final size and the data are copied into the mapping.
+ * Writing the pages back to disk is left to the kernel.
+ */
+class mapped_ofstream {
+public:
+  /** @brief Class constructor */
+  mapped_ofstream(std::string const& fp, std::size_t size) : size(size), pos(0), data(nullptr) {
+    fd = ::open(fp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+      throw std::runtime_error("Cannot open " + fp + " to store the boundaries");
+    if (size > 0) {
+      if (::ftruncate(fd, size) != 0)
+        throw std::runtime_error("Cannot resize " + fp + " to store the boundaries");
+      void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (ptr == MAP_FAILED)
+        throw std::runtime_error("Cannot map " + fp + " to store the boundaries");
+      data = static_cast<char*>(ptr);
+    }
+  }
+
+  /** @brief Class destructor */
+  ~mapped_ofstream() { close(); }
+
+  /** @brief Appends [n] bytes to the stream */
+  void write(const char* src, std::size_t n) {
+    assert(pos + n <= size);
+    std::memcpy(data + pos, src, n);
+    pos += n;
+  }
+
+  /** @brief Unmaps and closes the file */
+  void close() {
+    if (data)
+      ::munmap(data, size);
+    if (fd >= 0)
+      ::close(fd);
+    data = nullptr;
+    fd = -1;
+  }
+
+private:
+  int fd;
+  std::size_t size, pos;
+  char* data;
+};
+
+/**
+ * @brief Binary input stream reading from a memory-mapped file.
+ *
+ * The pages are loaded on demand when the data are copied out of the mapping. The kernel
+ * is told that the file is read sequentially, so that the read-ahead starts right away.
+ */
+class mapped_ifstream {
+public:
+  /** @brief Class constructor */
+  explicit mapped_ifstream(std::string const& fp) : size(0), pos(0), data(nullptr) {
+    fd = ::open(fp.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Cannot open " + fp + " to load the boundaries");
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+      throw std::runtime_error("Cannot stat " + fp + " to load the boundaries");
+    size = st.st_size;
+    if (size > 0) {
+      void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr == MAP_FAILED)
+        throw std::runtime_error("Cannot map " + fp + " to load the boundaries");
+      data = static_cast<char*>(ptr);
+      ::madvise(data, size, MADV_SEQUENTIAL);
+      ::madvise(data, size, MADV_WILLNEED);
+    }
+  }
+
+  /** @brief Class destructor */
+  ~mapped_ifstream() {
+    if (data)
+      ::munmap(data, size);
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  /** @brief Extracts [n] bytes from the stream */
+  void read(char* dst, std::size_t n) {
+    if (pos + n > size)
+      throw std::runtime_error("Error while loading the boundaries from disk");
+    std::memcpy(dst, data + pos, n);
+    pos += n;
+  }
+
+private:
+  int fd;
+  std::size_t size, pos;
+  char* data;
+};
+
+} // namespace detail
+
+/** @brief Functor class returning the memory (in bytes) occupied by a boundary */
+template<class Matrix, class SymmGroup>
+class size_request< Boundary<Matrix, SymmGroup> > {
+public:
+  /** @brief Class constructor */
+  size_request(Boundary<Matrix, SymmGroup> const* ptr) : ptr(ptr) { }
+
+  /** @brief Round braket operator */
+  std::size_t operator()() const {
+    Boundary<Matrix, SymmGroup> const& o = *ptr;
+    std::size_t ret = 0;
+    for (int b = 0; b < o.aux_dim(); ++b)
+      for (int k = 0; k < o[b].n_blocks(); ++k)
+        ret += num_rows(o[b][k])*num_cols(o[b][k])*sizeof(typename Matrix::value_type);
+    return ret;
+  }
+private:
+    Boundary<Matrix, SymmGroup> const* ptr;
+};
+
 /** @brief Functor class for the StoreToFile method, specialized for the boundaries */
 template<class Matrix, class SymmGroup>
 class StoreToFile_request< Boundary<Matrix, SymmGroup> > {
 public:
   /** @brief Class constructor */
-  StoreToFile_request(std::string fp, Boundary<Matrix, SymmGroup>* ptr) : fp(fp), ptr(ptr) { }
+  StoreToFile_request(std::string fp, Boundary<Matrix, SymmGroup>* ptr, bool mapped = false)
+    : fp(fp), ptr(ptr), mapped(mapped) { }
 
   /** @brief Round brackets operator */
   void operator()() {
-    std::ofstream ofs(fp.c_str(), std::ofstream::binary);
+    if (mapped) {
+      detail::mapped_ofstream ofs(fp, size_request<Boundary<Matrix, SymmGroup> >(ptr)());
+      store(ofs);
+    }
+    else {
+      detail::staged_ofstream ofs(fp);
+      store(ofs);
+    }
+  }
+private:
+  /** @brief Writes all the blocks of the boundary, one after the other, and frees them */
+  template<class OutputStream>
+  void store(OutputStream& ofs) {
     Boundary<Matrix, SymmGroup>& o = *ptr;
     auto loop_max = o.aux_dim();
     for (int b = 0; b < loop_max; ++b) {
@@ -132,9 +386,10 @@ public:
     }
     ofs.close();
   }
-private:
+
   std::string fp;
   Boundary<Matrix, SymmGroup>* ptr;
+  bool mapped;
 };
 
 /** @brief Functor class for the fetch method, specialized for the boundaries */
@@ -142,11 +397,24 @@ template<class Matrix, class SymmGroup>
 class fetch_request< Boundary<Matrix, SymmGroup> > {
 public:
   /** @brief Class constructor */
-  fetch_request(std::string fp, Boundary<Matrix, SymmGroup>* ptr) : fp(fp), ptr(ptr) { }
+  fetch_request(std::string fp, Boundary<Matrix, SymmGroup>* ptr, bool mapped = false)
+    : fp(fp), ptr(ptr), mapped(mapped) { }
 
   /** @brief Round braket operator */
   void operator()() {
-    std::ifstream ifs(fp.c_str(), std::ifstream::binary);
+    if (mapped) {
+      detail::mapped_ifstream ifs(fp);
+      load(ifs);
+    }
+    else {
+      detail::staged_ifstream ifs(fp);
+      load(ifs);
+    }
+  }
+private:
+  /** @brief Reallocates all the blocks of the boundary and reads them */
+  template<class InputStream>
+  void load(InputStream& ifs) {
     Boundary<Matrix, SymmGroup>& o = *ptr;
     auto loop_max = o.aux_dim();
     for (int b = 0; b < loop_max; ++b) {
@@ -158,11 +426,11 @@ public:
                  sizeof(typename Matrix::value_type)/sizeof(char));
       }
     }
-    ifs.close();
   }
-private:
+
   std::string fp;
   Boundary<Matrix, SymmGroup>* ptr;
+  bool mapped;
 };
 
 /** @brief Functor class for the drop method, specialized for the boundaries */
@@ -184,14 +452,93 @@ private:
     Boundary<Matrix, SymmGroup>* ptr;
 };
 
+/**
+ * @brief Fixed-size pool of threads executing the I/O requests.
+ *
+ * The requests are executed in the order in which they are submitted, and each
+ * request is associated with a future that is ready once the request is completed.
+ */
+class io_pool {
+public:
+  /** @brief Class constructor */
+  io_pool() : stop(false) {}
+
+  /** @brief Class destructor, completes all the pending requests */
+  ~io_pool() { resize(0); }
+
+  /** @brief Completes all the pending requests and restarts the pool with [n] threads */
+  void resize(std::size_t n) {
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+      stop = true;
+    }
+    condition.notify_all();
+    for (auto& worker: workers)
+      worker.join();
+    workers.clear();
+    stop = false;
+    for (std::size_t i = 0; i < n; ++i)
+      workers.emplace_back(&io_pool::work, this);
+  }
+
+  /** @brief Number of threads of the pool */
+  std::size_t size() const { return workers.size(); }
+
+  /** @brief Adds a request to the queue */
+  template<class Request>
+  std::shared_future<void> submit(Request request) {
+    if (workers.empty())
+      resize(1);
+    auto task = std::make_shared<std::packaged_task<void()> >(request);
+    std::shared_future<void> ret = task->get_future().share();
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+      tasks.push_back([task]() { (*task)(); });
+    }
+    condition.notify_one();
+    return ret;
+  }
+
+private:
+  /** @brief Loop executed by each thread of the pool */
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while (!stop && tasks.empty())
+          condition.wait(lock);
+        if (tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<boost::thread> workers;
+  std::deque<std::function<void()> > tasks;
+  boost::mutex mutex;
+  boost::condition_variable condition;
+  bool stop;
+};
+
 /**
  * @brief Specialization of the nop class for disk storage
  * Note that this class wraps two classes:
  *
  *  - descriptor, which represents an abstract object which is associated to
  *    a given status (describing whether it's currently being fetched, stored etc)
- *    and a given boost::thread that manages it.
+ *    and to the I/O request that is currently processing it.
  *
+ * The I/O requests are executed by a fixed pool of threads (see [io_pool]).
+ * If a memory budget is set, the objects that are passed to [StoreToFile] are not
+ * written to disk right away. They are kept in core and, when the overall memory
+ * they occupy exceeds the budget, the least recently used ones are stored.
+ * An object that is fetched again before being stored never touches the disk.
+ * The objects are written either through a staging buffer or, if [mapped] is true,
+ * in memory-mapped files (one per object).
  */
 class disk : public nop {
 public:
@@ -200,54 +547,59 @@ public:
   class descriptor {
   public:
     /** @brief Class constructor */
-    descriptor() : state(core), dumped(false), sid(disk::index()), worker(NULL) {}
+    descriptor() : state(core), dumped(false), cached(false), sid(disk::index()), record(0), bytes(0) {}
 
     /**
      * @brief Class destructor.
-     * Note that the descructor calls the join method on the boost::thread -- i.e.,
-     * completes the operation associated with the boost::thread.
+     * Note that the descructor calls the join method -- i.e., waits for the completion
+     * of the I/O request associated with the object.
      */
-    ~descriptor() { this->join(); }
+    virtual ~descriptor() { this->join(); }
 
     /**
-     * @brief Associated the object to a given thread.
+     * @brief Associates the object to a given I/O request.
      * Note that this method calls the disk::track method, which ensures that the corresponding
-     * thread is being "followed" by the memory manager.
+     * request is being "followed" by the memory manager.
      */
-    void thread(boost::thread* t){
-      this->worker = t;
+    void thread(std::shared_future<void> const& request){
+      this->worker = request;
       disk::track(this);
     }
 
     /**
-     * @brief Executes the thread.
+     * @brief Waits for the completion of the I/O request.
      * Similarly to the [thread] method, also here the disk::untrack method is called under the
-     * hood in order to not follow anymore this thread.
+     * hood in order to not follow anymore this request.
      */
     void join(){
-      if(this->worker){
-        this->worker->join();
-        delete this->worker;
-        this->worker = NULL;
+      if(this->worker.valid()){
+        std::shared_future<void> request = this->worker;
+        this->worker = std::shared_future<void>();
         disk::untrack(this);
+        request.get();
       }
     }
 
+    /** @brief Writes the object to disk, called when the memory budget is exceeded */
+    virtual void evict() = 0;
+
     // Enum class identifying the possible states of the object.
     enum { core, storing, uncore, prefetching } state;
 
     /** Class members */
-    bool dumped;					    // Bool keeping track of whether the object has been written to disk.
-    size_t sid;						    // Identifier of the memory
-    boost::thread* worker;	  // Boost thread managing the obect
-    size_t record;						// Size associated with the object.
+    bool dumped;                          // Bool keeping track of whether the object has been written to disk.
+    bool cached;                          // Bool keeping track of whether the object is in the LRU list.
+    size_t sid;                           // Identifier of the memory
+    std::shared_future<void> worker;      // I/O request managing the object
+    size_t record;                        // Position of the object in the tracking queue.
+    size_t bytes;                         // Memory occupied by the object when it was cached.
   };
 
   /**
    * @brief Class representing a serializable object.
    *
    * The class is inherited by [descriptor] such that the object is "equipped" with
-   * the boost::thread and with the flags describing its storing status.
+   * the I/O request and with the flags describing its storing status.
    *
    * @tparam T type associated with the serialized object.
    */
@@ -261,6 +613,7 @@ public:
      * with the object to be serialized
      */
     ~serializable() {
+      disk::uncache(this);
       // only delete existing file, too slow otherwise on NFS or similar
       if (dumped)
         std::remove(disk::fp(sid).c_str());
@@ -269,16 +622,21 @@ public:
     /** @brief Copy constructor */
     serializable& operator = (const serializable& rhs){
       this->join();
+      disk::uncache(this);
       if(dumped)
         std::remove(disk::fp(sid).c_str());
       descriptor::operator=(rhs);
+      this->cached = false;
       return *this;
     }
 
     /** @brief Fetching method */
     void fetch() {
-      if(this->state == core)
+      if(this->state == core) {
+        // The object is used again, so it cannot be evicted anymore
+        disk::uncache(this);
         return;
+      }
       else if(this->state == prefetching)
         this->join();
       // Cannot fetch something that is being stored
@@ -289,33 +647,41 @@ public:
 
     /** @brief Starts the fetching */
     void prefetch() {
-      // If already available on disk, does nothing. Otherwise, if it's being
-      // stored, finalized the storing such that afterwards one can call "fetch".
-      if(this->state == core)
+      // If already available in core, does nothing (apart from marking it as recently used).
+      // Otherwise, if it's being stored, finalized the storing such that afterwards one can call "fetch".
+      if(this->state == core) {
+        disk::touch(this);
         return;
+      }
       else if(this->state == prefetching)
         return;
       else if(this->state == storing)
         this->join();
       state = prefetching;
-      // This thread will be joined by [fetch]. Note that here we call the
+      // This request will be joined by [fetch]. Note that here we call the
       // functor class defined above.
-      this->thread(new boost::thread(fetch_request<T>(disk::fp(sid), (T*)this)));
+      this->thread(disk::pool().submit(fetch_request<T>(disk::fp(sid), (T*)this, disk::mapped())));
     }
 
-    /** @brief Storing to file method */
+    /** @brief Storing to file method -- the object is written to disk only if it does not fit in the memory budget */
     void StoreToFile(){
-      if(state == core) {
-        state = storing;
-        dumped = true;
-        parallel::sync();
-        this->thread(new boost::thread(StoreToFile_request<T>(disk::fp(sid), (T*)this)));
-      }
+      if(state == core)
+        disk::cache(this, size_request<T>((T*)this)());
       assert(this->state != prefetching);
     }
 
+    /** @brief Writes the object to disk */
+    void evict() override {
+      assert(this->state == core);
+      state = storing;
+      dumped = true;
+      parallel::sync();
+      this->thread(disk::pool().submit(StoreToFile_request<T>(disk::fp(sid), (T*)this, disk::mapped())));
+    }
+
     /** @brief Free the memory */
     void drop(){
+      disk::uncache(this);
       if(dumped)
         std::remove(disk::fp(sid).c_str());
       if(state == core)
@@ -338,22 +704,37 @@ public:
   /**
    * @brief Initialization of the memory.
    * @param path file where the object will be dumped.
+   * @param memory memory budget (in MB) for the objects that are kept in core after StoreToFile.
+   * @param nthreads number of threads performing the I/O operations.
+   * @param mapped if true, the objects are written to/read from memory-mapped files.
    */
-  static void init(const std::string& path){
+  static void init(const std::string& path, double memory = 0., int nthreads = 1, bool mapped = false){
     maquis::cout << "Temporary storage enabled in " << path << "\n";
+    if (memory > 0.)
+      maquis::cout << "Boundaries stored only beyond a memory budget of " << memory << " MB\n";
+    if (mapped)
+      maquis::cout << "Boundaries stored in memory-mapped files\n";
     instance().active = true;
     instance().path = path;
+    instance().budget = static_cast<size_t>(memory*1024.*1024.);
+    instance().use_mmap = mapped;
+    instance().io.resize(std::max(nthreads, 1));
   }
 
   /** @brief Disables the storage to file */
   static void disable() {
     instance().active = false;
     instance().path = "";
+    instance().budget = 0;
+    instance().use_mmap = false;
   }
 
   /** @brief Checks if memory dumping has been enabled */
   static bool enabled() { return instance().active; }
 
+  /** @brief Checks if the objects are stored in memory-mapped files */
+  static bool mapped() { return instance().use_mmap; }
+
   /** @brief Generates the path where a given id is stored */
   static std::string fp(size_t sid){
     return (instance().path + boost::lexical_cast<std::string>(sid));
@@ -364,6 +745,11 @@ public:
     return instance().sid++;
   }
 
+  /** @brief Pool of threads executing the I/O requests */
+  static io_pool& pool(){
+    return instance().io;
+  }
+
   /** @brief Adds a descriptor to the object to be tracked */
   static void track(descriptor* d){
     d->record = instance().queue.size();
@@ -375,6 +761,50 @@ public:
       instance().queue[d->record] = NULL;
   }
 
+  /**
+   * @brief Adds a descriptor to the LRU list of the objects kept in core.
+   * The least recently used objects are evicted (i.e., written to disk) until the memory
+   * occupied by the cached objects fits in the budget.
+   */
+  static void cache(descriptor* d, size_t bytes){
+    disk& self = instance();
+    uncache(d);
+    d->bytes = bytes;
+    d->cached = true;
+    self.lru.push_front(d);
+    self.cached_bytes += bytes;
+    while (self.cached_bytes > self.budget && !self.lru.empty()) {
+      descriptor* last = self.lru.back();
+      self.lru.pop_back();
+      self.cached_bytes -= last->bytes;
+      last->cached = false;
+      last->evict();
+    }
+  }
+
+  /** @brief Removes a descriptor from the LRU list */
+  static void uncache(descriptor* d){
+    if (!d->cached)
+      return;
+    disk& self = instance();
+    auto it = std::find(self.lru.begin(), self.lru.end(), d);
+    if (it != self.lru.end()) {
+      self.cached_bytes -= d->bytes;
+      self.lru.erase(it);
+    }
+    d->cached = false;
+  }
+
+  /** @brief Marks a descriptor as the most recently used one */
+  static void touch(descriptor* d){
+    if (!d->cached)
+      return;
+    disk& self = instance();
+    auto it = std::find(self.lru.begin(), self.lru.end(), d);
+    if (it != self.lru.end())
+      self.lru.splice(self.lru.begin(), self.lru, it);
+  }
+
   /** @brief Syncs all the processes that are queued */
   static void sync(){
     for(int i = 0; i < instance().queue.size(); ++i)
@@ -400,10 +830,8 @@ public:
   /** @brief Stores a serializable object on disk */
   template<class T>
   static void StoreToFile(serializable<T>& t) {
-    if (enabled()) {
-      std::cout << "I AM ACTUALLY STORING TO FILE" << std::endl;
+    if (enabled())
       t.StoreToFile();
-    }
   }
 
   /** @brief Drops the memory associated with a serializable object */
@@ -418,13 +846,18 @@ public:
   static void StoreToFile(MPSTensor<Matrix, SymmGroup>& t){ }
 
   /** @brief Constructor for a disk (but should be made private in agreement with the singleton)*/
-  disk() : active(false), sid(0) {}
+  disk() : active(false), use_mmap(false), sid(0), budget(0), cached_bytes(0) {}
 
   // Class members
   std::vector<descriptor*> queue; // List of objects to be tracked
-  std::string path;							  // Location where the objects are stored
-  bool active;									  // Whether in-disk storage is activated or not
-  size_t sid;										  // Last used index
+  std::list<descriptor*> lru;     // Objects kept in core, from the most to the least recently used
+  std::string path;               // Location where the objects are stored
+  bool active;                    // Whether in-disk storage is activated or not
+  bool use_mmap;                  // Whether the objects are stored in memory-mapped files
+  size_t sid;                     // Last used index
+  size_t budget;                  // Memory (in bytes) available for the objects in the LRU list
+  size_t cached_bytes;            // Memory (in bytes) occupied by the objects in the LRU list
+  io_pool io;                     // Threads executing the I/O requests
 };
 
 template<typename T, class Scheduler>
@@ -451,7 +884,12 @@ inline static void setup(BaseParameters& parms)
       maquis::cerr << "Error creating dir/file at " << dp << ". Try different 'storagedir'.\n";
       throw;
     }
-    storage::disk::init(dp.string());
+    double memory = parms.is_set("storage_memory") ? parms["storage_memory"].as<double>() : 0.;
+    int nthreads = parms.is_set("storage_io_threads") ? parms["storage_io_threads"].as<int>() : 1;
+    std::string mode = parms.is_set("storage_mode") ? parms["storage_mode"].as<std::string>() : "stream";
+    if (mode != "stream" && mode != "mmap")
+      throw std::runtime_error("storage_mode " + mode + " not recognized, use stream or mmap");
+    storage::disk::init(dp.string(), memory, nthreads, mode == "mmap");
   }
   else {
     storage::disk::disable();
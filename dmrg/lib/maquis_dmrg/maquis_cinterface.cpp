@@ -304,6 +304,7 @@ extern "C"
     BaseParameters meas_parms = parms.measurements(); \
     parms.erase_measurements(); \
     parms.set("MEASURE[" #N "rdm]", 1); \
+    maquis::interface_detail::keep_rdm_partition(parms, meas_parms); \
     qcmaquis_interface_set_state(state); \
     interface_ptr->measure_and_save_ ## N ## rdm(); \
     parms.erase_measurements(); \
@@ -404,6 +405,12 @@ extern "C"
         stdout_redirect.restore();
     }
 
+    void qcmaquis_interface_set_rdm_partition(int index, int count)
+    {
+        parms.set("MEASURE_PARTITION[index]", index);
+        parms.set("MEASURE_PARTITION[count]", count);
+    }
+
     int qcmaquis_interface_get_4rdm_elements(int L, const int* slice)
     {
         std::vector<int> slice_ = slice != nullptr ? std::vector<int>(slice, slice+3) : std::vector<int>();
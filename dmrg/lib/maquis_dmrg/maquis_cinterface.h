@@ -110,6 +110,11 @@ extern "C"
     void qcmaquis_interface_measure_and_save_4rdm(int state);
     void qcmaquis_interface_measure_and_save_trans3rdm(int state, int bra_state);
 
+    // Divide the 3/4-RDM elements measured by measure_and_save_3rdm/4rdm into [count] parts of equal cost
+    // and only measure the part [index] (starting from 0), so that the parts can be measured by independent processes.
+    // Each part is saved with its labels, as for the slices. count = 1 measures all elements.
+    void qcmaquis_interface_set_rdm_partition(int index, int count);
+
     // Measure overlap
     double qcmaquis_interface_get_overlap(const char* filename);
 
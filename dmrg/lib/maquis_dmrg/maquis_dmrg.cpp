@@ -214,6 +214,7 @@ namespace maquis
         BaseParameters meas_parms = parms.measurements(); \
         parms.erase_measurements(); \
         parms.set("MEASURE[" #N "rdm]", 1); \
+        maquis::interface_detail::keep_rdm_partition(parms, meas_parms); \
         impl_->sim->run_measure(); \
         parms.erase_measurements(); \
         parms << meas_parms
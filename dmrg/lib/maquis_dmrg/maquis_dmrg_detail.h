@@ -48,6 +48,16 @@ namespace maquis {
             std::string ret = pname + ".trans3rdm." + std::to_string(state) + "_" + std::to_string(bra_state) + ".h5";
             return ret;
         }
+
+        // Copies the partition of the 3/4-RDM elements from the measurement parameters [meas_parms] back to [parms],
+        // after the other measurements have been erased
+        inline void keep_rdm_partition(BaseParameters& parms, BaseParameters& meas_parms)
+        {
+            if (meas_parms.is_set("MEASURE_PARTITION[count]")) {
+                parms.set("MEASURE_PARTITION[count]", meas_parms["MEASURE_PARTITION[count]"].str());
+                parms.set("MEASURE_PARTITION[index]", meas_parms["MEASURE_PARTITION[index]"].str());
+            }
+        }
     }
 
     // Set parameters required for relativistic calculation
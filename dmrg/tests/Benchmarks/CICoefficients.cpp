@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MODULE CICoefficients
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <boost/test/included/unit_test.hpp>
+#include "dmrg/models/lattice/lattice.h"
+#include "dmrg/models/model.h"
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mps_ci_expansion.h"
+#include "dmrg/sim/matrix_types.h"
+#include "maquis_dmrg.h"
+#include "../../applications/tools/ci_encode.hpp"
+
+#ifdef HAVE_TwoU1PG
+
+using ExpansionType = MPSCIExpansion<matrix, TwoU1PG>;
+
+/** @brief Recursively generates all determinants with [nUp] and [nDown] electrons */
+void generateDeterminants(MPS<matrix, TwoU1PG> const & mps, int nUp, int nDown, ExpansionType::Determinant & prefix,
+                          std::vector<ExpansionType::Determinant> & determinants)
+{
+    std::size_t p = prefix.size();
+    if (p == mps.length()) {
+        if (nUp == 0 && nDown == 0)
+            determinants.push_back(prefix);
+        return;
+    }
+    int nLeft = mps.length() - p;
+    if (nUp > nLeft || nDown > nLeft)
+        return;
+    for (std::size_t s = 0; s < mps[p].site_dim().size(); ++s) {
+        auto siteCharge = mps[p].site_dim()[s].first;
+        if (siteCharge[0] > nUp || siteCharge[1] > nDown)
+            continue;
+        prefix.push_back(siteCharge);
+        generateDeterminants(mps, nUp-siteCharge[0], nDown-siteCharge[1], prefix, determinants);
+        prefix.pop_back();
+    }
+}
+
+/**
+ * @brief Benchmark of the CI reconstruction of a half-filled 12-site Hubbard chain (853776 determinants).
+ *
+ * The MPS is random, with m = 128. The batched evaluation of all the determinants is compared with the
+ * legacy extract_coefficient, which is timed on a random subset only and extrapolated, and with
+ * the perfect sampling of 10^6 determinants. The timings are printed, and the coefficients must agree.
+ */
+BOOST_AUTO_TEST_CASE(Benchmark_CICoefficients_Hubbard)
+{
+    int L = 12;
+    maquis::integral_map<double> integrals;
+    for (int i = 1; i <= L; i++) {
+        integrals[{i, i, i, i}] = 4.;
+        if (i < L)
+            integrals[{i+1, i, 0, 0}] = -1.;
+    }
+    DmrgParameters parameters;
+    parameters.set("integrals_binary", maquis::serialize(integrals));
+    parameters.set("L", L);
+    parameters.set("site_types", "0,0,0,0,0,0,0,0,0,0,0,0");
+    parameters.set("irrep", 0);
+    parameters.set("u1_total_charge1", L/2);
+    parameters.set("u1_total_charge2", L/2);
+    parameters.set("symmetry", "2u1pg");
+    parameters.set("init_type", "default");
+    parameters.set("init_bond_dimension", 128);
+    parameters.set("seed", 1234);
+    auto lattice = Lattice(parameters);
+    auto model = Model<matrix, TwoU1PG>(lattice, parameters);
+    auto mps = MPS<matrix, TwoU1PG>(lattice.size(), *(model.initializer(lattice, parameters)));
+    mps.normalize_right();
+    std::vector<ExpansionType::Determinant> determinants;
+    ExpansionType::Determinant prefix;
+    generateDeterminants(mps, L/2, L/2, prefix, determinants);
+    std::shuffle(determinants.begin(), determinants.end(), std::mt19937(1234));
+    // Batched evaluation
+    auto start = std::chrono::high_resolution_clock::now();
+    auto expansion = ExpansionType(mps);
+    auto coefficients = expansion.coefficients(determinants);
+    double timeBatched = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    double sumOfSquares = 0.;
+    for (auto const & coefficient : coefficients)
+        sumOfSquares += coefficient*coefficient;
+    BOOST_CHECK_CLOSE(sumOfSquares, 1., 1.0E-8);
+    // Legacy evaluation, one determinant at a time
+    std::size_t nLegacy = 20000;
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<double> legacyCoefficients;
+    for (std::size_t i = 0; i < nLegacy; ++i)
+        legacyCoefficients.push_back(extract_coefficient(mps, determinants[i]));
+    double timeLegacy = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    for (std::size_t i = 0; i < nLegacy; ++i)
+        BOOST_CHECK_SMALL(legacyCoefficients[i] - coefficients[i], 1.0E-12);
+    // Perfect sampling
+    std::mt19937 generator(1234);
+    start = std::chrono::high_resolution_clock::now();
+    auto samples = expansion.sample(1000000, generator);
+    double timeSampling = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "CI coefficients of " << determinants.size() << " determinants" << std::endl
+              << " batched: " << timeBatched << " s" << std::endl
+              << " legacy:  " << timeLegacy*determinants.size()/nLegacy << " s (extrapolated from "
+              << nLegacy << " determinants)" << std::endl
+              << " perfect sampling of 10^6 determinants: " << timeSampling << " s ("
+              << samples.size() << " distinct)" << std::endl;
+}
+
+#endif // HAVE_TwoU1PG
@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MODULE MicroKernels
+
+#include <chrono>
+#include <iostream>
+#include <boost/test/included/unit_test.hpp>
+#include "dmrg/models/model.h"
+#include "dmrg/models/generate_mpo.hpp"
+#include "dmrg/models/lattice/lattice.h"
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mpo.h"
+#include "dmrg/mp_tensors/contractions.h"
+#include "dmrg/sim/matrix_types.h"
+#include "Fixtures/BenzeneFixture.h"
+
+#ifdef HAVE_SU2U1PG
+
+/**
+ * @brief Microbenchmark of the SU2 rbtm micro tasks.
+ *
+ * The task lists are generated exactly as in site_hamil_rbtm for the central site of
+ * benzene, with a random MPS spanning the full CAS(6,6) space. Each output block is
+ * then executed both task-by-task and with the fused executor.
+ * The timings are printed, and the two results must agree.
+ */
+BOOST_FIXTURE_TEST_CASE(Benchmark_SU2_TaskAxpy, BenzeneFixture)
+{
+  using S = SU2U1PG;
+  using charge = typename S::charge;
+  using value_type = typename matrix::value_type;
+  using BoundaryType = Boundary<typename storage::constrained<matrix>::type, S>;
+  using contr = contraction::Engine<matrix, typename storage::constrained<matrix>::type, S>;
+  using micro_task = typename contraction::SU2::task_capsule<matrix, S>::micro_task;
+  parametersBenzene.set("init_type", "default");
+  parametersBenzene.set("seed", 1234);
+  auto lattice = Lattice(parametersBenzene);
+  auto model = Model<matrix, S>(lattice, parametersBenzene);
+  auto mpo = make_mpo(lattice, model);
+  auto mps = MPS<matrix, S>(lattice.size(), *(model.initializer(lattice, parametersBenzene)));
+  int site = lattice.size()/2;
+  mps.canonize(site);
+  // Boundaries around the central site
+  BoundaryType left = mps.left_boundary(), right = mps.right_boundary();
+  for (int iSite = 0; iSite < site; iSite++)
+    left = contr::overlap_mpo_left_step(mps[iSite], mps[iSite], left, mpo[iSite]);
+  for (int iSite = lattice.size()-1; iSite > site; iSite--)
+    right = contr::overlap_mpo_right_step(mps[iSite], mps[iSite], right, mpo[iSite]);
+  // Task generation, as in site_hamil_rbtm
+  auto ket = mps[site];
+  ket.make_left_paired();
+  Index<S> indexForTrim = ket.data().left_basis();
+  contraction::common::MPSBoundaryProduct<matrix, matrix, S, ::SU2::SU2Gemms> t(ket, right, mpo[site], indexForTrim);
+  Index<S> const & physical_i = ket.site_dim(), right_i = ket.col_dim();
+  Index<S> left_i = ket.row_dim(), out_right_i = adjoin(physical_i) * right_i;
+  common_subset(out_right_i, left_i);
+  ProductBasis<S> in_left_pb(physical_i, left_i);
+  ProductBasis<S> out_right_pb(physical_i, right_i,
+                               boost::lambda::bind(static_cast<charge(*)(charge, charge)>(S::fuse),
+                                                   -boost::lambda::_1, boost::lambda::_2));
+  std::vector<std::vector<micro_task> > taskLists;
+  std::vector<std::size_t> columns;
+  for (std::size_t b1 = 0; b1 < mpo[site].row_dim(); b1++) {
+    contraction::SU2::task_capsule<matrix, S> tasks_cap;
+    contraction::SU2::rbtm_tasks(b1, t, mpo[site], ket.data().basis(), left_i, out_right_i, in_left_pb, out_right_pb, tasks_cap);
+    for (auto& block : tasks_cap.tasks) {
+      if (block.second.size() == 0)
+        continue;
+      std::sort(block.second.begin(), block.second.end(), contraction::SU2::detail::task_compare<value_type>());
+      taskLists.push_back(block.second);
+      columns.push_back(out_right_i.size_of_block(block.first.second));
+    }
+  }
+  // Statistics of the task distribution
+  std::size_t nTasks = 0, nStripes = 0, nElements = 0;
+  for (auto const& tasks : taskLists) {
+    nTasks += tasks.size();
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+      nElements += tasks[i].l_size*tasks[i].r_size;
+      if (i == 0 || tasks[i].out_offset != tasks[i-1].out_offset || tasks[i].r_size != tasks[i-1].r_size)
+        nStripes++;
+    }
+  }
+  BOOST_REQUIRE(nTasks > 0);
+  std::cout << "Output blocks: " << taskLists.size() << ", tasks: " << nTasks
+            << ", tasks per output stripe: " << double(nTasks)/nStripes
+            << ", elements per task: " << double(nElements)/nTasks << std::endl;
+  // Timings
+  auto source = [&t](micro_task const& task) { return &t.at(task.b2)[task.k](0,0) + task.in_offset; };
+  const int nRepetitions = 200;
+  std::vector<matrix> reference, fused;
+  for (std::size_t i = 0; i < taskLists.size(); i++) {
+    reference.push_back(matrix(taskLists[i][0].l_size, columns[i]));
+    fused.push_back(matrix(taskLists[i][0].l_size, columns[i]));
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int iRep = 0; iRep < nRepetitions; iRep++)
+    for (std::size_t i = 0; i < taskLists.size(); i++)
+      for (auto const& task : taskLists[i])
+        contraction::SU2::detail::task_axpy(task, &reference[i](0,0), source(task));
+  auto timeReference = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  start = std::chrono::high_resolution_clock::now();
+  for (int iRep = 0; iRep < nRepetitions; iRep++)
+    for (std::size_t i = 0; i < taskLists.size(); i++)
+      contraction::SU2::detail::task_axpy_fused(taskLists[i].cbegin(), taskLists[i].cend(), &fused[i](0,0), source);
+  auto timeFused = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  std::cout << "task_axpy: " << timeReference << " s, task_axpy_fused: " << timeFused << " s" << std::endl;
+  // Consistency check
+  for (std::size_t i = 0; i < taskLists.size(); i++)
+    for (std::size_t iCol = 0; iCol < num_cols(reference[i]); iCol++)
+      for (std::size_t iRow = 0; iRow < num_rows(reference[i]); iRow++)
+        BOOST_REQUIRE_SMALL(reference[i](iRow, iCol) - fused[i](iRow, iCol), 1.0E-10*(1.+std::abs(reference[i](iRow, iCol))));
+}
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MODULE ParallelDMRG
+
+#include <chrono>
+#include <iostream>
+#include <boost/mpi.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include "dmrg/SweepBasedAlgorithms/ParallelSweepBasedEnergyMinimization.h"
+#include "dmrg/block_matrix/symmetry.h"
+#include "dmrg/models/generate_mpo.hpp"
+#include "dmrg/models/lattice/lattice.h"
+#include "dmrg/models/model.h"
+#include "dmrg/sim/matrix_types.h"
+#include "maquis_dmrg.h"
+
+/**
+ * Scaling benchmark of the real-space parallel DMRG on long chains.
+ * Run it as `mpirun -np P bench_pdmrg` for increasing P: the first rank prints the wall time
+ * of the construction (which is not parallel) and of the sweeps, and the final energy.
+ */
+
+struct MPIEnvironmentFixture {
+  boost::mpi::environment environment;
+};
+
+BOOST_GLOBAL_FIXTURE(MPIEnvironmentFixture);
+
+/** @brief Times the optimization of the given model and prints the results on the first rank */
+template<class SymmGroup>
+void benchmarkParallelDMRG(DmrgParameters& parameters, std::string name)
+{
+  using OptimizerType = ParallelSweepBasedEnergyMinimization<matrix, SymmGroup, storage::disk>;
+  boost::mpi::communicator comm;
+  auto lattice = Lattice(parameters);
+  auto model = Model<matrix, SymmGroup>(lattice, parameters);
+  auto mpo = make_mpo(lattice, model);
+  auto mps = MPS<matrix, SymmGroup>(lattice.size(), *(model.initializer(lattice, parameters)));
+  comm.barrier();
+  auto start = std::chrono::high_resolution_clock::now();
+  OptimizerType optimizer(mps, mpo, parameters, model, lattice, false, comm);
+  comm.barrier();
+  auto timeSetUp = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  start = std::chrono::high_resolution_clock::now();
+  optimizer.runSweepSimulation();
+  comm.barrier();
+  auto timeSweeps = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  if (comm.rank() == 0)
+    std::cout << name << " (L = " << lattice.size() << ", " << comm.size() << " ranks): set-up " << timeSetUp
+              << " s, sweeps " << timeSweeps << " s, energy " << std::setprecision(12)
+              << optimizer.template getSpecificResult<double>("Energy") << std::endl;
+}
+
+#ifdef HAVE_TwoU1PG
+
+/** @brief Half-filled Hubbard chain with U/t = 4 */
+BOOST_AUTO_TEST_CASE(Benchmark_ParallelDMRG_Hubbard)
+{
+  int L = 100;
+  maquis::integral_map<double> integrals;
+  for (int i = 1; i <= L; i++) {
+    integrals[{i, i, i, i}] = 4.;
+    if (i < L)
+      integrals[{i+1, i, 0, 0}] = -1.;
+  }
+  DmrgParameters parameters;
+  parameters.set("integrals_binary", maquis::serialize(integrals));
+  parameters.set("L", L);
+  std::string siteTypes = "0";
+  for (int i = 1; i < L; i++)
+    siteTypes += ",0";
+  parameters.set("site_types", siteTypes);
+  parameters.set("irrep", 0);
+  parameters.set("u1_total_charge1", L/2);
+  parameters.set("u1_total_charge2", L/2);
+  parameters.set("symmetry", "2u1pg");
+  parameters.set("init_type", "default");
+  parameters.set("seed", 1234);
+  parameters.set("nsweeps", 4);
+  parameters.set("max_bond_dimension", 64);
+  benchmarkParallelDMRG<TwoU1PG>(parameters, "Hubbard chain");
+}
+
+#endif // HAVE_TwoU1PG
+
+#if defined(DMRG_VIBRATIONAL) && defined(HAVE_TrivialGroup)
+
+/** @brief Chain of harmonic oscillators with nearest-neighbour bilinear couplings */
+BOOST_AUTO_TEST_CASE(Benchmark_ParallelDMRG_Watson)
+{
+  int L = 100;
+  maquis::integral_map<double, chem::Hamiltonian::VibrationalCanonical> integrals;
+  for (int i = 1; i <= L; i++) {
+    double frequency = 1. + 0.01*i;
+    integrals[{i, i, 0, 0, 0, 0}] = frequency/4.;
+    integrals[{-i, -i, 0, 0, 0, 0}] = -frequency/4.;
+    if (i < L)
+      integrals[{i, i+1, 0, 0, 0, 0}] = 0.05;
+  }
+  DmrgParameters parameters;
+  parameters.set("integrals_binary", maquis::serialize(integrals));
+  parameters.set("L", L);
+  parameters.set("symmetry", "none");
+  parameters.set("LATTICE", "watson lattice");
+  parameters.set("MODEL", "watson");
+  parameters.set("Nmax", 6);
+  parameters.set("watson_max_coupling_input", 2);
+  parameters.set("init_type", "default");
+  parameters.set("seed", 1234);
+  parameters.set("nsweeps", 4);
+  parameters.set("max_bond_dimension", 32);
+  benchmarkParallelDMRG<TrivialGroup>(parameters, "Watson chain");
+}
+
+#endif // DMRG_VIBRATIONAL && HAVE_TrivialGroup
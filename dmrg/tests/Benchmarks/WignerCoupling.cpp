@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MODULE WignerCoupling
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <boost/test/included/unit_test.hpp>
+#include "dmrg/block_matrix/symmetry/gsl_coupling.h"
+#include "dmrg/block_matrix/symmetry/hash_tuple.h"
+
+/**
+ * @brief Microbenchmark of the Wigner 9j lookup.
+ *
+ * Compares the dense SU2::Wigner9jTable with the unordered_map cache previously used by the
+ * WignerWrapper (same key, same hash and same filling), and with the direct calculation.
+ * The symbols are drawn at random with the pattern of the SU2 contractions, i.e. with
+ * operator spins <= 2. The timings are printed, and all the values must agree.
+ */
+BOOST_AUTO_TEST_CASE(Benchmark_Wigner9j_Lookup)
+{
+  using key_type = std::tuple<int, int, int, int, int, int, int, int, int>;
+  using map_type = std::unordered_map<key_type, double, hash_tuple::hash<key_type> >;
+  const int maxSpin = 16;
+  // Map cache, filled as in the former WignerWrapper::fill_cache
+  auto start = std::chrono::high_resolution_clock::now();
+  map_type map;
+  for (int i = 0; i <= maxSpin; i++)
+  for (int j = 0; j <= 2; j++)
+  for (int k = 0; k <= maxSpin; k++)
+  for (int l = 0; l <= 2; l++)
+  for (int m = 0; m <= 2; m++)
+  for (int n = 0; n <= 2; n++)
+  for (int o = 0; o <= maxSpin; o++)
+  for (int p = 0; p <= 2; p++)
+  for (int q = 0; q <= maxSpin; q++)
+  {
+    if ((l == m && m == n) && (l != 0)) continue;
+    if (!WignerWrapper::triangle_9j_fails(i,j,k,l,m,n,o,p,q))
+      map[std::make_tuple(i,j,k,l,m,n,o,p,q)] = gsl_sf_coupling_9j(i,j,k,l,m,n,o,p,q);
+  }
+  auto timeFillMap = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  start = std::chrono::high_resolution_clock::now();
+  SU2::Wigner9jTable table;
+  table.reserve(maxSpin);
+  auto timeFillTable = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  std::cout << "Fill: map " << map.size() << " elements in " << timeFillMap << " s, table "
+            << table.filled_slabs()*SU2::Wigner9jTable::slab_size << " elements in " << timeFillTable << " s" << std::endl;
+  // Random symbols satisfying the triangle conditions
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> spin(0, maxSpin-2), op(0, 2), delta(-2, 2);
+  std::vector<std::array<int, 9> > symbols;
+  while (symbols.size() < 100000) {
+    std::array<int, 9> s;
+    s[0] = spin(rng);
+    s[2] = s[0] + delta(rng);
+    s[6] = s[0] + delta(rng);
+    s[8] = s[6] + delta(rng);
+    s[1] = op(rng); s[3] = op(rng); s[4] = op(rng); s[5] = op(rng); s[7] = op(rng);
+    if (s[8] > maxSpin || (s[3] == s[4] && s[4] == s[5] && s[3] != 0)
+        || WignerWrapper::triangle_9j_fails(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8]))
+      continue;
+    symbols.push_back(s);
+  }
+  // Timings
+  const int nRepetitions = 20;
+  double sumMap = 0., sumTable = 0., sumDirect = 0.;
+  start = std::chrono::high_resolution_clock::now();
+  for (int iRep = 0; iRep < nRepetitions; iRep++)
+    for (auto const& s : symbols)
+      sumMap += map.find(std::make_tuple(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8]))->second;
+  auto timeMap = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  start = std::chrono::high_resolution_clock::now();
+  for (int iRep = 0; iRep < nRepetitions; iRep++)
+    for (auto const& s : symbols) {
+      double value;
+      table.lookup(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8], value);
+      sumTable += value;
+    }
+  auto timeTable = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  start = std::chrono::high_resolution_clock::now();
+  for (auto const& s : symbols)
+    sumDirect += gsl_sf_coupling_9j(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8]);
+  auto timeDirect = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  double nLookups = double(nRepetitions)*symbols.size();
+  std::cout << "Lookup: map " << 1.0E9*timeMap/nLookups << " ns, table " << 1.0E9*timeTable/nLookups
+            << " ns, direct " << 1.0E9*timeDirect/symbols.size() << " ns" << std::endl;
+  // Consistency check
+  BOOST_CHECK_SMALL(sumMap - sumTable, 1.0E-8*(1.+std::abs(sumMap)));
+  BOOST_CHECK_SMALL(sumMap - nRepetitions*sumDirect, 1.0E-8*(1.+std::abs(sumMap)));
+  for (auto const& s : symbols) {
+    double value;
+    BOOST_REQUIRE(table.lookup(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8], value));
+    BOOST_REQUIRE_SMALL(value - map[std::make_tuple(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8])], 1.0E-14);
+  }
+}
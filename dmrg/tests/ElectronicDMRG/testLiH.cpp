@@ -78,6 +78,117 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(Test_LiH_DMRG_BoundaryStorage, S, symmetries, L
   boost::filesystem::remove_all("tmpDMRGTS");
 }
 
+/** @brief Test single-site DMRG with the controlled bond expansion, starting from a MPS with m=1 */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(Test_LiH_DMRG_ControlledBondExpansion, S, symmetries, LiHFixture)
+{
+  // Generic parameters
+  parametersLiH.set("max_bond_dimension", 50);
+  parametersLiH.set("init_type", "default");
+  parametersLiH.set("init_bond_dimension", 1);
+  parametersLiH.set("seed", 98789);
+  parametersLiH.set("symmetry", symm_traits::SymmetryNameTrait<S>::symmName());
+  parametersLiH.set("nsweeps", 20);
+  parametersLiH.set("ngrowsweeps", 2);
+  parametersLiH.set("nmainsweeps", 5);
+  parametersLiH.set("optimization", "singlesite");
+  parametersLiH.set("singlesite_noise", "cbe");
+  parametersLiH.set("alpha_initial", 1.0E-4);
+  parametersLiH.set("alpha_main", 1.0E-8);
+  parametersLiH.set("alpha_final", 0.);
+  maquis::DMRGInterface<double> optimizer(parametersLiH);
+  optimizer.optimize();
+  BOOST_CHECK_CLOSE(optimizer.energy(), referenceEnergy, 1.0e-7);
+}
+
+/** @brief Test conventional DMRG with a memory budget for the boundaries, such that only part of them is dumped to file */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(Test_LiH_DMRG_BoundaryStorageBudget, S, symmetries, LiHFixture)
+{
+  // Generic parameters
+  parametersLiH.set("max_bond_dimension", 50);
+  parametersLiH.set("init_type", "default");
+  parametersLiH.set("seed", 98789);
+  parametersLiH.set("symmetry", symm_traits::SymmetryNameTrait<S>::symmName());
+  parametersLiH.set("nsweeps", 20);
+  parametersLiH.set("ngrowsweeps", 2);
+  parametersLiH.set("nmainsweeps", 5);
+  parametersLiH.set("optimization", "twosite");
+  parametersLiH.set("alpha_initial", 1.0E-8);
+  parametersLiH.set("alpha_main", 1.0E-15);
+  parametersLiH.set("alpha_final", 0.);
+  // Calculation without storage
+  maquis::DMRGInterface<double> optimizer(parametersLiH);
+  optimizer.optimize();
+  auto energy = optimizer.energy();
+  // Same calculation with a budget that holds only a fraction of the boundaries
+  parametersLiH.set("storagedir", "tmpDMRGBudget");
+  parametersLiH.set("storage_memory", 0.01);
+  parametersLiH.set("storage_io_threads", 2);
+  maquis::DMRGInterface<double> optimizerBudget(parametersLiH);
+  optimizerBudget.optimize();
+  auto energyBudget = optimizerBudget.energy();
+  BOOST_CHECK_CLOSE(energy, energyBudget, 1.0E-10);
+  boost::filesystem::remove_all("tmpDMRGBudget");
+}
+
+/** @brief Test conventional DMRG with the boundaries stored in memory-mapped files */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(Test_LiH_DMRG_BoundaryStorageMmap, S, symmetries, LiHFixture)
+{
+  // Generic parameters
+  parametersLiH.set("max_bond_dimension", 50);
+  parametersLiH.set("init_type", "default");
+  parametersLiH.set("seed", 98789);
+  parametersLiH.set("symmetry", symm_traits::SymmetryNameTrait<S>::symmName());
+  parametersLiH.set("nsweeps", 20);
+  parametersLiH.set("ngrowsweeps", 2);
+  parametersLiH.set("nmainsweeps", 5);
+  parametersLiH.set("optimization", "twosite");
+  parametersLiH.set("alpha_initial", 1.0E-8);
+  parametersLiH.set("alpha_main", 1.0E-15);
+  parametersLiH.set("alpha_final", 0.);
+  // Calculation with the buffered storage
+  parametersLiH.set("storagedir", "tmpDMRGStream");
+  maquis::DMRGInterface<double> optimizerStream(parametersLiH);
+  optimizerStream.optimize();
+  auto energyStream = optimizerStream.energy();
+  // Same calculation with the memory-mapped storage
+  parametersLiH.set("storagedir", "tmpDMRGMmap");
+  parametersLiH.set("storage_mode", "mmap");
+  maquis::DMRGInterface<double> optimizerMmap(parametersLiH);
+  optimizerMmap.optimize();
+  auto energyMmap = optimizerMmap.energy();
+  BOOST_CHECK_CLOSE(energyStream, energyMmap, 1.0E-10);
+  boost::filesystem::remove_all("tmpDMRGStream");
+  boost::filesystem::remove_all("tmpDMRGMmap");
+}
+
+#ifdef HAVE_SU2U1PG
+
+/** @brief Test the block Davidson eigensolver, following the lowest of two roots */
+BOOST_FIXTURE_TEST_CASE(Test_LiH_DMRG_BlockDavidson, LiHFixture)
+{
+  parametersLiH.set("max_bond_dimension", 50);
+  parametersLiH.set("init_type", "default");
+  parametersLiH.set("seed", 98789);
+  parametersLiH.set("symmetry", "su2u1pg");
+  parametersLiH.set("nsweeps", 20);
+  parametersLiH.set("ngrowsweeps", 2);
+  parametersLiH.set("nmainsweeps", 5);
+  parametersLiH.set("optimization", "twosite");
+  parametersLiH.set("alpha_initial", 1.0E-8);
+  parametersLiH.set("alpha_main", 1.0E-15);
+  parametersLiH.set("alpha_final", 0.);
+  parametersLiH.set("eigensolver", "IETL_BLOCK_DAVIDSON");
+  parametersLiH.set("ietl_davidson_nroots", 2);
+  parametersLiH.set("ietl_davidson_target_root", 0);
+  parametersLiH.set("storagedir", "tmpDMRGBlockDavidson");
+  maquis::DMRGInterface<double> optimizer(parametersLiH);
+  optimizer.optimize();
+  BOOST_CHECK_CLOSE(optimizer.energy(), referenceEnergy, 1.0e-7);
+  boost::filesystem::remove_all("tmpDMRGBlockDavidson");
+}
+
+#endif
+
 /** @brief Test DMRG-IPI with dumping the boundaries to File */
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(Test_LiH_IPI_BoundaryStorage, S, symmetries, LiHFixture)
 {
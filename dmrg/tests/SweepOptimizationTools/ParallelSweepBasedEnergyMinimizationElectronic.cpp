@@ -0,0 +1,90 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MODULE ParallelSweepBasedEnergyMinimizationElectronic
+
+#include <iostream>
+#include <boost/mpi.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include "dmrg/SweepBasedAlgorithms/ParallelSweepBasedEnergyMinimization.h"
+#include "dmrg/models/generate_mpo.hpp"
+#include "dmrg/models/lattice/lattice.h"
+#include "dmrg/models/model.h"
+#include "dmrg/sim/matrix_types.h"
+#include "Fixtures/BenzeneFixture.h"
+
+/** @brief The MPI environment is shared by all the tests, which can be run with any number of ranks */
+struct MPIEnvironmentFixture {
+  boost::mpi::environment environment;
+};
+
+BOOST_GLOBAL_FIXTURE(MPIEnvironmentFixture);
+
+#ifdef HAVE_TwoU1PG
+
+/**
+ * @brief Runs the serial and the parallel two-site optimization from the same guess
+ * @return pair with the serial and the parallel energy
+ */
+std::pair<double, double> runSerialAndParallel(DmrgParameters& parameters)
+{
+  using SerialOptimizerType = SweepBasedEnergyMinimization<matrix, TwoU1PG, storage::disk, SweepOptimizationType::TwoSite>;
+  using ParallelOptimizerType = ParallelSweepBasedEnergyMinimization<matrix, TwoU1PG, storage::disk>;
+  auto lattice = Lattice(parameters);
+  auto model = Model<matrix, TwoU1PG>(lattice, parameters);
+  auto mpo = make_mpo(lattice, model);
+  auto serialMPS = MPS<matrix, TwoU1PG>(lattice.size(), *(model.initializer(lattice, parameters)));
+  auto parallelMPS = serialMPS;
+  auto serialOptimizer = SerialOptimizerType(serialMPS, mpo, parameters, model, lattice, false);
+  serialOptimizer.runSweepSimulation();
+  auto parallelOptimizer = ParallelOptimizerType(parallelMPS, mpo, parameters, model, lattice, false);
+  parallelOptimizer.runSweepSimulation();
+  // The combined MPS must be normalized and have the energy of the optimizer
+  BOOST_CHECK_CLOSE(norm(parallelMPS), 1., 1.0E-10);
+  double parallelEnergy = parallelOptimizer.template getSpecificResult<double>("Energy");
+  BOOST_CHECK_CLOSE(maquis::real(expval(parallelMPS, mpo)), parallelEnergy, 1.0E-10);
+  return std::make_pair(serialOptimizer.template getSpecificResult<double>("Energy"), parallelEnergy);
+}
+
+/** @brief Checks that the parallel DMRG converges to the FCI energy of benzene CAS(6,6) */
+BOOST_FIXTURE_TEST_CASE(Test_ParallelSweepBasedEnergyMinimization_Benzene, BenzeneFixture)
+{
+  parametersBenzene.set("nsweeps", 6);
+  parametersBenzene.set("max_bond_dimension", 100);
+  parametersBenzene.set("init_type", "hf");
+  parametersBenzene.set("hf_occ", "4,4,4,1,1,1");
+  auto energies = runSerialAndParallel(parametersBenzene);
+  BOOST_CHECK_CLOSE(energies.first, energies.second, 1.0E-8);
+}
+
+/** @brief Same as above, for a half-filled Hubbard chain with several sites per segment */
+BOOST_AUTO_TEST_CASE(Test_ParallelSweepBasedEnergyMinimization_Hubbard)
+{
+  int L = 12;
+  maquis::integral_map<double> integrals;
+  for (int i = 1; i <= L; i++) {
+    integrals[{i, i, i, i}] = 4.;
+    if (i < L)
+      integrals[{i+1, i, 0, 0}] = -1.;
+  }
+  DmrgParameters parameters;
+  parameters.set("integrals_binary", maquis::serialize(integrals));
+  parameters.set("L", L);
+  parameters.set("site_types", "0,0,0,0,0,0,0,0,0,0,0,0");
+  parameters.set("irrep", 0);
+  parameters.set("u1_total_charge1", L/2);
+  parameters.set("u1_total_charge2", L/2);
+  parameters.set("symmetry", "2u1pg");
+  parameters.set("init_type", "default");
+  parameters.set("seed", 1234);
+  parameters.set("nsweeps", 8);
+  parameters.set("max_bond_dimension", 200);
+  auto energies = runSerialAndParallel(parameters);
+  BOOST_CHECK_CLOSE(energies.first, energies.second, 1.0E-6);
+}
+
+#endif // HAVE_TwoU1PG
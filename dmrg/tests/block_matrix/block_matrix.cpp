@@ -12,6 +12,7 @@
 #include "dmrg/block_matrix/detail/alps.hpp"
 #include "dmrg/block_matrix/symmetry.h"
 #include "dmrg/block_matrix/block_matrix.h"
+#include "dmrg/block_matrix/block_matrix_algorithms.h"
 
 #include "dmrg/sim/matrix_types.h"
 
@@ -561,5 +562,94 @@ BOOST_AUTO_TEST_CASE(BlockMatrixResizeBlock){
     BOOST_CHECK_EQUAL(ba[0](9, 19), 1.);
     BOOST_CHECK_EQUAL(ba[0](19, 29), 0.);
 }
+
+/* Checks that the cached fused bases agree with the direct fusion and are shared among equal indices */
+BOOST_AUTO_TEST_CASE(FusedBasisAgreesWithProductBasis) {
+    typedef typename TwoU1::charge charge;
+    Index<TwoU1> phys, left;
+    charge empty(0), up(0), down(0), full(1);
+    up[0] = 1;
+    down[1] = 1;
+    phys.insert(std::make_pair(empty, 1));
+    phys.insert(std::make_pair(up, 1));
+    phys.insert(std::make_pair(down, 1));
+    phys.insert(std::make_pair(full, 1));
+    left.insert(std::make_pair(empty, 2));
+    left.insert(std::make_pair(up, 3));
+    left.insert(std::make_pair(full, 4));
+    for (bool conjugate : {false, true}) {
+        auto fused = FusedBasis<TwoU1>::get(phys, left, conjugate);
+        BOOST_CHECK(FusedBasis<TwoU1>::get(phys, left, conjugate) == fused);
+        Index<TwoU1> reference = conjugate ? adjoin(phys) * left : phys * left;
+        BOOST_CHECK(fused->index() == reference);
+        for (std::size_t k = 0; k < reference.size(); ++k) {
+            BOOST_CHECK_EQUAL(fused->position(reference[k].first), reference.position(reference[k].first));
+            BOOST_CHECK_EQUAL(fused->size_of_block(reference[k].first), reference[k].second);
+        }
+        auto fuse = [conjugate](charge a, charge b) { return TwoU1::fuse(conjugate ? -a : a, b); };
+        ProductBasis<TwoU1> pb(phys, left, fuse);
+        for (auto const & p : phys)
+            for (auto const & l : left) {
+                BOOST_CHECK_EQUAL(fused->offsets()(p.first, l.first), pb(p.first, l.first));
+                BOOST_CHECK_EQUAL(fused->offsets().size(p.first, l.first, fuse), pb.size(p.first, l.first, fuse));
+            }
+    }
+    // A change of the bond basis gives a new fusion
+    left[0].second = 5;
+    BOOST_CHECK(FusedBasis<TwoU1>::get(phys, left)->index() == phys * left);
+}
+
+/* Checks the blockwise decompositions, including the 1x1 blocks, and the truncation threshold */
+BOOST_AUTO_TEST_CASE(BlockMatrixDecompositionsAndTruncation) {
+    typedef typename TwoU1::charge charge;
+    typedef alps::numeric::diagonal_matrix<double> dmatrix;
+    block_matrix<matrix, TwoU1> M;
+    for (int i = 0; i < 6; ++i) {
+        charge c(i);
+        std::size_t size = (i % 2) ? 1 : 2*i+1;
+        matrix m(size, size);
+        for (std::size_t r = 0; r < size; ++r)
+            for (std::size_t s = 0; s <= r; ++s)
+                m(r, s) = m(s, r) = ((i == 3) ? -1. : 1.) / (1.+i+r+s) + ((r == s) ? 0.1*r : 0.);
+        M.insert_block(m, c, c);
+    }
+    block_matrix<matrix, TwoU1> U, V, US, USV;
+    block_matrix<dmatrix, TwoU1> S;
+    svd(M, U, V, S);
+    gemm(U, S, US);
+    gemm(US, V, USV);
+    BOOST_CHECK_SMALL((M - USV).norm(), 1.0E-12);
+    BOOST_CHECK_CLOSE(S(charge(3), charge(3))(0,0), 0.25, 1.0E-12);
+    block_matrix<matrix, TwoU1> evecs;
+    block_matrix<dmatrix, TwoU1> evals;
+    heev(M, evecs, evals);
+    for (std::size_t k = 0; k < M.n_blocks(); ++k) {
+        std::size_t size = num_rows(M[k]);
+        matrix Mv(size, size), vl(size, size);
+        gemm(M[k], evecs[k], Mv);
+        gemm(evecs[k], evals[k], vl);
+        for (std::size_t r = 0; r < size; ++r)
+            for (std::size_t s = 0; s < size; ++s)
+                BOOST_CHECK_SMALL(Mv(r, s) - vl(r, s), 1.0E-12);
+    }
+    // The threshold is the (Mmax+1)-th largest singular value, which is itself kept, as for a full sort
+    std::vector<double> all;
+    for (std::size_t k = 0; k < S.n_blocks(); ++k)
+        all.insert(all.end(), S[k].diagonal().first, S[k].diagonal().second);
+    std::sort(all.begin(), all.end(), std::greater<double>());
+    std::size_t Mmax = 7;
+    std::vector<std::size_t> keeps(S.n_blocks());
+    double truncated_fraction, truncated_weight, smallest_ev;
+    estimate_truncation(S, Mmax, 1.0E-12, &keeps[0], truncated_fraction, truncated_weight, smallest_ev);
+    BOOST_CHECK_CLOSE(smallest_ev, all[Mmax] / all[0], 1.0E-10);
+    BOOST_CHECK_EQUAL(std::accumulate(keeps.begin(), keeps.end(), std::size_t(0)), Mmax+1);
+    double discarded = 0., total = 0.;
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        total += all[i]*all[i];
+        if (i > Mmax)
+            discarded += all[i]*all[i];
+    }
+    BOOST_CHECK_CLOSE(truncated_weight, discarded / total, 1.0E-10);
+}
 #endif
 
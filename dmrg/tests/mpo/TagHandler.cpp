@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+#include "dmrg/models/model.h"
+#include "dmrg/models/lattice/lattice.h"
+#include "dmrg/models/OperatorHandlers/TagHandler.h"
+#include "dmrg/sim/matrix_types.h"
+#include "Fixtures/H2Fixture.h"
+
+typedef boost::mpl::list<
+#ifdef HAVE_TwoU1PG
+TwoU1PG
+#endif
+> symmetries;
+
+/**
+ * @brief Checks that the products calculated concurrently with a shared tag handler match
+ *        the products calculated serially.
+ */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_TagHandler_ConcurrentProducts, S, symmetries, H2Fixture )
+{
+    using tag_type = typename TagHandler<matrix, S>::tag_type;
+    auto lattice = Lattice(parametersH2);
+    auto model = Model<matrix, S>(lattice, parametersH2);
+    TagHandler<matrix, S> serial(*model.operators_table()), shared(*model.operators_table());
+    tag_type numOperators = serial.size();
+    std::vector<std::pair<tag_type, tag_type> > pairs;
+    for (tag_type t1 = 0; t1 < numOperators; t1++)
+        for (tag_type t2 = 0; t2 < numOperators; t2++)
+            pairs.push_back(std::make_pair(t1, t2));
+    std::vector<std::pair<tag_type, double> > serialProducts(pairs.size()), sharedProducts(pairs.size());
+    for (std::size_t i = 0; i < pairs.size(); i++)
+        serialProducts[i] = serial.get_product_tag(pairs[i].first, pairs[i].second);
+    // Each product is queried by several threads
+    #ifdef MAQUIS_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (std::size_t j = 0; j < 4*pairs.size(); j++) {
+        std::size_t i = pairs.size() - 1 - j % pairs.size();
+        auto product = shared.get_product_tag(pairs[i].first, pairs[i].second);
+        if (j < pairs.size())
+            sharedProducts[i] = product;
+    }
+    // The operators are deduplicated in both cases, possibly in a different order
+    BOOST_CHECK_EQUAL(shared.size(), serial.size());
+    for (std::size_t i = 0; i < pairs.size(); i++) {
+        BOOST_CHECK(shared.get_product_tag(pairs[i].first, pairs[i].second) == sharedProducts[i]);
+        auto difference = shared.get_op(sharedProducts[i].first) * sharedProducts[i].second;
+        difference -= serial.get_op(serialProducts[i].first) * serialProducts[i].second;
+        BOOST_CHECK_SMALL(difference.norm(), 1.0E-12);
+    }
+}
+
+/** @brief Checks that operators equal up to a scale are registered only once */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_TagHandler_CheckedRegister, S, symmetries, H2Fixture )
+{
+    auto lattice = Lattice(parametersH2);
+    auto model = Model<matrix, S>(lattice, parametersH2);
+    TagHandler<matrix, S> handler(*model.operators_table());
+    auto numOperators = handler.size();
+    for (typename TagHandler<matrix, S>::tag_type tag = 0; tag < numOperators; tag++) {
+        auto scaled = handler.get_op(tag) * 2.;
+        if (scaled.n_blocks() == 0)
+            continue;
+        auto registered = handler.checked_register(scaled, tag_detail::bosonic);
+        BOOST_CHECK(handler.hasRegistered(scaled));
+        BOOST_CHECK_EQUAL(handler.size(), numOperators);
+        BOOST_CHECK(registered.first <= tag);
+        auto difference = handler.get_op(registered.first) * registered.second;
+        difference -= scaled;
+        BOOST_CHECK_SMALL(difference.norm(), 1.0E-12);
+    }
+    // An operator which is not proportional to any other one is added to the table
+    typename TagHandler<matrix, S>::tag_type reference = 0;
+    while (handler.get_op(reference).n_blocks() < 2)
+        reference++;
+    auto newOperator = handler.get_op(reference);
+    double value = 1.;
+    for (std::size_t b = 0; b < newOperator.n_blocks(); b++)
+        for (std::size_t i = 0; i < num_rows(newOperator[b]); i++)
+            for (std::size_t j = 0; j < num_cols(newOperator[b]); j++)
+                newOperator[b](i, j) = (value += 0.37);
+    BOOST_CHECK(!handler.hasRegistered(newOperator));
+    auto registered = handler.checked_register(newOperator, tag_detail::bosonic);
+    BOOST_CHECK_EQUAL(registered.first, numOperators);
+    BOOST_CHECK_EQUAL(handler.size(), numOperators + 1);
+    auto rescaled = handler.checked_register(newOperator * 3., tag_detail::bosonic);
+    BOOST_CHECK_EQUAL(rescaled.first, registered.first);
+    BOOST_CHECK_CLOSE(rescaled.second, 3., 1.0E-10);
+}
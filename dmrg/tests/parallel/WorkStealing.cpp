@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+#include <atomic>
+#include <vector>
+#include "dmrg/utils/parallel/work_stealing.hpp"
+
+/** @brief Checks that each task is executed exactly once, also with more threads than tasks */
+BOOST_AUTO_TEST_CASE(Test_WorkStealing_AllTasksOnce)
+{
+    for (int nthreads : {1, 3, 8}) {
+        std::vector<double> costs = {5., 1., 1., 7., 2., 0., 3.};
+        std::vector<std::atomic<int> > counts(costs.size());
+        for (auto& c: counts)
+            c = 0;
+        parallel::work_stealing_executor executor(costs, nthreads);
+        BOOST_CHECK(executor.num_threads() <= static_cast<int>(costs.size()));
+        executor.run([&](std::size_t task, int thread) {
+            BOOST_REQUIRE(thread < executor.num_threads());
+            ++counts[task];
+        });
+        for (auto& c: counts)
+            BOOST_CHECK_EQUAL(c.load(), 1);
+    }
+}
+
+/** @brief Checks the reduction of per-thread partial results */
+BOOST_AUTO_TEST_CASE(Test_WorkStealing_TreeReduce)
+{
+    int n = 100;
+    std::vector<double> costs(n, 1.);
+    parallel::work_stealing_executor executor(costs, 4);
+    std::vector<long> partials(executor.num_threads(), 0);
+    executor.run([&](std::size_t task, int thread) { partials[thread] += task; });
+    parallel::tree_reduce(partials, [](long& a, long& b) { a += b; b = 0; });
+    BOOST_CHECK_EQUAL(partials[0], n*(n-1)/2);
+}
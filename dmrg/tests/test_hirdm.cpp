@@ -183,6 +183,21 @@ BOOST_AUTO_TEST_CASE( Test_HiRDM )
                 1.4200843855574402e-06, -6.8071174975981508e-06, 1.3614234995196302e-05, -6.8071174975981508e-06, 6.2361503557701404e-05, -0.00012472300711540281}
             };
             test_detail::check_measurement_mat(meas3, ref_3rdm);
+
+            // The parts of a partitioned 4-RDM measurement give together the full 4-RDM
+            rdm_measurement merged;
+            for (int part = 0; part < 2; part++) {
+                DmrgParameters p_part(p);
+                p_part.set("nsweeps", 0);
+                p_part.set("MEASURE_PARTITION[count]", 2);
+                p_part.set("MEASURE_PARTITION[index]", part);
+                maquis::DMRGInterface<double> interface_part(p_part);
+                const rdm_measurement& meas_part = interface_part.fourrdm();
+                BOOST_CHECK(meas_part.first.size() < ref_4rdm.first.size());
+                merged.first.insert(merged.first.end(), meas_part.first.begin(), meas_part.first.end());
+                merged.second.insert(merged.second.end(), meas_part.second.begin(), meas_part.second.end());
+            }
+            test_detail::check_measurement_mat(merged, ref_4rdm);
         }
 
         // calculated excited state and measure 3-TDM
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+// Tests for the on-disk cache of the MPO and of the two-site MPO
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/mpl/list.hpp>
+#include "utils/io.hpp" // has to be first include because of impi
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mpo_cache.h"
+#include "dmrg/mp_tensors/ts_ops.h"
+#include "dmrg/models/generate_mpo.hpp"
+#include "dmrg/sim/matrix_types.h"
+#include "Fixtures/BenzeneFixture.h"
+
+typedef boost::mpl::list<
+#ifdef HAVE_TwoU1PG
+TwoU1PG
+#endif
+#ifdef HAVE_SU2U1PG
+, SU2U1PG
+#endif
+> symmetries;
+
+/** @brief Checks that the cached MPO is loaded and that it gives the same energy as the original one */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_MPO_Cache_Hamiltonian, S, symmetries, BenzeneFixture )
+{
+    auto cacheDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    parametersBenzene.set("init_type", "default");
+    parametersBenzene.set("mpo_cache", cacheDir.string());
+    auto lattice = Lattice(parametersBenzene);
+    // The terms are created by each call to make_mpo, so that each MPO needs its own model
+    auto modelReference = Model<matrix, S>(lattice, parametersBenzene);
+    auto mps = MPS<matrix, S>(lattice.size(), *(modelReference.initializer(lattice, parametersBenzene)));
+    auto mpoReference = make_mpo(lattice, modelReference);
+    // The first construction stores the MPO, the second one loads it
+    auto key = mpo_cache::hamiltonian_key<S>(parametersBenzene);
+    auto modelStored = Model<matrix, S>(lattice, parametersBenzene);
+    auto mpoStored = make_mpo(lattice, modelStored, parametersBenzene);
+    BOOST_REQUIRE(boost::filesystem::exists(mpo_cache::file_name(cacheDir.string(), "mpo", key)));
+    auto modelLoaded = Model<matrix, S>(lattice, parametersBenzene);
+    auto mpoLoaded = make_mpo(lattice, modelLoaded, parametersBenzene);
+    BOOST_CHECK(!modelLoaded.hamiltonian_terms().empty());
+    BOOST_CHECK_EQUAL(mpo_cache::content_key(mpoLoaded), mpo_cache::content_key(mpoReference));
+    BOOST_CHECK_EQUAL(mpoLoaded.getCoreEnergy(), mpoReference.getCoreEnergy());
+    BOOST_CHECK_CLOSE(expval(mps, mpoLoaded), expval(mps, mpoReference), 1.E-10);
+    // Sweep parameters do not change the key, the integrals do
+    parametersBenzene.set("nsweeps", 3);
+    parametersBenzene.set("max_bond_dimension", 20);
+    BOOST_CHECK_EQUAL(mpo_cache::hamiltonian_key<S>(parametersBenzene), key);
+    integralsReal[{ 1, 1, 1, 1 }] += 1.0E-3;
+    parametersBenzene.set("integrals_binary", maquis::serialize(integralsReal));
+    BOOST_CHECK(mpo_cache::hamiltonian_key<S>(parametersBenzene) != key);
+    boost::filesystem::remove_all(cacheDir);
+}
+
+/** @brief Same as above, for the two-site MPO */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_MPO_Cache_TwoSite, S, symmetries, BenzeneFixture )
+{
+    auto cacheDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    parametersBenzene.set("init_type", "default");
+    parametersBenzene.set("mpo_cache", cacheDir.string());
+    auto lattice = Lattice(parametersBenzene);
+    auto model = Model<matrix, S>(lattice, parametersBenzene);
+    auto mps = MPS<matrix, S>(lattice.size(), *(model.initializer(lattice, parametersBenzene)));
+    auto mpo = make_mpo(lattice, model);
+    MPO<matrix, S> tsReference, tsStored, tsLoaded;
+    make_ts_cache_mpo(mpo, tsReference, mps);
+    make_ts_cache_mpo(mpo, tsStored, mps, parametersBenzene);
+    BOOST_REQUIRE_EQUAL(std::distance(boost::filesystem::directory_iterator(cacheDir), boost::filesystem::directory_iterator()), 1);
+    make_ts_cache_mpo(mpo, tsLoaded, mps, parametersBenzene);
+    BOOST_REQUIRE_EQUAL(tsLoaded.length(), tsReference.length());
+    BOOST_CHECK_EQUAL(mpo_cache::content_key(tsLoaded), mpo_cache::content_key(tsReference));
+    // The operators of each tensor are still shared, and their sparse representation is rebuilt
+    for (int p = 0; p < tsLoaded.length(); ++p) {
+        BOOST_CHECK_EQUAL(tsLoaded[p].get_operator_table()->size(), tsReference[p].get_operator_table()->size());
+        for (std::size_t i = 0; i < tsLoaded[p].get_operator_table()->size(); ++i) {
+            auto const & opLoaded = (*tsLoaded[p].get_operator_table())[i];
+            auto const & opReference = (*tsReference[p].get_operator_table())[i];
+            BOOST_REQUIRE_EQUAL(opLoaded.n_blocks(), opReference.n_blocks());
+            for (std::size_t b = 0; b < opLoaded.n_blocks(); ++b) {
+                auto blockLoaded = opLoaded.get_sparse().block(b), blockReference = opReference.get_sparse().block(b);
+                BOOST_CHECK_EQUAL(std::distance(blockLoaded.first, blockLoaded.second),
+                                  std::distance(blockReference.first, blockReference.second));
+            }
+        }
+    }
+    boost::filesystem::remove_all(cacheDir);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MODULE MPSCIExpansionElectronic
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <boost/test/included/unit_test.hpp>
+#include "dmrg/models/lattice/lattice.h"
+#include "dmrg/models/model.h"
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mps_ci_expansion.h"
+#include "dmrg/mp_tensors/mps_mpo_ops.h"
+#include "dmrg/sim/matrix_types.h"
+#include "Fixtures/BenzeneFixture.h"
+
+#ifdef HAVE_TwoU1PG
+
+using ExpansionType = MPSCIExpansion<matrix, TwoU1PG>;
+
+/** @brief Generates all the determinants built from the physical basis of each site with the charge of the MPS */
+std::vector<ExpansionType::Determinant> generateAllDeterminants(MPS<matrix, TwoU1PG> const & mps)
+{
+    std::vector<ExpansionType::Determinant> ret(1);
+    for (std::size_t p = 0; p < mps.length(); ++p) {
+        std::vector<ExpansionType::Determinant> next;
+        for (auto const & prefix : ret)
+            for (std::size_t s = 0; s < mps[p].site_dim().size(); ++s) {
+                next.push_back(prefix);
+                next.back().push_back(mps[p].site_dim()[s].first);
+            }
+        std::swap(ret, next);
+    }
+    auto target = mps[mps.length()-1].col_dim()[0].first;
+    ret.erase(std::remove_if(ret.begin(), ret.end(), [&target](ExpansionType::Determinant const & det) {
+        return std::accumulate(det.begin(), det.end(), TwoU1PG::IdentityCharge) != target; }), ret.end());
+    return ret;
+}
+
+/** @brief Checks that the batched and the single-determinant evaluations agree, and that the expansion is complete */
+BOOST_FIXTURE_TEST_CASE(Test_MPSCIExpansion_Completeness, BenzeneFixture)
+{
+    parametersBenzene.set("init_type", "default");
+    auto lattice = Lattice(parametersBenzene);
+    auto model = Model<matrix, TwoU1PG>(lattice, parametersBenzene);
+    auto mps = MPS<matrix, TwoU1PG>(lattice.size(), *(model.initializer(lattice, parametersBenzene)));
+    auto expansion = ExpansionType(mps);
+    auto determinants = generateAllDeterminants(mps);
+    std::shuffle(determinants.begin(), determinants.end(), std::mt19937(1234));
+    auto coefficients = expansion.coefficients(determinants);
+    double sumOfSquares = 0.;
+    for (std::size_t i = 0; i < determinants.size(); ++i) {
+        BOOST_CHECK_SMALL(coefficients[i] - expansion.coefficient(determinants[i]), 1.0E-14);
+        sumOfSquares += coefficients[i]*coefficients[i];
+    }
+    BOOST_CHECK_CLOSE(sumOfSquares, norm(mps), 1.0E-10);
+}
+
+/** @brief Checks that the HF determinant is the only one with non-zero weight in the HF MPS */
+BOOST_FIXTURE_TEST_CASE(Test_MPSCIExpansion_HF, BenzeneFixture)
+{
+    parametersBenzene.set("init_type", "hf");
+    parametersBenzene.set("hf_occ", "4,4,4,1,1,1");
+    auto lattice = Lattice(parametersBenzene);
+    auto model = Model<matrix, TwoU1PG>(lattice, parametersBenzene);
+    auto mps = MPS<matrix, TwoU1PG>(lattice.size(), *(model.initializer(lattice, parametersBenzene)));
+    auto expansion = ExpansionType(mps);
+    ExpansionType::Determinant hfDeterminant;
+    for (std::size_t p = 0; p < mps.length(); ++p) {
+        int occupation = (p < 3) ? 1 : 0;
+        for (std::size_t s = 0; s < mps[p].site_dim().size(); ++s)
+            if (mps[p].site_dim()[s].first[0] == occupation && mps[p].site_dim()[s].first[1] == occupation)
+                hfDeterminant.push_back(mps[p].site_dim()[s].first);
+    }
+    BOOST_CHECK_CLOSE(std::abs(expansion.coefficient(hfDeterminant)), 1., 1.0E-10);
+    auto determinants = generateAllDeterminants(mps);
+    auto coefficients = expansion.coefficients(determinants);
+    for (std::size_t i = 0; i < determinants.size(); ++i)
+        if (determinants[i] != hfDeterminant)
+            BOOST_CHECK_SMALL(coefficients[i], 1.0E-14);
+}
+
+/** @brief Checks that the frequencies of the perfect sampling follow the squared coefficients */
+BOOST_FIXTURE_TEST_CASE(Test_MPSCIExpansion_PerfectSampling, BenzeneFixture)
+{
+    parametersBenzene.set("init_type", "default");
+    auto lattice = Lattice(parametersBenzene);
+    auto model = Model<matrix, TwoU1PG>(lattice, parametersBenzene);
+    auto mps = MPS<matrix, TwoU1PG>(lattice.size(), *(model.initializer(lattice, parametersBenzene)));
+    mps.normalize_right();
+    auto expansion = ExpansionType(mps);
+    std::size_t nSamples = 100000;
+    std::mt19937 generator(1234);
+    auto samples = expansion.sample(nSamples, generator);
+    std::size_t totalCount = 0;
+    for (auto const & sample : samples) {
+        totalCount += sample.count;
+        double weight = expansion.coefficient(sample.determinant);
+        BOOST_CHECK_SMALL(sample.coefficient - weight, 1.0E-14);
+        weight *= weight;
+        BOOST_CHECK(weight > 0.);
+        // Five standard deviations of the binomial distribution
+        double frequency = static_cast<double>(sample.count)/nSamples;
+        BOOST_CHECK_SMALL(frequency - weight, 5.*std::sqrt(weight*(1.-weight)/nSamples) + 1.0E-10);
+    }
+    BOOST_CHECK_EQUAL(totalCount, nSamples);
+}
+
+#endif // HAVE_TwoU1PG
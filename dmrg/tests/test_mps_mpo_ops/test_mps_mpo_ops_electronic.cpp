@@ -19,6 +19,9 @@
 #include <iostream>
 #include "dmrg/mp_tensors/mps.h"
 #include "dmrg/mp_tensors/mps_rotate.h"
+#include "dmrg/mp_tensors/expval_boundary_cache.h"
+#include "dmrg/models/generate_mpo/tagged_mpo_maker_optim.hpp"
+#include "dmrg/models/meas_prepare.hpp"
 #include "dmrg/sim/matrix_types.h"
 #include "Fixtures/BenzeneFixture.h"
 #include "test_mps.h"
@@ -98,3 +101,147 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_MPS_MPO_Hermitian_Right_Electronic, S, sy
     expVal2 = expvalFromRight(mpsHF, mpsDefault, mpo);
     BOOST_CHECK_CLOSE(expVal1, expVal2, 1.E-10);
 }
+
+/**
+ * @brief Checks that the expectation values obtained with the cached boundaries match the full contraction.
+ * Each term is converted to a separate MPO, as done for the RDM measurements.
+ */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_MPS_MPO_ExpvalBoundaryCache_Electronic, S, symmetries, BenzeneFixture )
+{
+    auto lattice = Lattice(parametersBenzene);
+    parametersBenzene.set("init_type", "const");
+    auto modelConst = Model<matrix, S>(lattice, parametersBenzene);
+    auto mpsConst = MPS<matrix, S>(lattice.size(), *(modelConst.initializer(lattice, parametersBenzene)));
+    parametersBenzene.set("init_type", "default");
+    auto modelDefault = Model<matrix, S>(lattice, parametersBenzene);
+    auto mpsDefault = MPS<matrix, S>(lattice.size(), *(modelDefault.initializer(lattice, parametersBenzene)));
+    // Identity and filling operators
+    std::vector<typename Model<matrix, S>::tag_type> identities, identitiesFull, fillings;
+    for (int iType = 0; iType < lattice.getMaxType(); iType++) {
+        identities.push_back(modelConst.identity_matrix_tag(iType));
+        fillings.push_back(modelConst.filling_matrix_tag(iType));
+        try {
+            identitiesFull.push_back(modelConst.get_operator_tag("ident_full", iType));
+        }
+        catch (std::runtime_error const & e) {}
+    }
+    ExpvalBoundaryCache<matrix, S> cache(mpsDefault, mpsConst);
+    // Density-density operators on all pairs of sites, evaluated in an order that is not
+    // the lattice ordering, so that both the left and the right environments are reused.
+    for (int first = lattice.size()-2; first >= 0; first--) {
+        for (int last = first+1; last < lattice.size(); last++) {
+            typename Model<matrix, S>::term_descriptor term;
+            term.coeff = 1.;
+            term.push_back(std::make_pair(first, modelConst.get_operator_tag("docc", lattice.get_prop<int>("type", first))));
+            term.push_back(std::make_pair(last, modelConst.get_operator_tag("docc", lattice.get_prop<int>("type", last))));
+            generate_mpo::TaggedMPOMaker<matrix, S> mpoMaker(lattice, identities, identitiesFull, fillings,
+                                                             modelConst.operators_table(), {term});
+            auto mpo = mpoMaker.create_mpo();
+            double refValue = expval(mpsDefault, mpsConst, mpo);
+            double cachedValue = cache.expval(mpo, first, last);
+            BOOST_CHECK_SMALL(refValue-cachedValue, 1.0E-12);
+        }
+    }
+    // Operators sharing the tensors of their first sites up to a scalar factor, evaluated with
+    // decreasing extent so that the window prefixes of both streams are reused
+    for (int last = lattice.size()-1; last > 1; last--) {
+        for (int stream = 0; stream < 2; stream++) {
+            typename Model<matrix, S>::term_descriptor term;
+            term.coeff = 0.5*(last+stream+1);
+            int type = lattice.get_prop<int>("type", 0);
+            term.push_back(std::make_pair(0, (stream == 0) ? modelConst.get_operator_tag("docc", type) : modelConst.identity_matrix_tag(type)));
+            term.push_back(std::make_pair(last, modelConst.get_operator_tag("docc", lattice.get_prop<int>("type", last))));
+            generate_mpo::TaggedMPOMaker<matrix, S> mpoMaker(lattice, identities, identitiesFull, fillings,
+                                                             modelConst.operators_table(), {term});
+            auto mpo = mpoMaker.create_mpo();
+            double refValue = expval(mpsDefault, mpsConst, mpo);
+            double cachedValue = cache.expval(mpo, 0, last, stream);
+            BOOST_CHECK_SMALL(refValue-cachedValue, 1.0E-12);
+        }
+    }
+}
+
+/**
+ * @brief Checks the batched evaluation of many MPOs against the evaluation of each MPO separately.
+ * The batch mixes MPOs built by independent makers, MPOs sharing the operator table, and duplicates.
+ */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_MPS_MPO_BatchedMultiExpval_Electronic, S, symmetries, BenzeneFixture )
+{
+    using op_t = typename Model<matrix, S>::op_t;
+    auto lattice = Lattice(parametersBenzene);
+    parametersBenzene.set("init_type", "const");
+    auto modelConst = Model<matrix, S>(lattice, parametersBenzene);
+    auto mpsConst = MPS<matrix, S>(lattice.size(), *(modelConst.initializer(lattice, parametersBenzene)));
+    parametersBenzene.set("init_type", "default");
+    auto modelDefault = Model<matrix, S>(lattice, parametersBenzene);
+    auto mpsDefault = MPS<matrix, S>(lattice.size(), *(modelDefault.initializer(lattice, parametersBenzene)));
+    std::vector<op_t> identityOps, fillingOps, doccOps;
+    std::vector<typename Model<matrix, S>::tag_type> identities, identitiesFull, fillings;
+    for (int iType = 0; iType < lattice.getMaxType(); iType++) {
+        identityOps.push_back(modelConst.identity_matrix(iType));
+        fillingOps.push_back(modelConst.filling_matrix(iType));
+        doccOps.push_back(modelConst.get_operator("docc", iType));
+        identities.push_back(modelConst.identity_matrix_tag(iType));
+        fillings.push_back(modelConst.filling_matrix_tag(iType));
+        try {
+            identitiesFull.push_back(modelConst.get_operator_tag("ident_full", iType));
+        }
+        catch (std::runtime_error const & e) {}
+    }
+    std::vector<MPO<matrix, S> > mpos;
+    // Local densities, each built by its own MPOMaker (which does not set the spin indices of the SU2 MPOs)
+    if (!symm_traits::HasSU2<S>::value) {
+        auto localMPOs = meas_prepare::local<matrix, S>(lattice, identityOps, fillingOps, {std::make_pair(doccOps, false)});
+        for (auto const & labelAndMPO : localMPOs)
+            mpos.push_back(labelAndMPO.second);
+    }
+    // Density-density correlations from the operator table of the model
+    for (int first = 0; first < lattice.size(); first++) {
+        for (int last = first+1; last < lattice.size(); last += 2) {
+            typename Model<matrix, S>::term_descriptor term;
+            term.coeff = 1.;
+            term.push_back(std::make_pair(first, modelConst.get_operator_tag("docc", lattice.get_prop<int>("type", first))));
+            term.push_back(std::make_pair(last, modelConst.get_operator_tag("docc", lattice.get_prop<int>("type", last))));
+            generate_mpo::TaggedMPOMaker<matrix, S> mpoMaker(lattice, identities, identitiesFull, fillings,
+                                                             modelConst.operators_table(), {term});
+            mpos.push_back(mpoMaker.create_mpo());
+        }
+    }
+    mpos.push_back(mpos.front());
+    auto values = multi_expval(mpsDefault, mpsConst, mpos);
+    BOOST_REQUIRE_EQUAL(values.size(), mpos.size());
+    for (std::size_t i = 0; i < mpos.size(); i++) {
+        BOOST_REQUIRE_EQUAL(values[i].size(), 1);
+        double refValue = expval(mpsDefault, mpsConst, mpos[i]);
+        BOOST_CHECK_SMALL(refValue-values[i][0], 1.0E-12);
+    }
+}
+
+/**
+ * @brief Checks that the cached reshape maps used by MPSTensor give the same tensors as the direct reshapes,
+ * also when a map is reused by a different tensor with the same structure.
+ */
+BOOST_FIXTURE_TEST_CASE_TEMPLATE( Test_MPSTensor_ReshapePlan_Electronic, S, symmetries, BenzeneFixture )
+{
+    auto lattice = Lattice(parametersBenzene);
+    parametersBenzene.set("init_type", "default");
+    auto model = Model<matrix, S>(lattice, parametersBenzene);
+    auto mps = MPS<matrix, S>(lattice.size(), *(model.initializer(lattice, parametersBenzene)));
+    for (int site = 0; site < lattice.size(); site++) {
+        for (int iCopy = 0; iCopy < 2; iCopy++) {
+            MPSTensor<matrix, S> tensor = mps[site];
+            tensor *= iCopy+1.;
+            tensor.make_left_paired();
+            block_matrix<matrix, S> leftPaired = tensor.data(), rightPaired;
+            reshape_left_to_right_new<matrix>(tensor.site_dim(), tensor.row_dim(), tensor.col_dim(), leftPaired, rightPaired);
+            tensor.make_right_paired();
+            BOOST_REQUIRE(tensor.data().basis() == rightPaired.basis());
+            rightPaired -= tensor.data();
+            BOOST_CHECK_SMALL(rightPaired.norm(), 1.0E-15);
+            tensor.make_left_paired();
+            BOOST_REQUIRE(tensor.data().basis() == leftPaired.basis());
+            leftPaired -= tensor.data();
+            BOOST_CHECK_SMALL(leftPaired.norm(), 1.0E-15);
+        }
+    }
+}
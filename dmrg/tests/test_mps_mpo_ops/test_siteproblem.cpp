@@ -20,6 +20,8 @@
 #include "dmrg/mp_tensors/zerositeproblem.h"
 #include "dmrg/mp_tensors/contractions/engine.h"
 #include "dmrg/optimize/ietl_lanczos_solver.h"
+#include "dmrg/optimize/ietl_jacobi_davidson.h"
+#include "dmrg/optimize/ietl_davidson.h"
 #include "dmrg/models/model.h"
 #include "dmrg/models/generate_mpo.hpp"
 #include "dmrg/sim/matrix_types.h"
@@ -94,6 +96,228 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( Test_SiteProblem, S, symmetries)
     BOOST_CHECK_CLOSE(energy, energy2, 1e-10);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( Test_SiteProblem_Plan, S, symmetries)
+{
+    // Types definition
+    using BoundaryType = Boundary<typename storage::constrained<matrix>::type, S>;
+    using contr = contraction::Engine<matrix, typename storage::constrained<matrix>::type, S>;
+    DmrgParameters p;
+    const auto& integrals = TestSiteproblemFixture::integrals;
+    p.set("integrals_binary", maquis::serialize(integrals));
+    p.set("site_types", "0,0,0,0");
+    p.set("L", 4);
+    p.set("irrep", 0);
+    p.set("max_bond_dimension",100);
+    // For SU2U1
+    p.set("nelec", 2);
+    p.set("spin", 0);
+    // For 2U1
+    p.set("u1_total_charge1", 1);
+    p.set("u1_total_charge2", 1);
+    auto lat = Lattice(p);
+    auto model = Model<matrix, S>(lat, p);
+    auto mpo = make_mpo(lat, model);
+    auto mps = MPS<matrix, S>(lat.size(), *(model.initializer(lat, p)));
+    mps.normalize_right();
+    auto latticeSize = mpo.length();
+    std::vector<BoundaryType> left(latticeSize+1), right(latticeSize+1);
+    left[0] = mps.left_boundary();
+    for (int iSite = 0; iSite < latticeSize; iSite++)
+        left[iSite+1] = contr::overlap_mpo_left_step(mps[iSite], mps[iSite], left[iSite], mpo[iSite]);
+    right[latticeSize] = mps.right_boundary();
+    for (int iSite = latticeSize-1; iSite >= 0; iSite--)
+        right[iSite] = contr::overlap_mpo_right_step(mps[iSite], mps[iSite], right[iSite+1], mpo[iSite]);
+    // The precompiled sigma vector must match the one calculated from scratch, also when
+    // the plan is reused for different vectors.
+    for (int iSite = 0; iSite < latticeSize; iSite++) {
+        SiteProblem<matrix, S> sp(left[iSite], right[iSite+1], mpo[iSite]);
+        auto vector = mps[iSite];
+        for (int iter = 0; iter < 3; iter++) {
+            auto reference = contr::site_hamil2(vector, left[iSite], right[iSite+1], mpo[iSite]);
+            auto sigmaVector = sp.apply(vector);
+            auto difference = sigmaVector - reference;
+            BOOST_CHECK_SMALL(ietl::two_norm(difference), 1e-12);
+            vector = sigmaVector + vector;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( Test_SiteProblem_Batch, S, symmetries)
+{
+    // Types definition
+    using BoundaryType = Boundary<typename storage::constrained<matrix>::type, S>;
+    using contr = contraction::Engine<matrix, typename storage::constrained<matrix>::type, S>;
+    DmrgParameters p;
+    const auto& integrals = TestSiteproblemFixture::integrals;
+    p.set("integrals_binary", maquis::serialize(integrals));
+    p.set("site_types", "0,0,0,0");
+    p.set("L", 4);
+    p.set("irrep", 0);
+    p.set("max_bond_dimension",100);
+    // For SU2U1
+    p.set("nelec", 2);
+    p.set("spin", 0);
+    // For 2U1
+    p.set("u1_total_charge1", 1);
+    p.set("u1_total_charge2", 1);
+    auto lat = Lattice(p);
+    auto model = Model<matrix, S>(lat, p);
+    auto mpo = make_mpo(lat, model);
+    auto mps = MPS<matrix, S>(lat.size(), *(model.initializer(lat, p)));
+    mps.normalize_right();
+    auto latticeSize = mpo.length();
+    std::vector<BoundaryType> left(latticeSize+1), right(latticeSize+1);
+    left[0] = mps.left_boundary();
+    for (int iSite = 0; iSite < latticeSize; iSite++)
+        left[iSite+1] = contr::overlap_mpo_left_step(mps[iSite], mps[iSite], left[iSite], mpo[iSite]);
+    right[latticeSize] = mps.right_boundary();
+    for (int iSite = latticeSize-1; iSite >= 0; iSite--)
+        right[iSite] = contr::overlap_mpo_right_step(mps[iSite], mps[iSite], right[iSite+1], mpo[iSite]);
+    // The sigma vectors of a batch must match the ones calculated one at a time
+    for (int iSite = 0; iSite < latticeSize; iSite++) {
+        SiteProblem<matrix, S> sp(left[iSite], right[iSite+1], mpo[iSite]);
+        std::vector<MPSTensor<matrix, S> > vectors(1, mps[iSite]), sigmaVectors;
+        for (int n = 1; n < 3; n++)
+            vectors.push_back(sp.apply(vectors[n-1]) + vectors[n-1]);
+        ietl::mult(sp, vectors, sigmaVectors);
+        BOOST_CHECK_EQUAL(sigmaVectors.size(), vectors.size());
+        for (int n = 0; n < vectors.size(); n++) {
+            auto difference = sigmaVectors[n] - sp.apply(vectors[n]);
+            BOOST_CHECK_SMALL(ietl::two_norm(difference), 1e-12);
+        }
+    }
+}
+
+/** @brief Compares the diagonal used by the preconditioners with the diagonal of the explicit site Hamiltonian */
+BOOST_AUTO_TEST_CASE_TEMPLATE( Test_SiteProblem_Diagonal, S, symmetries)
+{
+    using BoundaryType = Boundary<typename storage::constrained<matrix>::type, S>;
+    using contr = contraction::Engine<matrix, typename storage::constrained<matrix>::type, S>;
+    DmrgParameters p;
+    const auto& integrals = TestSiteproblemFixture::integrals;
+    p.set("integrals_binary", maquis::serialize(integrals));
+    p.set("site_types", "0,0,0,0");
+    p.set("L", 4);
+    p.set("irrep", 0);
+    p.set("max_bond_dimension",100);
+    // For SU2U1
+    p.set("nelec", 2);
+    p.set("spin", 0);
+    // For 2U1
+    p.set("u1_total_charge1", 1);
+    p.set("u1_total_charge2", 1);
+    auto lat = Lattice(p);
+    auto model = Model<matrix, S>(lat, p);
+    auto mpo = make_mpo(lat, model);
+    auto mps = MPS<matrix, S>(lat.size(), *(model.initializer(lat, p)));
+    mps.normalize_right();
+    auto latticeSize = mpo.length();
+    std::vector<BoundaryType> left(latticeSize+1), right(latticeSize+1);
+    left[0] = mps.left_boundary();
+    for (int iSite = 0; iSite < latticeSize; iSite++)
+        left[iSite+1] = contr::overlap_mpo_left_step(mps[iSite], mps[iSite], left[iSite], mpo[iSite]);
+    right[latticeSize] = mps.right_boundary();
+    for (int iSite = latticeSize-1; iSite >= 0; iSite--)
+        right[iSite] = contr::overlap_mpo_right_step(mps[iSite], mps[iSite], right[iSite+1], mpo[iSite]);
+    for (int iSite = 0; iSite < latticeSize; iSite++) {
+        SiteProblem<matrix, S> sp(left[iSite], right[iSite+1], mpo[iSite]);
+        MPSTensor<matrix, S> unit = mps[iSite];
+        unit.make_left_paired();
+        unit.multiply_by_scalar(0.);
+        auto diagonal = contr::diagonal_hamiltonian(left[iSite], right[iSite+1], mpo[iSite], unit);
+        for (std::size_t b = 0; b < unit.data().n_blocks(); b++) {
+            std::size_t diagonalBlock = diagonal.find_block(unit.data().basis().left_charge(b), unit.data().basis().right_charge(b));
+            BOOST_REQUIRE(diagonalBlock < diagonal.n_blocks());
+            for (std::size_t i = 0; i < num_rows(unit.data()[b]); i++)
+                for (std::size_t j = 0; j < num_cols(unit.data()[b]); j++) {
+                    unit.data()[b](i,j) = 1.;
+                    auto sigmaVector = sp.apply(unit);
+                    BOOST_CHECK_SMALL(ietl::dot(unit, sigmaVector) - diagonal[diagonalBlock](i,j), 1e-12);
+                    unit.make_left_paired();
+                    unit.data()[b](i,j) = 0.;
+                }
+        }
+        // The cached diagonal is reused only for the same site problem
+        auto cached = contr::diagonal_hamiltonian(left[iSite], right[iSite+1], mpo[iSite], unit, true);
+        auto reused = contr::diagonal_hamiltonian(left[iSite], right[iSite+1], mpo[iSite], mps[iSite], true);
+        cached -= diagonal;
+        reused -= diagonal;
+        BOOST_CHECK_SMALL(cached.norm(), 1e-14);
+        BOOST_CHECK_SMALL(reused.norm(), 1e-14);
+    }
+}
+
+#ifdef HAVE_SU2U1PG
+
+/** @brief Compares the block Davidson roots with the eigenvalues of the explicit site Hamiltonian */
+BOOST_AUTO_TEST_CASE( Test_SiteProblem_BlockDavidson )
+{
+    using S = SU2U1PG;
+    using BoundaryType = Boundary<typename storage::constrained<matrix>::type, S>;
+    using contr = contraction::Engine<matrix, typename storage::constrained<matrix>::type, S>;
+    DmrgParameters p;
+    const auto& integrals = TestSiteproblemFixture::integrals;
+    p.set("integrals_binary", maquis::serialize(integrals));
+    p.set("site_types", "0,0,0,0");
+    p.set("L", 4);
+    p.set("irrep", 0);
+    p.set("max_bond_dimension",100);
+    p.set("nelec", 2);
+    p.set("spin", 0);
+    p.set("ietl_davidson_nroots", 3);
+    p.set("ietl_jcd_tol", 1e-10);
+    p.set("ietl_jcd_maxiter", 100);
+    auto lat = Lattice(p);
+    auto model = Model<matrix, S>(lat, p);
+    auto mpo = make_mpo(lat, model);
+    auto mps = MPS<matrix, S>(lat.size(), *(model.initializer(lat, p)));
+    mps.normalize_right();
+    auto latticeSize = mpo.length();
+    std::vector<BoundaryType> left(latticeSize+1), right(latticeSize+1);
+    left[0] = mps.left_boundary();
+    for (int iSite = 0; iSite < latticeSize; iSite++)
+        left[iSite+1] = contr::overlap_mpo_left_step(mps[iSite], mps[iSite], left[iSite], mpo[iSite]);
+    right[latticeSize] = mps.right_boundary();
+    for (int iSite = latticeSize-1; iSite >= 0; iSite--)
+        right[iSite] = contr::overlap_mpo_right_step(mps[iSite], mps[iSite], right[iSite+1], mpo[iSite]);
+    for (int iSite = 0; iSite < latticeSize; iSite++) {
+        SiteProblem<matrix, S> sp(left[iSite], right[iSite+1], mpo[iSite]);
+        // Explicit site Hamiltonian, in the basis of the unit tensors
+        std::vector<MPSTensor<matrix, S> > units;
+        MPSTensor<matrix, S> zero = mps[iSite];
+        zero.make_left_paired();
+        zero.multiply_by_scalar(0.);
+        for (std::size_t b = 0; b < zero.data().n_blocks(); b++)
+            for (std::size_t i = 0; i < num_rows(zero.data()[b]); i++)
+                for (std::size_t j = 0; j < num_cols(zero.data()[b]); j++) {
+                    units.push_back(zero);
+                    units.back().data()[b](i,j) = 1.;
+                }
+        std::size_t dim = units.size();
+        matrix hamiltonian(dim, dim);
+        for (std::size_t j = 0; j < dim; j++) {
+            auto sigmaVector = sp.apply(units[j]);
+            for (std::size_t i = 0; i < dim; i++)
+                hamiltonian(i,j) = ietl::dot(units[i], sigmaVector);
+        }
+        std::vector<double> eigenvalues(dim);
+        boost::numeric::bindings::lapack::heevd('N', hamiltonian, eigenvalues);
+        // Block Davidson
+        auto roots = solve_ietl_block_davidson(sp, std::vector<MPSTensor<matrix, S> >(1, mps[iSite]), p);
+        BOOST_CHECK_EQUAL(roots.size(), std::min<std::size_t>(3, dim));
+        for (std::size_t k = 0; k < roots.size(); k++) {
+            BOOST_CHECK_SMALL(roots[k].first - eigenvalues[k], 1e-8);
+            BOOST_CHECK_CLOSE(ietl::two_norm(roots[k].second), 1., 1e-8);
+            auto residual = sp.apply(roots[k].second) - roots[k].first*roots[k].second;
+            BOOST_CHECK_SMALL(ietl::two_norm(residual), 1e-9);
+            for (std::size_t l = 0; l < k; l++)
+                BOOST_CHECK_SMALL(ietl::dot(roots[l].second, roots[k].second), 1e-9);
+        }
+    }
+}
+
+#endif
+
 BOOST_AUTO_TEST_CASE_TEMPLATE( Test_ZeroSiteProblem, S, symmetries)
 {
     // Types definition
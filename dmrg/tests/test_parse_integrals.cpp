@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MAIN
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include <boost/test/included/unit_test.hpp>
+#include "dmrg/block_matrix/symmetry.h"
+#include "dmrg/models/lattice/lattice.h"
+#include "dmrg/models/chem/util.h"
+#include "dmrg/models/chem/parse_integrals.h"
+#include "dmrg/utils/DmrgParameters.h"
+
+namespace {
+
+    // Random FCIDUMP body, large enough to be split in several chunks by the parser
+    std::string fcidump_body(int L, int n)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int> orb(0, L);
+        std::uniform_real_distribution<double> val(-1., 1.);
+        std::ostringstream ss;
+        ss.precision(16);
+        for (int i = 0; i < n; i++)
+            ss << std::scientific << (i % 10 == 0 ? 1.0E-14 : val(rng)) << "   "
+               << orb(rng) << " " << orb(rng) << " " << orb(rng) << " " << orb(rng) << "\n";
+        return ss.str();
+    }
+
+    DmrgParameters fcidump_parameters(int L)
+    {
+        DmrgParameters parms;
+        parms.set("L", L);
+        parms.set("LATTICE", "orbitals");
+        parms.set("site_types", "0,0,0,0,0,0,0,0");
+        parms.set("integral_cutoff", 1.0E-10);
+        parms.set("orbital_order", "3,1,2,5,4,6,8,7");
+        return parms;
+    }
+
+    // Reference parser, streaming the text as the original implementation
+    std::vector<std::pair<std::array<int, 4>, double> > reference_integrals(std::string const & body, std::vector<int> const & order)
+    {
+        std::vector<int> inv_order(order.size());
+        for (int p = 0; p < order.size(); ++p)
+            inv_order[order[p]-1] = p;
+        std::vector<std::pair<std::array<int, 4>, double> > ret;
+        std::istringstream ss(body);
+        double v;
+        std::array<int, 4> idx;
+        while (ss >> v >> idx[0] >> idx[1] >> idx[2] >> idx[3])
+            if (std::abs(v) > 1.0E-10) {
+                for (int& i : idx)
+                    i = i > 0 ? inv_order[i-1] : -1;
+                chem::detail::IndexTuple aligned = chem::detail::align<TwoU1PG>(idx[0], idx[1], idx[2], idx[3]);
+                ret.push_back(std::make_pair(std::array<int, 4>{ aligned[0], aligned[1], aligned[2], aligned[3] }, v));
+            }
+        return ret;
+    }
+
+    void check_integrals(std::pair<alps::numeric::matrix<Lattice::pos_t>, std::vector<double> > const & parsed,
+                         std::vector<std::pair<std::array<int, 4>, double> > const & reference)
+    {
+        BOOST_REQUIRE_EQUAL(parsed.second.size(), reference.size());
+        BOOST_REQUIRE_EQUAL(num_rows(parsed.first), reference.size());
+        for (std::size_t i = 0; i < reference.size(); i++) {
+            BOOST_REQUIRE_EQUAL(parsed.second[i], reference[i].second);
+            for (int j = 0; j < 4; j++)
+                BOOST_REQUIRE_EQUAL(parsed.first(i, j), reference[i].first[j]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Test_Parse_Integrals_String )
+{
+    int L = 8;
+    std::string body = fcidump_body(L, 5000);
+    auto parms = fcidump_parameters(L);
+    parms.set("integrals", body);
+    Lattice lattice(parms);
+    auto parsed = chem::detail::parse_integrals<double, TwoU1PG>(parms, lattice);
+    check_integrals(parsed, reference_integrals(body, parms["orbital_order"].as<std::vector<int> >()));
+}
+
+BOOST_AUTO_TEST_CASE( Test_Parse_Integrals_File_Cache )
+{
+    int L = 8;
+    // About 3 MB of text
+    std::string body = fcidump_body(L, 60000);
+    std::string fcidump = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    {
+        std::ofstream ofs(fcidump);
+        ofs << " &FCI NORB=  8,NELEC= 8,MS2= 0,\n  ORBSYM=1,1,1,1,1,1,1,1,\n  ISYM=1,\n &END\n" << body;
+    }
+    auto parms = fcidump_parameters(L);
+    parms.set("integral_file", fcidump);
+    Lattice lattice(parms);
+    auto reference = reference_integrals(body, parms["orbital_order"].as<std::vector<int> >());
+    // The first parsing writes the cache
+    BOOST_CHECK(!boost::filesystem::exists(fcidump + ".cache"));
+    check_integrals(chem::detail::parse_integrals<double, TwoU1PG>(parms, lattice), reference);
+    BOOST_REQUIRE(boost::filesystem::exists(fcidump + ".cache"));
+    // The second one loads it
+    auto time = boost::filesystem::last_write_time(fcidump + ".cache");
+    check_integrals(chem::detail::parse_integrals<double, TwoU1PG>(parms, lattice), reference);
+    BOOST_CHECK(boost::filesystem::last_write_time(fcidump + ".cache") == time);
+    // A different orbital ordering invalidates it
+    parms.set("orbital_order", "1,2,3,4,5,6,7,8");
+    check_integrals(chem::detail::parse_integrals<double, TwoU1PG>(parms, lattice),
+                    reference_integrals(body, parms["orbital_order"].as<std::vector<int> >()));
+    // And so does a change of the file
+    {
+        std::ofstream ofs(fcidump, std::ios::app);
+        ofs << "0.5 1 1 1 1\n";
+    }
+    auto parsed = chem::detail::parse_integrals<double, TwoU1PG>(parms, lattice);
+    BOOST_CHECK_EQUAL(parsed.second.size(), reference.size() + 1);
+    BOOST_CHECK_EQUAL(parsed.second.back(), 0.5);
+    boost::filesystem::remove(fcidump);
+    boost::filesystem::remove(fcidump + ".cache");
+}
+
+BOOST_AUTO_TEST_CASE( Test_Parse_Integrals_Error )
+{
+    auto parms = fcidump_parameters(8);
+    parms.set("integrals", "0.5 1 1 1 1\n0.25 1 1 1\n");
+    Lattice lattice(parms);
+    BOOST_CHECK_THROW((chem::detail::parse_integrals<double, TwoU1PG>(parms, lattice)), std::runtime_error);
+}
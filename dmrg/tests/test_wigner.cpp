@@ -9,6 +9,7 @@
 #include <array>
 #include <vector>
 #include <utility>
+#include <algorithm>
 
 // Unit test for integral map
 #include <boost/test/included/unit_test.hpp>
@@ -56,3 +57,74 @@ BOOST_AUTO_TEST_CASE( Test_Wigner )
             1e-6);
     }
 }
+
+BOOST_AUTO_TEST_CASE( Test_Wigner9jTable )
+{
+    // All the symbols covered by the table must match the direct calculation
+    SU2::Wigner9jTable table(12);
+    for (int a = 0; a <= 10; a++)
+    for (int b = 0; b <= 2; b++)
+    for (int d = 0; d <= 2; d++)
+    for (int e = 0; e <= 2; e++)
+    for (int f = 0; f <= 2; f++)
+    for (int h = 0; h <= 2; h++)
+    for (int c = std::max(a-2, 0); c <= a+2; c++)
+    for (int g = std::max(a-2, 0); g <= a+2; g++)
+    for (int i = std::max(g-2, 0); i <= g+2; i++)
+    {
+        double value;
+        BOOST_REQUIRE(table.lookup(a, b, c, d, e, f, g, h, i, value));
+        double reference = SU2::triangle(a,b,c) && SU2::triangle(d,e,f) && SU2::triangle(g,h,i)
+                           && SU2::triangle(a,d,g) && SU2::triangle(b,e,h) && SU2::triangle(c,f,i)
+                           ? gsl_sf_coupling_9j(a, b, c, d, e, f, g, h, i) : 0.;
+        BOOST_CHECK_SMALL(value - reference, 1e-14);
+    }
+    BOOST_CHECK_EQUAL(table.filled_slabs(), 11);
+    // Symbols outside of the packed pattern are not covered
+    double value;
+    BOOST_CHECK(!table.lookup(2, 3, 1, 2, 1, 1, 2, 2, 2, value));
+    BOOST_CHECK(!table.lookup(12, 0, 12, 0, 0, 0, 12, 0, 12, value));
+    // The WignerWrapper gives the same results with and without the table
+    for (int a = 0; a <= 8; a++)
+    for (int b = 0; b <= 2; b++)
+    for (int c = std::max(a-2, 0); c <= a+2; c++)
+    for (int g = std::max(a-2, 0); g <= a+2; g++)
+    for (int i = std::max(g-2, 0); i <= g+2; i++)
+    {
+        WignerWrapper::UseCache = false;
+        double reference = WignerWrapper::gsl_sf_coupling_9j(a, b, c, 1, 1, 2, g, 1, i);
+        WignerWrapper::UseCache = true;
+        BOOST_CHECK_SMALL(WignerWrapper::gsl_sf_coupling_9j(a, b, c, 1, 1, 2, g, 1, i) - reference, 1e-14);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Test_Wigner9jTable_Concurrent )
+{
+    // Concurrent lazy extension of the table
+    SU2::Wigner9jTable table, reference;
+    std::vector<double> values(200), referenceValues(200);
+    #pragma omp parallel for schedule(static,1)
+    for (int n = 0; n < 200; n++)
+        table.lookup(n % 20, 1, n % 20 + 1, 1, 0, 1, n % 20, 0, n % 20, values[n]);
+    for (int n = 0; n < 200; n++) {
+        reference.lookup(n % 20, 1, n % 20 + 1, 1, 0, 1, n % 20, 0, n % 20, referenceValues[n]);
+        BOOST_CHECK_EQUAL(values[n], referenceValues[n]);
+    }
+    BOOST_CHECK_EQUAL(table.filled_slabs(), 20);
+}
+
+BOOST_AUTO_TEST_CASE( Test_Wigner6jTable )
+{
+    SU2::Wigner6jTable table(12);
+    for (int a = 0; a <= 10; a++)
+    for (int c = 0; c <= 2; c++)
+    for (int d = 0; d <= 2; d++)
+    for (int e = 0; e <= 2; e++)
+    for (int b = std::max(a-2, 0); b <= a+2; b++)
+    for (int f = std::max(a-2, 0); f <= a+2; f++)
+    {
+        double value;
+        BOOST_REQUIRE(table.lookup(a, b, c, d, e, f, value));
+        BOOST_CHECK_SMALL(value - gsl_sf_coupling_6j(a, b, c, d, e, f), 1e-14);
+    }
+}
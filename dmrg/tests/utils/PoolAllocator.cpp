@@ -0,0 +1,68 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.
+ *            Copyright ETH Zurich, Laboratory of Physical Chemistry, Reiher Group.
+ *            See LICENSE.txt for details.
+ */
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+#include <thread>
+#include <vector>
+#include "dmrg/block_matrix/detail/alps.hpp"
+#include "dmrg/utils/pool_allocator.hpp"
+
+using pool_matrix = alps::numeric::matrix<double, std::vector<double, maquis::memory::pool_allocator<double> > >;
+
+/** @brief Checks that a freed chunk is reused by the next allocation of the same size class */
+BOOST_AUTO_TEST_CASE(Test_PoolAllocator_Reuse)
+{
+    auto& pool = *maquis::memory::memory_pool::local();
+    pool.release();
+    maquis::memory::pool_allocator<double> allocator;
+    double* first = allocator.allocate(1000);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(first) % maquis::memory::memory_pool::alignment, 0);
+    allocator.deallocate(first, 1000);
+    BOOST_CHECK(pool.cached_bytes() >= 1000*sizeof(double));
+    // 990 doubles fall in the same size class as 1000 doubles
+    double* second = allocator.allocate(990);
+    BOOST_CHECK_EQUAL(first, second);
+    BOOST_CHECK_EQUAL(pool.cached_bytes(), 0);
+    allocator.deallocate(second, 990);
+}
+
+/** @brief Checks that trimming releases the cached memory */
+BOOST_AUTO_TEST_CASE(Test_PoolAllocator_Trim)
+{
+    {
+        pool_matrix a(30, 40, 1.);
+        pool_matrix b(a);
+    }
+    BOOST_CHECK(maquis::memory::memory_pool::local()->cached_bytes() > 0);
+    maquis::memory::memory_pool::trim();
+    // The trim is lazy and applies at the next allocation
+    maquis::memory::pool_allocator<double>().deallocate(maquis::memory::pool_allocator<double>().allocate(1), 1);
+    BOOST_CHECK(maquis::memory::memory_pool::local()->cached_bytes() <= maquis::memory::memory_pool::alignment);
+}
+
+/** @brief Checks matrix algebra and matrices freed by a thread different from the allocating one */
+BOOST_AUTO_TEST_CASE(Test_PoolAllocator_Matrix)
+{
+    std::vector<pool_matrix> matrices;
+    std::thread producer([&matrices]() {
+        for (int i = 1; i <= 4; i++)
+            matrices.push_back(pool_matrix(i*10, i*10, double(i)));
+    });
+    producer.join();
+    for (int i = 1; i <= 4; i++) {
+        pool_matrix product(i*10, i*10);
+        gemm(matrices[i-1], matrices[i-1], product);
+        BOOST_CHECK_CLOSE(product(0, 0), i*10.*i*i, 1.0E-12);
+    }
+    matrices.clear();
+    BOOST_CHECK(maquis::memory::memory_pool::local()->cached_bytes() > 0);
+    maquis::trim_memory_pools();
+    maquis::memory::memory_pool::local()->release();
+    BOOST_CHECK_EQUAL(maquis::memory::memory_pool::local()->cached_bytes(), 0);
+}